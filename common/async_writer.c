@@ -0,0 +1,317 @@
+/**
+ * @file async_writer.c
+ * @brief Asynchronous buffered output for result files (CSV rows, binary snapshots).
+ */
+
+#include "async_writer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RING_MASK (ASYNC_WRITER_RING_BYTES - 1)
+#define PIECE_BYTES (ASYNC_WRITER_RING_BYTES / 4) ///< Largest piece of a long buffer copied at once.
+#define SIGNAL_DRAIN_MS 2000                      ///< Longest wait for the writer threads in the signal handler.
+
+static const int flushed_signals[] = {SIGINT, SIGTERM, SIGHUP};
+
+static async_writer *_Atomic open_writers[ASYNC_WRITER_MAX_OPEN]; ///< Writers drained at exit and on signals.
+static pthread_once_t handlers_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Sleeps for a number of microseconds (async-signal-safe).
+ */
+static void sleep_us(long us)
+{
+  struct timespec pause = {us / 1000000, (us % 1000000) * 1000};
+  nanosleep(&pause, NULL);
+}
+
+/**
+ * @brief Writes a whole buffer, retrying on EINTR and short writes.
+ * @return 0 on success, or the errno of the failure.
+ */
+static int write_all(int fd, const char *data, size_t bytes)
+{
+  while (bytes > 0)
+  {
+    const ssize_t written = write(fd, data, bytes);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return errno;
+    }
+    data += written;
+    bytes -= (size_t)written;
+  }
+  return 0;
+}
+
+/**
+ * @brief Writer thread: writes the contiguous pending part of the ring, then sleeps until woken or the period ends.
+ */
+static void *writer_main(void *arg)
+{
+  async_writer *writer = arg;
+  for (;;)
+  {
+    const size_t tail = atomic_load_explicit(&writer->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&writer->head, memory_order_acquire);
+    if (head != tail)
+    {
+      const size_t offset = tail & RING_MASK;
+      size_t bytes = head - tail;
+      if (bytes > ASYNC_WRITER_RING_BYTES - offset)
+        bytes = ASYNC_WRITER_RING_BYTES - offset;
+      const int error = write_all(writer->fd, writer->ring + offset, bytes);
+      if (error && !atomic_load(&writer->error))
+        atomic_store(&writer->error, error);
+      writer->writes++;
+      // The bytes are released even after an error, so the producer never waits forever.
+      atomic_store_explicit(&writer->tail, tail + bytes, memory_order_release);
+      continue;
+    }
+    if (atomic_load(&writer->stop))
+      break;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += ASYNC_WRITER_PERIOD_MS * 1000000L;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+    pthread_mutex_lock(&writer->lock);
+    if (atomic_load(&writer->head) == tail && !atomic_load(&writer->stop))
+      pthread_cond_timedwait(&writer->wake, &writer->lock, &deadline);
+    pthread_mutex_unlock(&writer->lock);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Wakes the writer thread (no lock: a missed wake-up only costs one period).
+ */
+static void wake_writer(async_writer *writer)
+{
+  pthread_cond_signal(&writer->wake);
+}
+
+/* ----- Exit and signal handling ----- */
+
+/**
+ * @brief atexit handler: drains every open writer.
+ */
+static void flush_at_exit(void)
+{
+  for (int i = 0; i < ASYNC_WRITER_MAX_OPEN; i++)
+  {
+    async_writer *writer = atomic_load(&open_writers[i]);
+    if (writer)
+      async_writer_flush(writer);
+  }
+}
+
+/**
+ * @brief Signal handler: waits (bounded) for the writer threads to drain, then applies the default action.
+ *
+ * Only polls atomics and sleeps, which is async-signal-safe; the writer
+ * threads keep running because they block these signals.
+ */
+static void flush_on_signal(int sig)
+{
+  for (int i = 0; i < ASYNC_WRITER_MAX_OPEN; i++)
+  {
+    async_writer *writer = atomic_load(&open_writers[i]);
+    for (int waited = 0; writer && waited < SIGNAL_DRAIN_MS; waited++)
+    {
+      if (atomic_load(&writer->tail) == atomic_load(&writer->head))
+        break;
+      sleep_us(1000);
+    }
+  }
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+
+/**
+ * @brief Installs the exit handler and the signal handlers (signals the program ignores or handles are left alone).
+ */
+static void install_handlers(void)
+{
+  atexit(flush_at_exit);
+  for (size_t i = 0; i < sizeof(flushed_signals) / sizeof(flushed_signals[0]); i++)
+  {
+    struct sigaction current;
+    if (sigaction(flushed_signals[i], NULL, &current) == 0 && current.sa_handler == SIG_DFL)
+    {
+      struct sigaction action;
+      memset(&action, 0, sizeof(action));
+      action.sa_handler = flush_on_signal;
+      sigemptyset(&action.sa_mask);
+      sigaction(flushed_signals[i], &action, NULL);
+    }
+  }
+}
+
+/**
+ * @brief Adds or removes a writer in open_writers.
+ */
+static void register_writer(async_writer *writer, int add)
+{
+  for (int i = 0; i < ASYNC_WRITER_MAX_OPEN; i++)
+  {
+    async_writer *expected = add ? NULL : writer;
+    if (atomic_compare_exchange_strong(&open_writers[i], &expected, add ? writer : NULL))
+      return;
+  }
+}
+
+/* ----- Public API ----- */
+
+int async_writer_open(async_writer *writer, const char *path)
+{
+  memset(writer, 0, sizeof(*writer));
+  writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (writer->fd < 0)
+    return -1;
+  writer->ring = (char *)malloc(ASYNC_WRITER_RING_BYTES);
+  if (!writer->ring)
+  {
+    close(writer->fd);
+    errno = ENOMEM;
+    return -1;
+  }
+  atomic_init(&writer->head, 0);
+  atomic_init(&writer->tail, 0);
+  atomic_init(&writer->stop, 0);
+  atomic_init(&writer->error, 0);
+  pthread_mutex_init(&writer->lock, NULL);
+  pthread_cond_init(&writer->wake, NULL);
+  pthread_once(&handlers_once, install_handlers);
+
+  // The writer thread blocks all signals, so the handler always runs on a thread it can wait for.
+  sigset_t all, previous;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &previous);
+  const int error = pthread_create(&writer->thread, NULL, writer_main, writer);
+  pthread_sigmask(SIG_SETMASK, &previous, NULL);
+  if (error)
+  {
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->wake);
+    free(writer->ring);
+    close(writer->fd);
+    errno = error;
+    return -1;
+  }
+  register_writer(writer, 1);
+  return 0;
+}
+
+/**
+ * @brief Copies up to PIECE_BYTES bytes into the ring, waiting for room if needed.
+ */
+static void push(async_writer *writer, const char *data, size_t bytes)
+{
+  const size_t head = atomic_load_explicit(&writer->head, memory_order_relaxed);
+  if (ASYNC_WRITER_RING_BYTES - (head - atomic_load_explicit(&writer->tail, memory_order_acquire)) < bytes)
+  {
+    writer->stalls++;
+    do
+    {
+      wake_writer(writer);
+      sched_yield();
+    } while (ASYNC_WRITER_RING_BYTES - (head - atomic_load_explicit(&writer->tail, memory_order_acquire)) < bytes);
+  }
+
+  const size_t offset = head & RING_MASK;
+  const size_t first = bytes < ASYNC_WRITER_RING_BYTES - offset ? bytes : ASYNC_WRITER_RING_BYTES - offset;
+  memcpy(writer->ring + offset, data, first);
+  memcpy(writer->ring, data + first, bytes - first);
+  atomic_store_explicit(&writer->head, head + bytes, memory_order_release);
+
+  if (head + bytes - atomic_load_explicit(&writer->tail, memory_order_relaxed) >= ASYNC_WRITER_BATCH_BYTES)
+    wake_writer(writer);
+}
+
+int async_writer_write(async_writer *writer, const void *data, size_t bytes)
+{
+  const int error = atomic_load(&writer->error);
+  if (error)
+  {
+    errno = error;
+    return -1;
+  }
+  const char *bytes_in = data;
+  while (bytes > 0)
+  {
+    const size_t piece = bytes < PIECE_BYTES ? bytes : PIECE_BYTES;
+    push(writer, bytes_in, piece);
+    bytes_in += piece;
+    bytes -= piece;
+  }
+  return 0;
+}
+
+int async_writer_printf(async_writer *writer, const char *format, ...)
+{
+  char line[ASYNC_WRITER_LINE_MAX];
+  va_list args;
+  va_start(args, format);
+  const int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (length < 0 || length >= (int)sizeof(line))
+  {
+    errno = EMSGSIZE;
+    return -1;
+  }
+  return async_writer_write(writer, line, (size_t)length);
+}
+
+int async_writer_flush(async_writer *writer)
+{
+  const size_t head = atomic_load(&writer->head);
+  while (atomic_load(&writer->tail) < head)
+  {
+    wake_writer(writer);
+    sleep_us(100);
+  }
+  const int error = atomic_load(&writer->error);
+  if (error)
+  {
+    errno = error;
+    return -1;
+  }
+  return 0;
+}
+
+int async_writer_close(async_writer *writer)
+{
+  atomic_store(&writer->stop, 1);
+  pthread_mutex_lock(&writer->lock);
+  pthread_cond_signal(&writer->wake);
+  pthread_mutex_unlock(&writer->lock);
+  pthread_join(writer->thread, NULL);
+  register_writer(writer, 0);
+
+  int error = atomic_load(&writer->error);
+  if (close(writer->fd) != 0 && !error)
+    error = errno;
+  pthread_mutex_destroy(&writer->lock);
+  pthread_cond_destroy(&writer->wake);
+  free(writer->ring);
+  writer->ring = NULL;
+  if (error)
+  {
+    errno = error;
+    return -1;
+  }
+  return 0;
+}
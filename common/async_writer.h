@@ -0,0 +1,95 @@
+/**
+ * @file async_writer.h
+ * @brief Asynchronous buffered output for result files (CSV rows, binary snapshots).
+ *
+ * The benchmarks used to write each result with `fprintf` (often followed
+ * by `fflush`) from inside or right next to the measured loop, so every
+ * row could stall the measurement on disk I/O. An async_writer decouples
+ * the two:
+ *
+ * - the producer (the measuring thread) formats a row on its stack and
+ *   copies it into a lock-free single-producer/single-consumer ring; the
+ *   only shared state is the head and tail counters (C11 atomics), so
+ *   appending never takes a lock or makes a system call;
+ * - a background thread drains the ring with large `write(2)` calls (up
+ *   to the contiguous part of the ring at once), waking up when the ring
+ *   passes ASYNC_WRITER_BATCH_BYTES, on an explicit flush, or every
+ *   ASYNC_WRITER_PERIOD_MS.
+ *
+ * Only one thread may append to a given writer. If the ring fills up, the
+ * producer waits for room (counted in `stalls`), so rows are never lost.
+ * Open writers are drained at normal exit (atexit) and when the process
+ * gets SIGINT, SIGTERM or SIGHUP, before the default action of the signal.
+ * The handlers reach a writer through its address, which stays registered
+ * from async_writer_open until async_writer_close: every writer must be
+ * closed before the storage holding it goes away. In particular, a writer
+ * on the stack of main has to be closed on every path before main returns,
+ * error paths included, since the exit handler runs after main's frame is
+ * gone.
+ */
+
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define ASYNC_WRITER_RING_BYTES (1 << 20)  ///< Ring capacity (a power of two).
+#define ASYNC_WRITER_BATCH_BYTES (64 << 10) ///< Pending bytes that wake the writer thread.
+#define ASYNC_WRITER_PERIOD_MS 50           ///< Longest time a row waits in the ring.
+#define ASYNC_WRITER_LINE_MAX 1024          ///< Longest row accepted by async_writer_printf().
+#define ASYNC_WRITER_MAX_OPEN 16            ///< Writers flushed by the exit and signal handlers.
+
+/**
+ * @struct async_writer
+ * @brief Output file, its ring and the writer thread.
+ */
+typedef struct
+{
+  int fd;                    ///< Output file descriptor.
+  char *ring;                ///< Ring of ASYNC_WRITER_RING_BYTES bytes.
+  _Atomic size_t head;       ///< Bytes appended so far (written by the producer).
+  _Atomic size_t tail;       ///< Bytes written to the file so far (written by the writer thread).
+  _Atomic int stop;          ///< Set to make the writer thread drain the ring and exit.
+  _Atomic int error;         ///< errno of the first write error, 0 if none.
+  size_t stalls;             ///< Appends that had to wait for room in the ring.
+  size_t writes;             ///< write(2) calls made.
+  pthread_t thread;          ///< Writer thread.
+  pthread_mutex_t lock;      ///< Paired with wake (held only by waiters).
+  pthread_cond_t wake;       ///< Signaled when a batch is ready or on flush.
+} async_writer;
+
+/**
+ * @brief Creates (truncates) a file and starts its writer thread.
+ * @param writer Writer to initialize.
+ * @param path File to write.
+ * @return 0 on success, -1 on failure (errno is set).
+ */
+int async_writer_open(async_writer *writer, const char *path);
+
+/**
+ * @brief Appends bytes (any length; long buffers go through the ring in pieces).
+ * @return 0 on success, -1 if the writer already failed (errno is set).
+ */
+int async_writer_write(async_writer *writer, const void *data, size_t bytes);
+
+/**
+ * @brief Formats a row with printf syntax and appends it.
+ * @return 0 on success, -1 if the row is longer than ASYNC_WRITER_LINE_MAX or the writer failed.
+ */
+int async_writer_printf(async_writer *writer, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Waits until everything appended so far is in the file.
+ * @return 0 on success, -1 on a write error (errno is set).
+ */
+int async_writer_flush(async_writer *writer);
+
+/**
+ * @brief Flushes, stops the writer thread, closes the file and unregisters the writer (even on error).
+ * @return 0 on success, -1 on a write or close error (errno is set).
+ */
+int async_writer_close(async_writer *writer);
+
+#endif
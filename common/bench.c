@@ -0,0 +1,410 @@
+/**
+ * @file bench.c
+ * @brief Shared micro-benchmark harness: repeated timing, statistics and CSV/JSON output.
+ */
+
+#define _GNU_SOURCE
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_X86 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#define BENCH_DEFAULT_LLC (32 * 1024 * 1024) ///< Fallback last-level cache size in bytes.
+
+/**
+ * @brief Reads CLOCK_MONOTONIC_RAW (CLOCK_MONOTONIC where it is unavailable) in seconds.
+ */
+static double raw_seconds(void)
+{
+  struct timespec now;
+#ifdef CLOCK_MONOTONIC_RAW
+  clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+#ifdef BENCH_X86
+/**
+ * @brief Returns 1 if the TSC ticks at a constant rate whatever the core frequency and C-state.
+ */
+static int tsc_invariant(void)
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+    return 0;
+  return (edx >> 8) & 1;
+}
+
+/**
+ * @brief TSC frequency in Hz, measured once against CLOCK_MONOTONIC_RAW over ~20 ms.
+ *
+ * bench_run() calls it before its first sample, so the calibration is never timed.
+ */
+static double tsc_hz(void)
+{
+  static double hz = 0.0;
+  if (hz > 0.0)
+    return hz;
+
+  const double start = raw_seconds();
+  const uint64_t ticks = __rdtsc();
+  double now;
+  do
+    now = raw_seconds();
+  while (now - start < 0.02);
+  hz = (double)(__rdtsc() - ticks) / (now - start);
+  return hz;
+}
+#endif
+
+double bench_now(bench_clock clock)
+{
+#ifdef BENCH_X86
+  if (clock == BENCH_CLOCK_TSC)
+    return (double)__rdtsc() / tsc_hz();
+#else
+  (void)clock;
+#endif
+  return raw_seconds();
+}
+
+bench_config bench_default_config(void)
+{
+  bench_config config = {BENCH_DEFAULT_WARMUP, BENCH_DEFAULT_REPETITIONS, BENCH_WARM, BENCH_CLOCK_RAW, 0, NULL, NULL};
+  return config;
+}
+
+int bench_parse_arg(bench_config *config, int argc, char *argv[], int *i)
+{
+  const char *arg = argv[*i];
+  const char *value = *i + 1 < argc ? argv[*i + 1] : NULL;
+
+  if (strcmp(arg, "--cold") == 0)
+  {
+    config->cache = BENCH_COLD;
+    return 1;
+  }
+  if (strcmp(arg, "--counters") == 0)
+  {
+    config->counters = 1;
+    return 1;
+  }
+  if (!value)
+    return 0;
+
+  if (strcmp(arg, "--warmup") == 0 && atoi(value) >= 0)
+    config->warmup = atoi(value);
+  else if (strcmp(arg, "--reps") == 0 && atoi(value) > 0)
+    config->repetitions = atoi(value);
+  else if (strcmp(arg, "--clock") == 0 && (strcmp(value, "raw") == 0 || strcmp(value, "tsc") == 0))
+    config->clock = strcmp(value, "tsc") == 0 ? BENCH_CLOCK_TSC : BENCH_CLOCK_RAW;
+  else if (strcmp(arg, "--csv") == 0)
+    config->csv_path = value;
+  else if (strcmp(arg, "--json") == 0)
+    config->json_path = value;
+  else
+    return 0;
+
+  (*i)++;
+  return 1;
+}
+
+const char *bench_usage(void)
+{
+  return "[--warmup N] [--reps N] [--cold] [--clock raw|tsc] [--counters] [--csv PATH] [--json PATH]";
+}
+
+void bench_flush_cache(void)
+{
+  static unsigned char *buffer = NULL;
+  static size_t size = 0;
+
+  if (!buffer)
+  {
+    long llc = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (llc <= 0)
+      llc = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    if (llc <= 0)
+      llc = BENCH_DEFAULT_LLC;
+    size = 2 * (size_t)llc;
+    buffer = malloc(size);
+    if (!buffer)
+      return;
+  }
+
+  // Writing (not only reading) also pushes dirty lines of the measured data out.
+  static unsigned char round = 0;
+  round++;
+  for (size_t i = 0; i < size; i += 64)
+    buffer[i] = round;
+}
+
+/**
+ * @brief qsort comparator for doubles in increasing order.
+ */
+static int compare_double(const void *a, const void *b)
+{
+  const double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+int bench_run(const bench_config *config, perf_counters *counters, const char *name, bench_fn fn, void *arg, bench_stats *stats)
+{
+  perf_values total, run;
+  memset(&total, 0, sizeof(total));
+
+  const int repetitions = config->repetitions > 0 ? config->repetitions : 1;
+  double *samples = malloc(repetitions * sizeof(double));
+  if (!samples)
+    return -1;
+
+#ifdef BENCH_X86
+  const bench_clock clock = config->clock == BENCH_CLOCK_TSC && tsc_invariant() ? BENCH_CLOCK_TSC : BENCH_CLOCK_RAW;
+  // Calibrate now: done lazily, the ~20 ms calibration would land inside the first timed sample.
+  if (clock == BENCH_CLOCK_TSC)
+    tsc_hz();
+#else
+  const bench_clock clock = BENCH_CLOCK_RAW;
+#endif
+
+  for (int r = 0; r < config->warmup; r++)
+  {
+    if (config->cache == BENCH_COLD)
+      bench_flush_cache();
+    fn(arg);
+  }
+
+  for (int r = 0; r < repetitions; r++)
+  {
+    if (config->cache == BENCH_COLD)
+      bench_flush_cache();
+    if (counters)
+      perf_counters_start(counters);
+    const double start = bench_now(clock);
+    fn(arg);
+    samples[r] = bench_now(clock) - start;
+    if (counters)
+    {
+      perf_counters_stop(counters, &run);
+      for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+        total.values[c] += run.values[c];
+      total.available = r == 0 ? run.available : total.available & run.available;
+    }
+  }
+
+  qsort(samples, repetitions, sizeof(double), compare_double);
+
+  double sum = 0.0;
+  for (int r = 0; r < repetitions; r++)
+    sum += samples[r];
+  const double mean = sum / repetitions;
+  double squares = 0.0;
+  for (int r = 0; r < repetitions; r++)
+    squares += (samples[r] - mean) * (samples[r] - mean);
+
+  memset(stats, 0, sizeof(*stats));
+  snprintf(stats->name, sizeof(stats->name), "%s", name);
+  stats->repetitions = repetitions;
+  stats->cache = config->cache;
+  stats->clock = clock;
+  stats->min = samples[0];
+  stats->max = samples[repetitions - 1];
+  stats->median = repetitions % 2 ? samples[repetitions / 2] : (samples[repetitions / 2 - 1] + samples[repetitions / 2]) / 2;
+  stats->p95 = samples[(int)ceil(0.95 * repetitions) - 1];
+  stats->mean = mean;
+  stats->stddev = repetitions > 1 ? sqrt(squares / (repetitions - 1)) : 0.0;
+  stats->counters.available = total.available;
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+    stats->counters.values[c] = total.values[c] / repetitions;
+
+  free(samples);
+  return 0;
+}
+
+void bench_session_init(bench_session *session, const bench_config *config)
+{
+  session->config = *config;
+  session->counters_open = config->counters ? perf_counters_open(&session->counters) : 0;
+  session->results = NULL;
+  session->count = 0;
+  session->capacity = 0;
+}
+
+bench_stats bench_session_run(bench_session *session, const char *name, bench_fn fn, void *arg)
+{
+  bench_stats stats;
+  perf_counters *counters = session->counters_open ? &session->counters : NULL;
+  if (bench_run(&session->config, counters, name, fn, arg, &stats) != 0)
+  {
+    memset(&stats, 0, sizeof(stats));
+    return stats;
+  }
+
+  if (session->count == session->capacity)
+  {
+    const size_t capacity = session->capacity ? 2 * session->capacity : 16;
+    bench_stats *results = realloc(session->results, capacity * sizeof(bench_stats));
+    if (!results)
+      return stats;
+    session->results = results;
+    session->capacity = capacity;
+  }
+  session->results[session->count++] = stats;
+  return stats;
+}
+
+int bench_session_write(const bench_session *session)
+{
+  int status = 0;
+  if (session->config.csv_path && bench_write_csv(session->config.csv_path, session->results, session->count) != 0)
+    status = -1;
+  if (session->config.json_path && bench_write_json(session->config.json_path, session->results, session->count) != 0)
+    status = -1;
+  return status;
+}
+
+void bench_session_free(bench_session *session)
+{
+  if (session->counters_open)
+    perf_counters_close(&session->counters);
+  session->counters_open = 0;
+  free(session->results);
+  session->results = NULL;
+  session->count = 0;
+  session->capacity = 0;
+}
+
+/**
+ * @brief Printable name of a cache mode.
+ */
+static const char *cache_name(bench_cache_mode cache)
+{
+  return cache == BENCH_COLD ? "cold" : "warm";
+}
+
+/**
+ * @brief Printable name of a clock.
+ */
+static const char *clock_name(bench_clock clock)
+{
+  return clock == BENCH_CLOCK_TSC ? "tsc" : "raw";
+}
+
+void bench_print_counters(const char *prefix, const bench_stats *stats)
+{
+  const perf_values *counters = &stats->counters;
+  if (!counters->available)
+    return;
+
+  printf("%s", prefix);
+  if (perf_values_ipc(counters) > 0.0)
+    printf("IPC %.2f", perf_values_ipc(counters));
+  // Misses per 1000 instructions when instructions were counted, raw counts otherwise.
+  const int per_kilo = perf_values_has(counters, PERF_INSTRUCTIONS) && counters->values[PERF_INSTRUCTIONS] > 0.0;
+  for (int c = PERF_L1D_MISSES; c < PERF_COUNTER_COUNT; c++)
+  {
+    if (!perf_values_has(counters, (perf_counter)c))
+      continue;
+    if (per_kilo)
+      printf(", %s %.2f/kinstr", perf_counter_name((perf_counter)c), 1000.0 * counters->values[c] / counters->values[PERF_INSTRUCTIONS]);
+    else
+      printf(", %s %.0f", perf_counter_name((perf_counter)c), counters->values[c]);
+  }
+  printf("\n");
+}
+
+int bench_write_csv(const char *path, const bench_stats *stats, size_t count)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+    return -1;
+
+  fprintf(file, "name,cache,clock,repetitions,min_s,median_s,p95_s,mean_s,stddev_s,max_s");
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+    fprintf(file, ",%s", perf_counter_name((perf_counter)c));
+  fprintf(file, ",ipc\n");
+  for (size_t i = 0; i < count; i++)
+  {
+    const bench_stats *s = &stats[i];
+    // Labels may contain commas ("4 rows, 16 columns"), so they are quoted.
+    fputc('"', file);
+    for (const char *c = s->name; *c; c++)
+    {
+      if (*c == '"')
+        fputc('"', file);
+      fputc(*c, file);
+    }
+    fprintf(file, "\",%s,%s,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f", cache_name(s->cache), clock_name(s->clock),
+            s->repetitions, s->min, s->median, s->p95, s->mean, s->stddev, s->max);
+    // Unavailable counters are left empty.
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+    {
+      if (perf_values_has(&s->counters, (perf_counter)c))
+        fprintf(file, ",%.0f", s->counters.values[c]);
+      else
+        fprintf(file, ",");
+    }
+    if (perf_values_ipc(&s->counters) > 0.0)
+      fprintf(file, ",%.4f\n", perf_values_ipc(&s->counters));
+    else
+      fprintf(file, ",\n");
+  }
+
+  fclose(file);
+  return 0;
+}
+
+int bench_write_json(const char *path, const bench_stats *stats, size_t count)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+    return -1;
+
+  fprintf(file, "[\n");
+  for (size_t i = 0; i < count; i++)
+  {
+    const bench_stats *s = &stats[i];
+    fprintf(file, "  {\"name\": \"");
+    for (const char *c = s->name; *c; c++)
+    {
+      if (*c == '"' || *c == '\\')
+        fputc('\\', file);
+      fputc(*c, file);
+    }
+    fprintf(file, "\", \"cache\": \"%s\", \"clock\": \"%s\", \"repetitions\": %d, \"min_s\": %.9f, \"median_s\": %.9f, "
+                  "\"p95_s\": %.9f, \"mean_s\": %.9f, \"stddev_s\": %.9f, \"max_s\": %.9f",
+            cache_name(s->cache), clock_name(s->clock), s->repetitions, s->min, s->median, s->p95, s->mean, s->stddev,
+            s->max);
+    // Unavailable counters are null.
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+    {
+      if (perf_values_has(&s->counters, (perf_counter)c))
+        fprintf(file, ", \"%s\": %.0f", perf_counter_name((perf_counter)c), s->counters.values[c]);
+      else
+        fprintf(file, ", \"%s\": null", perf_counter_name((perf_counter)c));
+    }
+    if (perf_values_ipc(&s->counters) > 0.0)
+      fprintf(file, ", \"ipc\": %.4f}%s\n", perf_values_ipc(&s->counters), i + 1 < count ? "," : "");
+    else
+      fprintf(file, ", \"ipc\": null}%s\n", i + 1 < count ? "," : "");
+  }
+  fprintf(file, "]\n");
+
+  fclose(file);
+  return 0;
+}
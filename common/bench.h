@@ -0,0 +1,213 @@
+/**
+ * @file bench.h
+ * @brief Shared micro-benchmark harness: repeated timing, statistics and CSV/JSON output.
+ *
+ * Timing one call with `gettimeofday` mixes the measurement with page
+ * faults, cold caches, frequency ramp-up and scheduler noise, so two runs
+ * of the same binary can differ by 30%. Here a measured function runs
+ * `warmup` untimed times, then `repetitions` timed times, and the report
+ * gives the median, 95th percentile, mean and standard deviation.
+ *
+ * Time comes from `clock_gettime(CLOCK_MONOTONIC_RAW)` (not slewed by
+ * NTP) or, on x86 with an invariant TSC, from `rdtsc` calibrated against
+ * it. In cold-cache mode a buffer twice the size of the last-level cache
+ * is written between repetitions, so every run starts from DRAM.
+ *
+ * With `--counters`, the timed runs are also wrapped in hardware
+ * performance counters (see perf_counters.h), and each measurement gets
+ * the mean cycles, instructions, cache/TLB misses and branch misses of
+ * one run.
+ *
+ * Each program collects its measurements in a bench_session and writes
+ * them as CSV and/or JSON at the end. The same options are understood by
+ * every program (see bench_parse_arg()):
+ *
+ *   --warmup N   untimed runs before measuring (default 1)
+ *   --reps N     timed runs (default 10)
+ *   --cold       flush the last-level cache before each run
+ *   --clock raw|tsc
+ *   --counters   record hardware performance counters
+ *   --csv PATH   write every measurement as CSV
+ *   --json PATH  write every measurement as JSON
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "perf_counters.h"
+
+#define BENCH_DEFAULT_WARMUP 1       ///< Untimed runs before measuring.
+#define BENCH_DEFAULT_REPETITIONS 10 ///< Timed runs.
+
+/**
+ * @enum bench_clock
+ * @brief Time source of the measurements.
+ */
+typedef enum
+{
+  BENCH_CLOCK_RAW, ///< clock_gettime(CLOCK_MONOTONIC_RAW).
+  BENCH_CLOCK_TSC  ///< rdtsc, calibrated against CLOCK_MONOTONIC_RAW (x86 with invariant TSC only).
+} bench_clock;
+
+/**
+ * @enum bench_cache_mode
+ * @brief Cache state at the start of each timed run.
+ */
+typedef enum
+{
+  BENCH_WARM, ///< Whatever the previous run left in cache.
+  BENCH_COLD  ///< Last-level cache flushed before each run.
+} bench_cache_mode;
+
+/**
+ * @struct bench_config
+ * @brief How measurements are taken and where they are written.
+ */
+typedef struct
+{
+  int warmup;             ///< Untimed runs before measuring.
+  int repetitions;        ///< Timed runs.
+  bench_cache_mode cache; ///< Cache state at the start of each run.
+  bench_clock clock;      ///< Time source.
+  int counters;           ///< Non-zero to record hardware performance counters.
+  const char *csv_path;   ///< CSV output file, or NULL.
+  const char *json_path;  ///< JSON output file, or NULL.
+} bench_config;
+
+/**
+ * @struct bench_stats
+ * @brief Summary of the timed runs of one measurement, in seconds.
+ */
+typedef struct
+{
+  char name[96];          ///< Measurement label.
+  int repetitions;        ///< Number of timed runs.
+  bench_cache_mode cache; ///< Cache mode used.
+  bench_clock clock;      ///< Time source used.
+  double min;             ///< Fastest run.
+  double median;          ///< Median run.
+  double p95;             ///< 95th percentile (nearest rank).
+  double mean;            ///< Mean of the runs.
+  double stddev;          ///< Sample standard deviation.
+  double max;             ///< Slowest run.
+  perf_values counters;   ///< Mean counts of one timed run (none available without `--counters`).
+} bench_stats;
+
+/**
+ * @struct bench_session
+ * @brief Configuration plus every measurement taken so far.
+ */
+typedef struct
+{
+  bench_config config;    ///< Measurement settings.
+  perf_counters counters; ///< Open hardware counters.
+  int counters_open;      ///< Number of counters that could be opened (0 without `--counters`).
+  bench_stats *results;   ///< Measurements, in the order they were taken.
+  size_t count;           ///< Number of measurements.
+  size_t capacity;        ///< Allocated entries in results.
+} bench_session;
+
+/**
+ * @brief Measured function; `arg` carries its inputs and outputs.
+ */
+typedef void (*bench_fn)(void *arg);
+
+/**
+ * @brief Returns the default configuration (1 warmup run, 10 timed runs, warm cache, raw clock).
+ */
+bench_config bench_default_config(void);
+
+/**
+ * @brief Parses one benchmark option at argv[*i].
+ *
+ * On success, advances *i past the option's value (if any).
+ *
+ * @return 1 if the option was recognized, 0 otherwise.
+ */
+int bench_parse_arg(bench_config *config, int argc, char *argv[], int *i);
+
+/**
+ * @brief Usage text of the options understood by bench_parse_arg().
+ */
+const char *bench_usage(void);
+
+/**
+ * @brief Current time in seconds from the given clock.
+ *
+ * Only differences between two readings are meaningful.
+ */
+double bench_now(bench_clock clock);
+
+/**
+ * @brief Evicts the last-level cache by writing a buffer twice its size.
+ */
+void bench_flush_cache(void);
+
+/**
+ * @brief Runs a function warmup + repetitions times and summarizes the timed runs.
+ * @param config Measurement settings.
+ * @param counters Open hardware counters wrapped around each timed run, or NULL.
+ * @param name Measurement label.
+ * @param fn Function to measure.
+ * @param arg Argument passed to fn.
+ * @param stats Summary to fill.
+ * @return 0 on success, -1 if the sample buffer could not be allocated.
+ */
+int bench_run(const bench_config *config, perf_counters *counters, const char *name, bench_fn fn, void *arg, bench_stats *stats);
+
+/**
+ * @brief Initializes a session with the given settings.
+ *
+ * With `config->counters`, opens the hardware counters; call it before the
+ * first OpenMP parallel region so the worker threads are counted too.
+ * When no counter can be opened, `counters_open` is 0 and
+ * `counters.error` holds the errno of the failure.
+ */
+void bench_session_init(bench_session *session, const bench_config *config);
+
+/**
+ * @brief Measures a function with the session settings and records the result.
+ *
+ * If the measurement cannot be recorded, it is still returned.
+ *
+ * @return Summary of the timed runs (all zero if the measurement failed).
+ */
+bench_stats bench_session_run(bench_session *session, const char *name, bench_fn fn, void *arg);
+
+/**
+ * @brief Writes the recorded measurements to the configured CSV and JSON files.
+ * @return 0 on success, -1 if a file could not be written.
+ */
+int bench_session_write(const bench_session *session);
+
+/**
+ * @brief Releases the recorded measurements.
+ */
+void bench_session_free(bench_session *session);
+
+/**
+ * @brief Prints the counters of a measurement on one line (IPC, misses per 1000 instructions).
+ *
+ * Prints nothing if no counter was measured.
+ *
+ * @param prefix Text printed before the counters.
+ * @param stats Measurement.
+ */
+void bench_print_counters(const char *prefix, const bench_stats *stats);
+
+/**
+ * @brief Writes measurements as CSV (one header line, one line per measurement).
+ * @return 0 on success, -1 if the file could not be opened.
+ */
+int bench_write_csv(const char *path, const bench_stats *stats, size_t count);
+
+/**
+ * @brief Writes measurements as a JSON array of objects.
+ * @return 0 on success, -1 if the file could not be opened.
+ */
+int bench_write_json(const char *path, const bench_stats *stats, size_t count);
+
+#endif
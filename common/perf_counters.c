@@ -0,0 +1,154 @@
+/**
+ * @file perf_counters.c
+ * @brief Hardware performance counters through Linux `perf_event_open`.
+ */
+
+#define _GNU_SOURCE
+#include "perf_counters.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Builds the `config` of a PERF_TYPE_HW_CACHE read-miss event.
+ */
+#define HW_CACHE_READ_MISS(cache) \
+  ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/**
+ * @brief Event type and config of each counter.
+ */
+static const struct
+{
+  uint32_t type;
+  uint64_t config;
+} events[PERF_COUNTER_COUNT] = {
+    [PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_L1D_MISSES] = {PERF_TYPE_HW_CACHE, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    [PERF_LLC_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    [PERF_DTLB_MISSES] = {PERF_TYPE_HW_CACHE, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+    [PERF_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int perf_counters_open(perf_counters *counters)
+{
+  int opened = 0;
+  counters->error = 0;
+
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[c].type;
+    attr.config = events[c].config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    counters->fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (counters->fds[c] >= 0)
+      opened++;
+    else if (!counters->error)
+      counters->error = errno;
+  }
+  return opened;
+}
+
+void perf_counters_start(perf_counters *counters)
+{
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+  {
+    if (counters->fds[c] >= 0)
+    {
+      ioctl(counters->fds[c], PERF_EVENT_IOC_RESET, 0);
+      ioctl(counters->fds[c], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+void perf_counters_stop(perf_counters *counters, perf_values *values)
+{
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+  {
+    if (counters->fds[c] >= 0)
+      ioctl(counters->fds[c], PERF_EVENT_IOC_DISABLE, 0);
+  }
+
+  memset(values, 0, sizeof(*values));
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+  {
+    // value, time enabled, time running
+    uint64_t data[3];
+    if (counters->fds[c] < 0 || read(counters->fds[c], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0)
+      continue;
+    // A multiplexed event only ran part of the time: extrapolate to the whole region.
+    values->values[c] = data[2] < data[1] ? (double)data[0] * data[1] / data[2] : (double)data[0];
+    values->available |= 1u << c;
+  }
+}
+
+void perf_counters_close(perf_counters *counters)
+{
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+  {
+    if (counters->fds[c] >= 0)
+      close(counters->fds[c]);
+    counters->fds[c] = -1;
+  }
+}
+
+#else
+
+int perf_counters_open(perf_counters *counters)
+{
+  for (int c = 0; c < PERF_COUNTER_COUNT; c++)
+    counters->fds[c] = -1;
+  counters->error = ENOSYS;
+  return 0;
+}
+
+void perf_counters_start(perf_counters *counters)
+{
+  (void)counters;
+}
+
+void perf_counters_stop(perf_counters *counters, perf_values *values)
+{
+  (void)counters;
+  memset(values, 0, sizeof(*values));
+}
+
+void perf_counters_close(perf_counters *counters)
+{
+  (void)counters;
+}
+
+#endif
+
+int perf_values_has(const perf_values *values, perf_counter counter)
+{
+  return (values->available >> counter) & 1;
+}
+
+double perf_values_ipc(const perf_values *values)
+{
+  if (!perf_values_has(values, PERF_CYCLES) || !perf_values_has(values, PERF_INSTRUCTIONS) || values->values[PERF_CYCLES] == 0.0)
+    return 0.0;
+  return values->values[PERF_INSTRUCTIONS] / values->values[PERF_CYCLES];
+}
+
+const char *perf_counter_name(perf_counter counter)
+{
+  static const char *names[PERF_COUNTER_COUNT] = {"cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"};
+  return counter < PERF_COUNTER_COUNT ? names[counter] : "unknown";
+}
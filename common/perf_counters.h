@@ -0,0 +1,101 @@
+/**
+ * @file perf_counters.h
+ * @brief Hardware performance counters through Linux `perf_event_open`.
+ *
+ * Wall time alone cannot tell whether a kernel change removed work,
+ * removed stalls, or only moved noise. These counters give cycles,
+ * instructions (hence IPC), L1D and last-level cache misses, dTLB misses
+ * and branch misses of a measured region.
+ *
+ * Each event is opened on its own (not as a group), user space only, so
+ * it works with `perf_event_paranoid` up to 2 and events the PMU cannot
+ * schedule together are multiplexed and scaled by time enabled / time
+ * running. Events count the calling thread and the threads it creates
+ * after they are opened (`inherit`), so open them before the first OpenMP
+ * parallel region to include the worker threads.
+ *
+ * When counters are unavailable (non-Linux build, container without PMU
+ * access, `perf_event_paranoid` 3 or higher), perf_counters_open() returns
+ * 0 and every value is reported as unavailable; timing still works.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+/**
+ * @enum perf_counter
+ * @brief Hardware events recorded for a measured region.
+ */
+typedef enum
+{
+  PERF_CYCLES,        ///< Core cycles.
+  PERF_INSTRUCTIONS,  ///< Retired instructions.
+  PERF_L1D_MISSES,    ///< L1 data cache read misses.
+  PERF_LLC_MISSES,    ///< Last-level cache misses.
+  PERF_DTLB_MISSES,   ///< Data TLB read misses.
+  PERF_BRANCH_MISSES, ///< Mispredicted branches.
+  PERF_COUNTER_COUNT
+} perf_counter;
+
+/**
+ * @struct perf_values
+ * @brief Event counts of a measured region.
+ */
+typedef struct
+{
+  double values[PERF_COUNTER_COUNT]; ///< Counts (scaled if the event was multiplexed).
+  unsigned int available;            ///< Bit `1 << counter` set if the value was measured.
+} perf_values;
+
+/**
+ * @struct perf_counters
+ * @brief Open event file descriptors.
+ */
+typedef struct
+{
+  int fds[PERF_COUNTER_COUNT]; ///< One descriptor per event, -1 if unavailable.
+  int error;                   ///< errno of the first failed open, 0 if none failed.
+} perf_counters;
+
+/**
+ * @brief Opens every event for the calling thread (and threads it creates later).
+ * @param counters Counters to initialize.
+ * @return Number of events that could be opened (0 if counters are unavailable).
+ */
+int perf_counters_open(perf_counters *counters);
+
+/**
+ * @brief Resets and enables the open events.
+ */
+void perf_counters_start(perf_counters *counters);
+
+/**
+ * @brief Disables the open events and reads their counts.
+ * @param counters Open counters.
+ * @param values Counts since perf_counters_start().
+ */
+void perf_counters_stop(perf_counters *counters, perf_values *values);
+
+/**
+ * @brief Closes the open events.
+ */
+void perf_counters_close(perf_counters *counters);
+
+/**
+ * @brief Returns 1 if a counter was measured.
+ */
+int perf_values_has(const perf_values *values, perf_counter counter);
+
+/**
+ * @brief Instructions per cycle, or 0 if either count is unavailable.
+ */
+double perf_values_ipc(const perf_values *values);
+
+/**
+ * @brief Returns the printable name of a counter ("cycles", "instructions", ...).
+ */
+const char *perf_counter_name(perf_counter counter);
+
+#endif
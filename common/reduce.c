@@ -0,0 +1,315 @@
+/**
+ * @file reduce.c
+ * @brief Multi-accumulator SIMD sum reductions for int32/int64/float/double arrays.
+ */
+
+#include "reduce.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __FAST_MATH__
+#warning "reduce.c built with -ffast-math: Kahan summation may be optimized away"
+#endif
+
+/**
+ * @brief Compiles a kernel for AVX2 and baseline x86-64, selected at load time.
+ *
+ * No avx512f clone: the vectors are REDUCE_VECTOR_BYTES wide in every
+ * clone, so it would run the AVX2 code. AVX-512 builds get 64-byte vectors
+ * instead (see reduce.h) and need no clones.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && !defined(__AVX512F__)
+#define REDUCE_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define REDUCE_TARGET_CLONES
+#endif
+
+#define VECTOR(bytes) __attribute__((vector_size(bytes)))
+
+// Accumulator vectors, and input vectors with the same number of lanes.
+typedef int64_t v_i64 VECTOR(REDUCE_VECTOR_BYTES);
+typedef int32_t v_i32 VECTOR(REDUCE_VECTOR_BYTES / 2);
+typedef float v_f32 VECTOR(REDUCE_VECTOR_BYTES);
+typedef double v_f64 VECTOR(REDUCE_VECTOR_BYTES);
+
+/**
+ * @brief Defines reduce_<name>_plain_<K>: K vector accumulators, then the remainder.
+ *
+ * Each iteration loads K input vectors (unaligned, through memcpy),
+ * widens them to the accumulator type and adds each one to its own
+ * accumulator. The accumulators are combined as a tree, then their lanes.
+ */
+#define DEFINE_REDUCE_PLAIN(name, in_t, acc_t, in_v, acc_v, K)                      \
+  REDUCE_TARGET_CLONES static acc_t reduce_##name##_plain_##K(const in_t *data, size_t n) \
+  {                                                                                  \
+    enum { LANES = sizeof(acc_v) / sizeof(acc_t) };                                  \
+    acc_v acc[K];                                                                    \
+    for (int k = 0; k < K; k++)                                                      \
+      acc[k] = (acc_v){0};                                                           \
+    size_t i = 0;                                                                    \
+    for (; i + (size_t)K * LANES <= n; i += (size_t)K * LANES)                       \
+    {                                                                                \
+      for (int k = 0; k < K; k++)                                                    \
+      {                                                                              \
+        in_v x;                                                                      \
+        memcpy(&x, data + i + k * LANES, sizeof(x));                                 \
+        acc[k] += __builtin_convertvector(x, acc_v);                                 \
+      }                                                                              \
+    }                                                                                \
+    for (int width = K / 2; width > 0; width /= 2)                                   \
+    {                                                                                \
+      for (int k = 0; k < width; k++)                                                \
+        acc[k] += acc[k + width];                                                    \
+    }                                                                                \
+    acc_t sum = 0;                                                                   \
+    for (int l = 0; l < LANES; l++)                                                  \
+      sum += acc[0][l];                                                              \
+    for (; i < n; i++)                                                               \
+      sum += data[i];                                                                \
+    return sum;                                                                      \
+  }
+
+/**
+ * @brief Adds x to a Kahan sum (sum, compensation).
+ */
+#define KAHAN_ADD(sum, comp, x)  \
+  do                             \
+  {                              \
+    __typeof__(sum) y_ = (x) - (comp); \
+    __typeof__(sum) t_ = (sum) + y_;   \
+    (comp) = (t_ - (sum)) - y_;  \
+    (sum) = t_;                  \
+  } while (0)
+
+/**
+ * @brief Defines reduce_<name>_kahan_<K>: K compensated vector accumulators.
+ *
+ * Every lane keeps its own running compensation; the K x lanes partial
+ * sums (minus their compensation) and the remainder are then added with
+ * scalar Kahan summation.
+ */
+#define DEFINE_REDUCE_KAHAN(name, t, v, K)                                           \
+  REDUCE_TARGET_CLONES static t reduce_##name##_kahan_##K(const t *data, size_t n)   \
+  {                                                                                  \
+    enum { LANES = sizeof(v) / sizeof(t) };                                          \
+    v sum[K], comp[K];                                                               \
+    for (int k = 0; k < K; k++)                                                      \
+    {                                                                                \
+      sum[k] = (v){0};                                                               \
+      comp[k] = (v){0};                                                              \
+    }                                                                                \
+    size_t i = 0;                                                                    \
+    for (; i + (size_t)K * LANES <= n; i += (size_t)K * LANES)                       \
+    {                                                                                \
+      for (int k = 0; k < K; k++)                                                    \
+      {                                                                              \
+        v x;                                                                         \
+        memcpy(&x, data + i + k * LANES, sizeof(x));                                 \
+        KAHAN_ADD(sum[k], comp[k], x);                                               \
+      }                                                                              \
+    }                                                                                \
+    t total = 0, total_comp = 0;                                                     \
+    for (int k = 0; k < K; k++)                                                      \
+    {                                                                                \
+      for (int l = 0; l < LANES; l++)                                                \
+      {                                                                              \
+        KAHAN_ADD(total, total_comp, sum[k][l]);                                     \
+        KAHAN_ADD(total, total_comp, -comp[k][l]);                                   \
+      }                                                                              \
+    }                                                                                \
+    for (; i < n; i++)                                                               \
+      KAHAN_ADD(total, total_comp, data[i]);                                         \
+    return total;                                                                    \
+  }
+
+/**
+ * @brief Defines reduce_<name>_pairwise_<K>: halves split on REDUCE_PAIRWISE_BLOCK
+ *        boundaries, leaves summed by reduce_<name>_plain_<K>.
+ */
+#define DEFINE_REDUCE_PAIRWISE(name, t, K)                                           \
+  static t reduce_##name##_pairwise_##K(const t *data, size_t n)                     \
+  {                                                                                  \
+    if (n <= REDUCE_PAIRWISE_BLOCK)                                                  \
+      return reduce_##name##_plain_##K(data, n);                                     \
+    const size_t half = (n / REDUCE_PAIRWISE_BLOCK + 1) / 2 * REDUCE_PAIRWISE_BLOCK; \
+    return reduce_##name##_pairwise_##K(data, half) +                                \
+           reduce_##name##_pairwise_##K(data + half, n - half);                      \
+  }
+
+#define DEFINE_INT_KERNELS(K)                               \
+  DEFINE_REDUCE_PLAIN(i32, int32_t, int64_t, v_i32, v_i64, K) \
+  DEFINE_REDUCE_PLAIN(i64, int64_t, int64_t, v_i64, v_i64, K)
+
+#define DEFINE_FLOAT_KERNELS(K)                             \
+  DEFINE_REDUCE_PLAIN(f32, float, float, v_f32, v_f32, K)   \
+  DEFINE_REDUCE_PLAIN(f64, double, double, v_f64, v_f64, K) \
+  DEFINE_REDUCE_KAHAN(f32, float, v_f32, K)                 \
+  DEFINE_REDUCE_KAHAN(f64, double, v_f64, K)                \
+  DEFINE_REDUCE_PAIRWISE(f32, float, K)                     \
+  DEFINE_REDUCE_PAIRWISE(f64, double, K)
+
+REDUCE_ACCUMULATOR_COUNTS(DEFINE_INT_KERNELS)
+REDUCE_ACCUMULATOR_COUNTS(DEFINE_FLOAT_KERNELS)
+
+/**
+ * @struct reduce_variant
+ * @brief Kernels generated for one accumulator count.
+ */
+struct reduce_variant
+{
+  int accumulators;                          ///< Number of vector accumulators.
+  reduce_i32_fn i32;                         ///< int32 kernel.
+  reduce_i64_fn i64;                         ///< int64 kernel.
+  reduce_f32_fn f32[REDUCE_METHOD_COUNT];    ///< float kernels, by method.
+  reduce_f64_fn f64[REDUCE_METHOD_COUNT];    ///< double kernels, by method.
+};
+
+#define REDUCE_VARIANT(K)                                                                        \
+  {K, reduce_i32_plain_##K, reduce_i64_plain_##K,                                                \
+   {reduce_f32_plain_##K, reduce_f32_kahan_##K, reduce_f32_pairwise_##K},                        \
+   {reduce_f64_plain_##K, reduce_f64_kahan_##K, reduce_f64_pairwise_##K}},
+
+static const struct reduce_variant variants[] = {REDUCE_ACCUMULATOR_COUNTS(REDUCE_VARIANT)};
+
+/**
+ * @brief Returns the kernels with the given number of accumulators, or NULL.
+ */
+static const struct reduce_variant *find_variant(int accumulators)
+{
+  for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+  {
+    if (variants[v].accumulators == accumulators)
+      return &variants[v];
+  }
+  return NULL;
+}
+
+reduce_i32_fn reduce_sum_i32_for(int accumulators)
+{
+  const struct reduce_variant *variant = find_variant(accumulators);
+  return variant ? variant->i32 : NULL;
+}
+
+reduce_i64_fn reduce_sum_i64_for(int accumulators)
+{
+  const struct reduce_variant *variant = find_variant(accumulators);
+  return variant ? variant->i64 : NULL;
+}
+
+reduce_f32_fn reduce_sum_f32_for(reduce_method method, int accumulators)
+{
+  const struct reduce_variant *variant = find_variant(accumulators);
+  return variant && method < REDUCE_METHOD_COUNT ? variant->f32[method] : NULL;
+}
+
+reduce_f64_fn reduce_sum_f64_for(reduce_method method, int accumulators)
+{
+  const struct reduce_variant *variant = find_variant(accumulators);
+  return variant && method < REDUCE_METHOD_COUNT ? variant->f64[method] : NULL;
+}
+
+int64_t reduce_sum_i32(const int32_t *data, size_t n)
+{
+  return reduce_sum_i32_for(REDUCE_DEFAULT_ACCUMULATORS)(data, n);
+}
+
+int64_t reduce_sum_i64(const int64_t *data, size_t n)
+{
+  return reduce_sum_i64_for(REDUCE_DEFAULT_ACCUMULATORS)(data, n);
+}
+
+float reduce_sum_f32(const float *data, size_t n)
+{
+  return reduce_sum_f32_for(REDUCE_PAIRWISE, REDUCE_DEFAULT_ACCUMULATORS)(data, n);
+}
+
+double reduce_sum_f64(const double *data, size_t n)
+{
+  return reduce_sum_f64_for(REDUCE_PAIRWISE, REDUCE_DEFAULT_ACCUMULATORS)(data, n);
+}
+
+/**
+ * @brief Defines reduce_sum_<name>_parallel.
+ *
+ * Thread t sums elements [n t / T, n (t + 1) / T) and stores one partial
+ * sum; the partials are then added in thread order with `combine`.
+ */
+#ifdef _OPENMP
+/**
+ * @brief Adds integer partial sums.
+ */
+static int64_t combine_int(const int64_t *partials, int count)
+{
+  int64_t sum = 0;
+  for (int t = 0; t < count; t++)
+    sum += partials[t];
+  return sum;
+}
+
+/**
+ * @brief Adds float partial sums with Kahan summation.
+ */
+static float combine_f32(const float *partials, int count)
+{
+  float sum = 0, comp = 0;
+  for (int t = 0; t < count; t++)
+    KAHAN_ADD(sum, comp, partials[t]);
+  return sum;
+}
+
+/**
+ * @brief Adds double partial sums with Kahan summation.
+ */
+static double combine_f64(const double *partials, int count)
+{
+  double sum = 0, comp = 0;
+  for (int t = 0; t < count; t++)
+    KAHAN_ADD(sum, comp, partials[t]);
+  return sum;
+}
+
+#define DEFINE_REDUCE_PARALLEL(name, in_t, acc_t, combine)                                   \
+  acc_t reduce_sum_##name##_parallel(reduce_##name##_fn kernel, const in_t *data, size_t n) \
+  {                                                                                          \
+    const int max_threads = omp_get_max_threads();                                           \
+    acc_t *partials = (acc_t *)calloc((size_t)max_threads, sizeof(acc_t));                   \
+    if (!partials)                                                                           \
+      return kernel(data, n);                                                                \
+    int threads = 1;                                                                         \
+    _Pragma("omp parallel")                                                                  \
+    {                                                                                        \
+      const int t = omp_get_thread_num();                                                    \
+      const int count = omp_get_num_threads();                                               \
+      const size_t begin = n * t / count;                                                    \
+      const size_t end = n * (t + 1) / count;                                                \
+      partials[t] = kernel(data + begin, end - begin);                                       \
+      if (t == 0)                                                                            \
+        threads = count;                                                                     \
+    }                                                                                        \
+    acc_t sum = combine(partials, threads);                                                  \
+    free(partials);                                                                          \
+    return sum;                                                                              \
+  }
+#else
+#define DEFINE_REDUCE_PARALLEL(name, in_t, acc_t, combine)                                   \
+  acc_t reduce_sum_##name##_parallel(reduce_##name##_fn kernel, const in_t *data, size_t n) \
+  {                                                                                          \
+    return kernel(data, n);                                                                  \
+  }
+#endif
+
+DEFINE_REDUCE_PARALLEL(i32, int32_t, int64_t, combine_int)
+DEFINE_REDUCE_PARALLEL(i64, int64_t, int64_t, combine_int)
+DEFINE_REDUCE_PARALLEL(f32, float, float, combine_f32)
+DEFINE_REDUCE_PARALLEL(f64, double, double, combine_f64)
+
+const char *reduce_method_name(reduce_method method)
+{
+  static const char *names[REDUCE_METHOD_COUNT] = {"plain", "kahan", "pairwise"};
+  return method < REDUCE_METHOD_COUNT ? names[method] : "unknown";
+}
@@ -0,0 +1,156 @@
+/**
+ * @file reduce.h
+ * @brief Multi-accumulator SIMD sum reductions for int32/int64/float/double arrays.
+ *
+ * Generalizes the hand-written `sum_independent_2/4/8` of task 2. A sum
+ * with one accumulator runs at one add per add latency; with K
+ * independent accumulators the core can keep K adds in flight. Here each
+ * accumulator is also a SIMD vector of REDUCE_VECTOR_BYTES, so one
+ * iteration adds K x lanes elements: the kernels are generated by macro
+ * for every K in REDUCE_ACCUMULATOR_COUNTS and written with GCC/Clang
+ * vector extensions, so the same source becomes SSE or AVX2 code
+ * (`target_clones` picks the widest one the CPU supports at load time).
+ * The vector width is fixed at compile time, not per clone: a build with
+ * AVX-512 enabled (`-mavx512f`, or `-march=native` on such a CPU) uses
+ * 64-byte accumulators and no clones. Build every file that includes this
+ * header with the same flags, so they agree on REDUCE_VECTOR_BYTES.
+ *
+ * Unlike the task 2 functions, every kernel:
+ * - takes the element count and sums the remainder that does not fill a
+ *   whole iteration, so any n works;
+ * - sums int32 into int64 lanes, so sums of up to 2^32 elements cannot
+ *   overflow (int64 inputs are summed in int64 as usual);
+ * - for float/double, offers plain, Kahan (compensated) and pairwise
+ *   summation (reduce_method).
+ *
+ * The `_parallel` functions split the array into one contiguous chunk per
+ * OpenMP thread, run a serial kernel on each chunk and combine the
+ * per-thread partial sums in thread order (compensated for floating
+ * point), so a given thread count always gives the same result. Without
+ * `-fopenmp` they run the kernel serially.
+ *
+ * Kahan summation relies on strict IEEE evaluation: do not build this
+ * file with `-ffast-math`, which lets the compiler cancel the
+ * compensation.
+ */
+
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __AVX512F__
+#define REDUCE_VECTOR_BYTES 64          ///< Bytes of one SIMD accumulator (one zmm register).
+#else
+#define REDUCE_VECTOR_BYTES 32          ///< Bytes of one SIMD accumulator (one ymm register).
+#endif
+#define REDUCE_DEFAULT_ACCUMULATORS 4   ///< Accumulators of the default kernels.
+#define REDUCE_PAIRWISE_BLOCK 256       ///< Elements summed directly at the leaves of pairwise summation.
+
+/**
+ * @brief Accumulator counts for which kernels are generated.
+ */
+#define REDUCE_ACCUMULATOR_COUNTS(X) X(1) X(2) X(4) X(8) X(16)
+
+/**
+ * @enum reduce_method
+ * @brief Summation algorithm of the floating-point kernels.
+ */
+typedef enum
+{
+  REDUCE_PLAIN,    ///< K x lanes running sums; error grows with n / (K x lanes).
+  REDUCE_KAHAN,    ///< Compensated sums; error independent of n, about 4x the adds.
+  REDUCE_PAIRWISE, ///< Recursive halves down to REDUCE_PAIRWISE_BLOCK; error grows with log n.
+  REDUCE_METHOD_COUNT
+} reduce_method;
+
+typedef int64_t (*reduce_i32_fn)(const int32_t *data, size_t n);
+typedef int64_t (*reduce_i64_fn)(const int64_t *data, size_t n);
+typedef float (*reduce_f32_fn)(const float *data, size_t n);
+typedef double (*reduce_f64_fn)(const double *data, size_t n);
+
+/**
+ * @brief Returns the int32 kernel with the given number of accumulators.
+ * @return Kernel, or NULL if accumulators is not in REDUCE_ACCUMULATOR_COUNTS.
+ */
+reduce_i32_fn reduce_sum_i32_for(int accumulators);
+
+/**
+ * @brief Returns the int64 kernel with the given number of accumulators.
+ * @return Kernel, or NULL if accumulators is not in REDUCE_ACCUMULATOR_COUNTS.
+ */
+reduce_i64_fn reduce_sum_i64_for(int accumulators);
+
+/**
+ * @brief Returns the float kernel with the given method and number of accumulators.
+ * @return Kernel, or NULL if accumulators is not in REDUCE_ACCUMULATOR_COUNTS.
+ */
+reduce_f32_fn reduce_sum_f32_for(reduce_method method, int accumulators);
+
+/**
+ * @brief Returns the double kernel with the given method and number of accumulators.
+ * @return Kernel, or NULL if accumulators is not in REDUCE_ACCUMULATOR_COUNTS.
+ */
+reduce_f64_fn reduce_sum_f64_for(reduce_method method, int accumulators);
+
+/**
+ * @brief Sums int32 values into an int64 (REDUCE_DEFAULT_ACCUMULATORS accumulators).
+ */
+int64_t reduce_sum_i32(const int32_t *data, size_t n);
+
+/**
+ * @brief Sums int64 values (REDUCE_DEFAULT_ACCUMULATORS accumulators).
+ */
+int64_t reduce_sum_i64(const int64_t *data, size_t n);
+
+/**
+ * @brief Sums float values with pairwise summation.
+ */
+float reduce_sum_f32(const float *data, size_t n);
+
+/**
+ * @brief Sums double values with pairwise summation.
+ */
+double reduce_sum_f64(const double *data, size_t n);
+
+/**
+ * @brief Sums int32 values with one chunk per OpenMP thread.
+ * @param kernel Serial kernel run on each chunk (e.g. from reduce_sum_i32_for()).
+ */
+int64_t reduce_sum_i32_parallel(reduce_i32_fn kernel, const int32_t *data, size_t n);
+
+/**
+ * @brief Sums int64 values with one chunk per OpenMP thread.
+ * @param kernel Serial kernel run on each chunk.
+ */
+int64_t reduce_sum_i64_parallel(reduce_i64_fn kernel, const int64_t *data, size_t n);
+
+/**
+ * @brief Sums float values with one chunk per OpenMP thread; partial sums are combined with Kahan summation.
+ * @param kernel Serial kernel run on each chunk.
+ */
+float reduce_sum_f32_parallel(reduce_f32_fn kernel, const float *data, size_t n);
+
+/**
+ * @brief Sums double values with one chunk per OpenMP thread; partial sums are combined with Kahan summation.
+ * @param kernel Serial kernel run on each chunk.
+ */
+double reduce_sum_f64_parallel(reduce_f64_fn kernel, const double *data, size_t n);
+
+/**
+ * @brief Returns the printable name of a method ("plain", "kahan", "pairwise").
+ */
+const char *reduce_method_name(reduce_method method);
+
+/**
+ * @brief Sums an array with the default kernel of its element type.
+ */
+#define reduce_sum(data, n) \
+  _Generic((data),          \
+      int32_t *: reduce_sum_i32, const int32_t *: reduce_sum_i32, \
+      int64_t *: reduce_sum_i64, const int64_t *: reduce_sum_i64, \
+      float *: reduce_sum_f32, const float *: reduce_sum_f32,     \
+      double *: reduce_sum_f64, const double *: reduce_sum_f64)(data, n)
+
+#endif
@@ -0,0 +1,231 @@
+/**
+ * @file rng.c
+ * @brief Philox4x32-10 and xoshiro256** generators, jump-ahead, bulk fill and the shared Monte Carlo loop.
+ */
+
+#include "rng.h"
+
+#include <stdlib.h>
+
+#define PHILOX_M0 0xD2511F53u ///< Multiplier of counter word 0.
+#define PHILOX_M1 0xCD9E8D57u ///< Multiplier of counter word 2.
+#define PHILOX_W0 0x9E3779B9u ///< Key schedule increment (golden ratio).
+#define PHILOX_W1 0xBB67AE85u ///< Key schedule increment (sqrt(3) - 1).
+#define PHILOX_ROUNDS 10
+
+static uint64_t splitmix64(uint64_t *x)
+{
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+void rng_xoshiro_seed(rng_xoshiro *r, uint64_t seed)
+{
+  // splitmix64 is a bijection of a counter, so the four words are never all zero.
+  for (int i = 0; i < 4; i++)
+    r->s[i] = splitmix64(&seed);
+}
+
+/**
+ * @brief Replaces the state by the sum of the states reached at the set bits of a jump polynomial.
+ */
+static void xoshiro_jump_by(rng_xoshiro *r, const uint64_t polynomial[4])
+{
+  uint64_t s[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; i++)
+  {
+    for (int b = 0; b < 64; b++)
+    {
+      if (polynomial[i] & (1ULL << b))
+      {
+        for (int k = 0; k < 4; k++)
+          s[k] ^= r->s[k];
+      }
+      rng_xoshiro_next(r);
+    }
+  }
+  for (int k = 0; k < 4; k++)
+    r->s[k] = s[k];
+}
+
+void rng_xoshiro_jump(rng_xoshiro *r)
+{
+  static const uint64_t jump[4] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL,
+                                   0x39ABDC4529B1661CULL};
+  xoshiro_jump_by(r, jump);
+}
+
+void rng_xoshiro_long_jump(rng_xoshiro *r)
+{
+  static const uint64_t long_jump[4] = {0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL,
+                                        0x39109BB02ACBE635ULL};
+  xoshiro_jump_by(r, long_jump);
+}
+
+void rng_xoshiro_stream(rng_xoshiro *r, uint64_t seed, uint64_t stream)
+{
+  rng_xoshiro_seed(r, seed);
+  for (uint64_t i = 0; i < stream; i++)
+    rng_xoshiro_jump(r);
+}
+
+void rng_xoshiro_fill_uniform(rng_xoshiro *r, double *out, size_t count)
+{
+  // A local copy keeps the state in registers; through r, any store to out could change it.
+  rng_xoshiro local = *r;
+  for (size_t i = 0; i < count; i++)
+    out[i] = rng_uniform(rng_xoshiro_next(&local));
+  *r = local;
+}
+
+static inline void philox_round(uint32_t c[4], const uint32_t k[2])
+{
+  const uint64_t p0 = (uint64_t)PHILOX_M0 * c[0];
+  const uint64_t p1 = (uint64_t)PHILOX_M1 * c[2];
+  const uint32_t c1 = c[1], c3 = c[3];
+  c[0] = (uint32_t)(p1 >> 32) ^ c1 ^ k[0];
+  c[1] = (uint32_t)p1;
+  c[2] = (uint32_t)(p0 >> 32) ^ c3 ^ k[1];
+  c[3] = (uint32_t)p0;
+}
+
+void rng_philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+{
+  uint32_t c[4] = {counter[0], counter[1], counter[2], counter[3]};
+  uint32_t k[2] = {key[0], key[1]};
+  for (int round = 0; round < PHILOX_ROUNDS; round++)
+  {
+    if (round > 0)
+    {
+      k[0] += PHILOX_W0;
+      k[1] += PHILOX_W1;
+    }
+    philox_round(c, k);
+  }
+  for (int i = 0; i < 4; i++)
+    out[i] = c[i];
+}
+
+void rng_philox_init(rng_philox *r, uint64_t seed, uint64_t stream)
+{
+  r->index = 0;
+  r->stream = stream;
+  r->key[0] = (uint32_t)seed;
+  r->key[1] = (uint32_t)(seed >> 32);
+}
+
+void rng_philox_next2(rng_philox *r, uint64_t out[2])
+{
+  const uint32_t counter[4] = {(uint32_t)r->index, (uint32_t)(r->index >> 32), (uint32_t)r->stream,
+                               (uint32_t)(r->stream >> 32)};
+  uint32_t block[4];
+  rng_philox4x32(counter, r->key, block);
+  r->index++;
+  out[0] = (uint64_t)block[1] << 32 | block[0];
+  out[1] = (uint64_t)block[3] << 32 | block[2];
+}
+
+/**
+ * @brief Blocks index .. index + RNG_PHILOX_LANES - 1 of a stream, as 2 RNG_PHILOX_LANES uniforms.
+ *
+ * The four counter words are kept as arrays over the lanes, so every step
+ * of a round is the same operation on RNG_PHILOX_LANES independent values
+ * (the 32 x 32 -> 64 products become vpmuludq).
+ */
+static void philox_lanes(const rng_philox *r, uint64_t index, double *out)
+{
+  uint32_t c0[RNG_PHILOX_LANES], c1[RNG_PHILOX_LANES], c2[RNG_PHILOX_LANES], c3[RNG_PHILOX_LANES];
+  for (int l = 0; l < RNG_PHILOX_LANES; l++)
+  {
+    const uint64_t i = index + (uint64_t)l;
+    c0[l] = (uint32_t)i;
+    c1[l] = (uint32_t)(i >> 32);
+    c2[l] = (uint32_t)r->stream;
+    c3[l] = (uint32_t)(r->stream >> 32);
+  }
+  uint32_t k0 = r->key[0], k1 = r->key[1];
+  for (int round = 0; round < PHILOX_ROUNDS; round++)
+  {
+#pragma GCC unroll 8
+    for (int l = 0; l < RNG_PHILOX_LANES; l++)
+    {
+      const uint64_t p0 = (uint64_t)PHILOX_M0 * c0[l];
+      const uint64_t p1 = (uint64_t)PHILOX_M1 * c2[l];
+      const uint32_t old1 = c1[l], old3 = c3[l];
+      c0[l] = (uint32_t)(p1 >> 32) ^ old1 ^ k0;
+      c1[l] = (uint32_t)p1;
+      c2[l] = (uint32_t)(p0 >> 32) ^ old3 ^ k1;
+      c3[l] = (uint32_t)p0;
+    }
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  for (int l = 0; l < RNG_PHILOX_LANES; l++)
+  {
+    out[2 * l] = rng_uniform((uint64_t)c1[l] << 32 | c0[l]);
+    out[2 * l + 1] = rng_uniform((uint64_t)c3[l] << 32 | c2[l]);
+  }
+}
+
+void rng_philox_fill_uniform(rng_philox *r, double *out, size_t count)
+{
+  size_t i = 0;
+  for (; i + 2 * RNG_PHILOX_LANES <= count; i += 2 * RNG_PHILOX_LANES)
+  {
+    philox_lanes(r, r->index, out + i);
+    r->index += RNG_PHILOX_LANES;
+  }
+  for (; i < count; i += 2)
+  {
+    uint64_t pair[2];
+    rng_philox_next2(r, pair);
+    out[i] = rng_uniform(pair[0]);
+    if (i + 1 < count)
+      out[i + 1] = rng_uniform(pair[1]);
+  }
+}
+
+uint64_t rng_philox_count_in_circle(uint64_t seed, uint64_t n)
+{
+  uint64_t count = 0;
+#pragma omp parallel reduction(+ : count)
+  {
+    rng_philox rng;
+    rng_philox_init(&rng, seed, 0);
+    double uniforms[2 * RNG_PHILOX_FILL];
+
+#pragma omp for schedule(static)
+    for (uint64_t first = 0; first < n; first += RNG_PHILOX_FILL)
+    {
+      const size_t samples = n - first < RNG_PHILOX_FILL ? (size_t)(n - first) : RNG_PHILOX_FILL;
+      rng_philox_seek(&rng, first);
+      rng_philox_fill_uniform(&rng, uniforms, 2 * samples);
+      for (size_t s = 0; s < samples; s++)
+      {
+        const double x = uniforms[2 * s];
+        const double y = uniforms[2 * s + 1];
+        count += x * x + y * y <= 1.0;
+      }
+    }
+  }
+  return count;
+}
+
+rng_thread_state *rng_thread_states(uint64_t seed, int threads)
+{
+  rng_thread_state *states =
+      (rng_thread_state *)aligned_alloc(RNG_CACHE_LINE, (size_t)threads * sizeof(rng_thread_state));
+  if (!states)
+    return NULL;
+  rng_xoshiro xoshiro;
+  rng_xoshiro_seed(&xoshiro, seed);
+  for (int t = 0; t < threads; t++)
+  {
+    states[t].xoshiro = xoshiro;
+    rng_xoshiro_jump(&xoshiro);
+    rng_philox_init(&states[t].philox, seed, (uint64_t)t);
+  }
+  return states;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file rng.h
+ * @brief Parallel random number generators: counter-based Philox4x32-10 and xoshiro256** with jump-ahead.
+ *
+ * The Monte Carlo estimators of tasks 6, 8 and 10 draw their points with
+ * `rand()`, whose hidden state is shared by every thread behind a lock (so
+ * the threads take turns), or with `rand_r()` seeded with
+ * `time(NULL) ^ thread`, which gives nearby 32-bit seeds (correlated
+ * streams) and a different answer on every run. This module gives each
+ * thread an independent stream from one 64-bit seed:
+ *
+ * - Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1,
+ *   2, 3", SC'11) is counter-based: block i of stream s is a pure function
+ *   of (seed, s, i), ten rounds of 32 x 32 -> 64-bit multiplies. Any thread
+ *   can seek to any index in O(1), so sample i can always use block i, and
+ *   the result of a fixed seed does not depend on how the samples are
+ *   split over threads;
+ * - xoshiro256** (Blackman and Vigna) is a 256-bit linear generator, one
+ *   of the fastest of good quality. rng_xoshiro_jump() advances it by
+ *   2^128 draws, so stream t (the seed jumped t times) never overlaps the
+ *   others in practice; for thread-count independence, give the streams to
+ *   fixed blocks of samples instead of to threads.
+ *
+ * Uniforms take the top 53 bits of a 64-bit draw, so they lie in [0, 1)
+ * with the full double precision. The fill functions write many uniforms
+ * per call; the Philox one computes RNG_PHILOX_LANES blocks side by side,
+ * which the compiler turns into SIMD multiplies. rng_thread_states()
+ * allocates one state per thread, each on its own cache line, so the
+ * threads never write to a line another thread reads.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RNG_CACHE_LINE 64     ///< Alignment of a per-thread state.
+#define RNG_PHILOX_LANES 8    ///< Philox blocks computed together by rng_philox_fill_uniform().
+#define RNG_DEFAULT_SEED 2025 ///< Seed of the reproducible runs.
+#define RNG_PHILOX_FILL 4096  ///< Points drawn per bulk fill by rng_philox_count_in_circle().
+
+/**
+ * @struct rng_xoshiro
+ * @brief xoshiro256** state (must not be all zero; rng_xoshiro_seed never makes it so).
+ */
+typedef struct
+{
+  uint64_t s[4];
+} rng_xoshiro;
+
+/**
+ * @struct rng_philox
+ * @brief A Philox4x32-10 stream: the key and the 128-bit counter (index, stream).
+ */
+typedef struct
+{
+  uint64_t index;  ///< Next block (low 64 bits of the counter).
+  uint64_t stream; ///< Stream id (high 64 bits of the counter).
+  uint32_t key[2]; ///< The seed.
+} rng_philox;
+
+/**
+ * @struct rng_thread_state
+ * @brief One thread's generators, alone on a cache line.
+ */
+typedef struct
+{
+  _Alignas(RNG_CACHE_LINE) rng_xoshiro xoshiro; ///< The seed jumped `thread` times.
+  rng_philox philox;                             ///< Stream `thread` of the seed.
+} rng_thread_state;
+
+/**
+ * @brief Top 53 bits of x as a double in [0, 1).
+ */
+static inline double rng_uniform(uint64_t x)
+{
+  return (double)(int64_t)(x >> 11) * 0x1.0p-53; // < 2^53, so the signed conversion is exact
+}
+
+static inline uint64_t rng_rotl(uint64_t x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Next 64-bit draw of xoshiro256**.
+ */
+static inline uint64_t rng_xoshiro_next(rng_xoshiro *r)
+{
+  uint64_t *s = r->s;
+  const uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rng_rotl(s[3], 45);
+  return result;
+}
+
+/**
+ * @brief Seeds xoshiro256** from a 64-bit seed with splitmix64.
+ */
+void rng_xoshiro_seed(rng_xoshiro *r, uint64_t seed);
+
+/**
+ * @brief Advances by 2^128 draws (2^128 non-overlapping streams of 2^128 draws).
+ */
+void rng_xoshiro_jump(rng_xoshiro *r);
+
+/**
+ * @brief Advances by 2^192 draws (for a second level of splitting, e.g. per process).
+ */
+void rng_xoshiro_long_jump(rng_xoshiro *r);
+
+/**
+ * @brief Stream `stream` of a seed: the seeded state jumped `stream` times (O(stream) jumps).
+ */
+void rng_xoshiro_stream(rng_xoshiro *r, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Writes `count` uniforms in [0, 1).
+ */
+void rng_xoshiro_fill_uniform(rng_xoshiro *r, double *out, size_t count);
+
+/**
+ * @brief The Philox4x32-10 bijection: out = philox(counter, key).
+ */
+void rng_philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+/**
+ * @brief Starts stream `stream` of a seed at index 0.
+ */
+void rng_philox_init(rng_philox *r, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Moves to block `index`; block i gives uniforms 2i and 2i + 1 of the stream.
+ */
+static inline void rng_philox_seek(rng_philox *r, uint64_t index)
+{
+  r->index = index;
+}
+
+/**
+ * @brief Next block as two 64-bit draws.
+ */
+void rng_philox_next2(rng_philox *r, uint64_t out[2]);
+
+/**
+ * @brief Writes `count` uniforms in [0, 1), two per block (an odd count discards the last half block).
+ */
+void rng_philox_fill_uniform(rng_philox *r, double *out, size_t count);
+
+/**
+ * @brief Monte Carlo count of the points of the unit square inside the quarter circle, split over OpenMP threads.
+ *
+ * Point i is block i of stream 0 of the seed (x and y are its two
+ * uniforms), drawn RNG_PHILOX_FILL points per bulk fill, so the threads
+ * share no generator state and the count is the same for any number of
+ * threads. Without `-fopenmp` the loop runs serially.
+ *
+ * @return How many of the first `n` points satisfy x^2 + y^2 <= 1.
+ */
+uint64_t rng_philox_count_in_circle(uint64_t seed, uint64_t n);
+
+/**
+ * @brief Allocates `threads` cache-line-aligned states: thread t gets xoshiro stream t and Philox stream t of the seed.
+ * @return The states (release with free()), or NULL if the allocation failed.
+ */
+rng_thread_state *rng_thread_states(uint64_t seed, int threads);
+
+#endif
@@ -6,72 +6,214 @@
  * using both row-major and column-major access patterns, and measures execution
  * time for each method. The goal is to analyze performance differences based
  * on memory access patterns and cache utilization.
+ *
+ * The matrix lives in one contiguous aligned buffer (see matvec.h). The
+ * `--layout row|col` option selects its storage order, so both traversals
+ * (and their cache-blocked variants) are compared on the same storage.
+ * The row-wise product is also run with every SIMD dot-product kernel the
+ * CPU supports (see matvec_simd.h), on int32 storage or, with `--type`, on
+ * an int8, int16, half or float copy of the matrix (see
+ * matvec_precision.h), reporting bytes moved and bandwidth. `--type all`
+ * compares every element type with the selected kernel.
+ *
+ * With `--parallel`, the matrix is filled by first touch from the OpenMP
+ * threads and the row-partitioned and column-partitioned OpenMP kernels
+ * are timed as well (`--threads N` sets the thread count).
+ *
+ * With `--batch`, the same matrix is multiplied by K = 1..64 interleaved
+ * vectors at once (see matvec_batch.c), reporting GFLOP/s and bytes per
+ * flop for each K.
+ *
+ * With `--sparse`, the matrix is refilled at several densities and the
+ * dense SIMD product is compared with CSR and SELL-C-sigma SpMV (see
+ * matvec_sparse.h), serial and OpenMP, in time and memory.
+ *
+ * Every time shown is the median of repeated runs taken with the shared
+ * harness of common/bench.h; its options (`--reps`, `--warmup`, `--cold`,
+ * `--clock`, `--csv`, `--json`) are accepted as well.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#include <sys/time.h>
+#include <omp.h>
+
+#include "matvec.h"
+#include "matvec_simd.h"
+#include "matvec_precision.h"
+#include "matvec_sparse.h"
+#include "../common/bench.h"
 
 #define SIZE 10000 ///< Default matrix and vector size.
+#define SELL_SIGMA 512 ///< Sorting window of the SELL-C-sigma format in the density sweep.
+
+static bench_session session; ///< Every measurement of this run, written as CSV/JSON at the end.
+
+/**
+ * @struct kernel_call
+ * @brief Arguments of one measured call; each measure function uses the fields it needs.
+ */
+struct kernel_call
+{
+  matvec_kernel kernel;                                    ///< Dense kernel.
+  void (*csr_kernel)(const matvec_csr *, const int *, int *);   ///< CSR kernel.
+  void (*sell_kernel)(const matvec_sell *, const int *, int *); ///< SELL-C-sigma kernel.
+  const matvec_matrix *matrix;                             ///< Dense input matrix.
+  const matvec_typed_matrix *typed;                        ///< Typed copy of the matrix.
+  const matvec_csr *csr;                                   ///< CSR input matrix.
+  const matvec_sell *sell;                                 ///< SELL-C-sigma input matrix.
+  matvec_isa isa;                                          ///< Instruction set of the typed product.
+  const int *vector;                                       ///< Input vector(s).
+  int *result;                                             ///< Output vector(s).
+  size_t k;                                                ///< Number of vectors of a batched product.
+};
+
+static void run_kernel(void *arg)
+{
+  const struct kernel_call *call = arg;
+  call->kernel(call->matrix, call->vector, call->result);
+}
+
+static void run_typed(void *arg)
+{
+  const struct kernel_call *call = arg;
+  matvec_typed_mult(call->typed, call->isa, call->result);
+}
+
+static void run_batch(void *arg)
+{
+  const struct kernel_call *call = arg;
+  matvec_mult_batch(call->matrix, call->vector, call->result, call->k);
+}
+
+static void run_csr(void *arg)
+{
+  const struct kernel_call *call = arg;
+  call->csr_kernel(call->csr, call->vector, call->result);
+}
+
+static void run_sell(void *arg)
+{
+  const struct kernel_call *call = arg;
+  call->sell_kernel(call->sell, call->vector, call->result);
+}
 
 /**
  * @brief Function to measure execution time of a function call.
- * @param func Function pointer to the multiplication function.
+ * @param name Label of the measurement.
+ * @param func Multiplication kernel.
  * @param matrix Input matrix.
  * @param vector Input vector.
  * @param result Output vector.
- * @return Execution time in seconds.
+ * @return Median execution time in seconds.
  */
-double measure_execution_time(void (*func)(int **, int *, int *), int **matrix, int *vector, int *result)
+double measure_execution_time(const char *name, matvec_kernel func, const matvec_matrix *matrix, const int *vector, int *result)
 {
-  struct timeval start, end;
-  gettimeofday(&start, NULL);
+  struct kernel_call call = {.kernel = func, .matrix = matrix, .vector = vector, .result = result};
+  return bench_session_run(&session, name, run_kernel, &call).median;
+}
 
-  func(matrix, vector, result);
+/**
+ * @brief Measures one row-wise product with the kernels of a given ISA.
+ * @param name Label of the measurement.
+ * @param isa Instruction set of the dot-product kernel.
+ * @param typed Matrix and vector in the element type under test.
+ * @param result Output vector.
+ * @return Median execution time in seconds.
+ */
+double measure_simd_time(const char *name, matvec_isa isa, const matvec_typed_matrix *typed, int *result)
+{
+  struct kernel_call call = {.typed = typed, .isa = isa, .result = result};
+  return bench_session_run(&session, name, run_typed, &call).median;
+}
 
-  gettimeofday(&end, NULL);
+/**
+ * @brief Measures one batched product of the matrix by k interleaved vectors.
+ * @param name Label of the measurement.
+ * @param matrix Input matrix.
+ * @param vectors Interleaved input vectors.
+ * @param results Interleaved output vectors.
+ * @param k Number of vectors.
+ * @return Median execution time in seconds.
+ */
+double measure_batch_time(const char *name, const matvec_matrix *matrix, const int *vectors, int *results, size_t k)
+{
+  struct kernel_call call = {.matrix = matrix, .vector = vectors, .result = results, .k = k};
+  return bench_session_run(&session, name, run_batch, &call).median;
+}
 
-  double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
-  return elapsed;
+/**
+ * @brief Measures the execution time of a CSR sparse matrix-vector product.
+ * @param name Label of the measurement.
+ * @param func CSR kernel.
+ * @param csr Input matrix.
+ * @param vector Input vector.
+ * @param result Output vector.
+ * @return Median execution time in seconds.
+ */
+double measure_csr_time(const char *name, void (*func)(const matvec_csr *, const int *, int *), const matvec_csr *csr,
+                        const int *vector, int *result)
+{
+  struct kernel_call call = {.csr_kernel = func, .csr = csr, .vector = vector, .result = result};
+  return bench_session_run(&session, name, run_csr, &call).median;
 }
 
 /**
- * @brief Performs matrix-vector multiplication with row-major order.
- * @param matrix Input matrix.
+ * @brief Measures the execution time of a SELL-C-sigma sparse matrix-vector product.
+ * @param name Label of the measurement.
+ * @param func SELL-C-sigma kernel.
+ * @param sell Input matrix.
  * @param vector Input vector.
  * @param result Output vector.
+ * @return Median execution time in seconds.
  */
-void matrix_vector_multiplication_row(int **matrix, int *vector, int *result)
+double measure_sell_time(const char *name, void (*func)(const matvec_sell *, const int *, int *), const matvec_sell *sell,
+                         const int *vector, int *result)
 {
-  for (int i = 0; i < SIZE; i++)
+  struct kernel_call call = {.sell_kernel = func, .sell = sell, .vector = vector, .result = result};
+  return bench_session_run(&session, name, run_sell, &call).median;
+}
+
+/**
+ * @brief Prints the measurement whose runs were the most spread out.
+ *
+ * A relative standard deviation above a few percent means the numbers of
+ * this run should not be compared with another one.
+ */
+void print_spread(void)
+{
+  const bench_stats *worst = NULL;
+  for (size_t i = 0; i < session.count; i++)
   {
-    result[i] = 0;
-    for (int j = 0; j < SIZE; j++)
-    {
-      result[i] += matrix[i][j] * vector[j];
-    }
+    const bench_stats *stats = &session.results[i];
+    if (stats->mean > 0.0 && (!worst || stats->stddev / stats->mean > worst->stddev / worst->mean))
+      worst = stats;
   }
+  if (worst)
+    printf("> ⏱️ Largest spread: %s, stddev %.1f%% of the mean (p95 %f, median %f seconds)\n", worst->name,
+           100.0 * worst->stddev / worst->mean, worst->p95, worst->median);
 }
 
 /**
- * @brief Performs matrix-vector multiplication with column-major order.
- * @param matrix Input matrix.
- * @param vector Input vector.
- * @param result Output vector.
+ * @brief Prints the hardware counters of every measurement (with `--counters`).
+ *
+ * IPC separates kernels limited by dependencies from kernels limited by
+ * memory; misses are per 1000 instructions so kernels of different length
+ * compare directly.
  */
-void matrix_vector_multiplication_col(int **matrix, int *vector, int *result)
+void print_counters(void)
 {
-  for (int i = 0; i < SIZE; i++)
+  if (!session.counters_open)
   {
-    result[i] = 0;
+    return;
   }
-  for (int j = 0; j < SIZE; j++)
+  printf("> 📊 Hardware counters (per run):\n");
+  for (size_t i = 0; i < session.count; i++)
   {
-    for (int i = 0; i < SIZE; i++)
-    {
-      result[i] += matrix[i][j] * vector[j];
-    }
+    char prefix[128];
+    snprintf(prefix, sizeof(prefix), "  - %s: ", session.results[i].name);
+    bench_print_counters(prefix, &session.results[i]);
   }
 }
 
@@ -79,11 +221,12 @@ void matrix_vector_multiplication_col(int **matrix, int *vector, int *result)
  * @brief Compares two vectors for equality.
  * @param vec1 First vector.
  * @param vec2 Second vector.
+ * @param size Number of elements.
  * @return 1 if vectors are equal, 0 otherwise.
  */
-int compare_vectors(int *vec1, int *vec2)
+int compare_vectors(const int *vec1, const int *vec2, size_t size)
 {
-  for (int i = 0; i < SIZE; i++)
+  for (size_t i = 0; i < size; i++)
   {
     if (vec1[i] != vec2[i])
     {
@@ -93,24 +236,304 @@ int compare_vectors(int *vec1, int *vec2)
   return 1;
 }
 
+/**
+ * @brief Sweeps the batched product over K = 1..64 right-hand sides.
+ *
+ * For each K, reports the time, GFLOP/s (2 * rows * cols * K operations),
+ * the bytes per flop assuming the matrix, the vectors and the results each
+ * cross the memory bus once, and the speedup over K separate products by
+ * matvec_mult_row_parallel(). That baseline runs on the same OpenMP team
+ * as matvec_mult_batch(), so the speedup is the gain of batching alone.
+ * The first, middle and last vectors of each batch are checked against
+ * matvec_mult_row_simd().
+ *
+ * @param matrix Input matrix.
+ * @return 1 if every checked result matches, 0 otherwise.
+ */
+int run_batch_sweep(const matvec_matrix *matrix)
+{
+  const size_t k_values[] = {1, 2, 3, 4, 8, 12, 16, 24, 32, 48, 64};
+  const size_t max_k = k_values[sizeof(k_values) / sizeof(k_values[0]) - 1];
+  const size_t rows = matrix->rows, cols = matrix->cols;
+
+  int *vectors = (int *)malloc(cols * max_k * sizeof(int));
+  int *results = (int *)malloc(rows * max_k * sizeof(int));
+  int *single = (int *)malloc(cols * sizeof(int));
+  int *expected = (int *)malloc(rows * sizeof(int));
+  int *actual = (int *)malloc(rows * sizeof(int));
+  if (!vectors || !results || !single || !expected || !actual)
+  {
+    printf("> ❌ Memory allocation failed!\n");
+    return 0;
+  }
+
+  for (size_t j = 0; j < cols; j++)
+    single[j] = rand() % 10;
+  const double time_single =
+      measure_execution_time("row-partitioned (batch baseline)", matvec_mult_row_parallel, matrix, single, expected);
+  printf("\nBaseline: one vector, row-partitioned, %d threads: %f seconds\n", omp_get_max_threads(), time_single);
+
+  int match = 1;
+  printf("\n    K |   Time (s) | Time/vector (s) |  GFLOP/s | Bytes/flop | Speedup vs K x single\n");
+  printf("--------------------------------------------------------------------------------\n");
+  for (size_t t = 0; t < sizeof(k_values) / sizeof(k_values[0]); t++)
+  {
+    const size_t k = k_values[t];
+
+    for (size_t i = 0; i < cols * k; i++)
+      vectors[i] = rand() % 10;
+
+    char label[32];
+    snprintf(label, sizeof(label), "batch K=%zu", k);
+    double time_batch = measure_batch_time(label, matrix, vectors, results, k);
+    double flops = 2.0 * rows * cols * k;
+    double bytes = (double)sizeof(int) * (rows * cols + cols * k + rows * k);
+    printf("%5zu | %10.6f | %15.6f | %8.3f | %10.4f | %8.2fx\n", k, time_batch, time_batch / k,
+           flops / time_batch / 1e9, bytes / flops, time_single * k / time_batch);
+
+    const size_t checks[] = {0, k / 2, k - 1};
+    for (size_t c = 0; c < 3; c++)
+    {
+      const size_t v = checks[c];
+      for (size_t j = 0; j < cols; j++)
+        single[j] = vectors[j * k + v];
+      for (size_t i = 0; i < rows; i++)
+        actual[i] = results[i * k + v];
+      matvec_mult_row_simd(matrix, single, expected);
+      if (!compare_vectors(expected, actual, rows))
+      {
+        printf("> ❌ Batched result for K=%zu, vector %zu does NOT match!\n", k, v);
+        match = 0;
+      }
+    }
+  }
+  printf("\n");
+
+  free(vectors);
+  free(results);
+  free(single);
+  free(expected);
+  free(actual);
+  return match;
+}
+
+/**
+ * @brief Compares the row-wise product over every element type with the selected SIMD kernel.
+ *
+ * For each type, reports the bytes per element, the bytes moved by one
+ * product (matrix and vector read once, result written once), the time,
+ * the achieved bandwidth and the speedup over int32 storage.
+ *
+ * @param matrix Input matrix (row-major storage).
+ * @param vector Input vector.
+ * @param expected Result of matvec_mult_row().
+ * @return 1 if every result matches, 0 otherwise.
+ */
+int run_type_sweep(const matvec_matrix *matrix, const int *vector, const int *expected)
+{
+  const matvec_isa isa = matvec_selected_isa();
+  int *actual = (int *)malloc(matrix->rows * sizeof(int));
+  if (!actual)
+  {
+    printf("> ❌ Memory allocation failed!\n");
+    return 0;
+  }
+
+  int match = 1;
+  double time_int32 = 0.0;
+  printf("\n📏 Element types (%s kernels)\n\n", matvec_isa_name(isa));
+  printf("  Type | Bytes/elem | Moved (MB) |   Time (s) |   GB/s | Speedup vs int32\n");
+  printf("--------------------------------------------------------------------------\n");
+  // int32 first, so the other types can be compared with it.
+  const matvec_type order[] = {MATVEC_TYPE_INT32, MATVEC_TYPE_INT16, MATVEC_TYPE_INT8, MATVEC_TYPE_FLOAT, MATVEC_TYPE_HALF};
+  for (size_t t = 0; t < sizeof(order) / sizeof(order[0]); t++)
+  {
+    matvec_typed_matrix typed;
+    if (matvec_typed_from(matrix, vector, order[t], &typed) != 0)
+    {
+      printf("> ❌ Memory allocation failed!\n");
+      free(actual);
+      return 0;
+    }
+
+    char label[32];
+    snprintf(label, sizeof(label), "type %s", matvec_type_name(order[t]));
+    double time_type = measure_simd_time(label, isa, &typed, actual);
+    double bytes = (double)matvec_typed_bytes(&typed);
+    int type_match = compare_vectors(expected, actual, matrix->rows);
+    if (order[t] == MATVEC_TYPE_INT32)
+      time_int32 = time_type;
+    printf("%6s | %10zu | %10.1f | %10.6f | %6.2f | %8.2fx %s\n", matvec_type_name(order[t]), matvec_type_size(order[t]),
+           bytes / (1024 * 1024), time_type, bytes / time_type / 1e9, time_int32 / time_type, type_match ? "✅" : "❌");
+    match = match && type_match;
+
+    matvec_typed_free(&typed);
+  }
+  printf("\n");
+
+  free(actual);
+  return match;
+}
+
+/**
+ * @brief Sweeps the density of the matrix and compares dense and sparse products.
+ *
+ * For each density, the matrix is refilled, converted to CSR and to
+ * SELL-C-sigma (chunk height = SIMD width in ints), and every sparse kernel
+ * is checked against matvec_mult_row() on the dense copy.
+ *
+ * @param matrix Dense matrix, overwritten at each density.
+ * @param vector Input vector, overwritten at each density.
+ * @return 1 if every sparse result matches, 0 otherwise.
+ */
+int run_sparse_sweep(matvec_matrix *matrix, int *vector)
+{
+  const double densities[] = {0.001, 0.005, 0.01, 0.05, 0.1, 0.25, 0.5};
+  const size_t rows = matrix->rows;
+  const size_t chunk = matvec_selected_isa() == MATVEC_ISA_AVX512 ? 16 : 8;
+  const double dense_mb = (double)rows * matrix->cols * sizeof(int) / (1024 * 1024);
+
+  int *expected = (int *)malloc(rows * sizeof(int));
+  int *actual = (int *)malloc(rows * sizeof(int));
+  if (!expected || !actual)
+  {
+    printf("> ❌ Memory allocation failed!\n");
+    return 0;
+  }
+
+  int match = 1;
+  printf("\n🕸️ Sparse sweep (SELL-%zu-%d, dense storage: %.1f MB)\n\n", chunk, SELL_SIGMA, dense_mb);
+  printf(" Density |       nnz |  CSR MB | SELL MB | Dense SIMD (s) |  CSR (s) | CSR omp (s) | SELL (s) | SELL omp (s)\n");
+  printf("------------------------------------------------------------------------------------------------------------\n");
+  for (size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); d++)
+  {
+    matvec_csr csr;
+    matvec_sell sell;
+
+    matvec_fill_random_sparse(matrix, vector, densities[d]);
+    if (matvec_csr_from_dense(matrix, &csr) != 0 || matvec_sell_from_csr(&csr, chunk, SELL_SIGMA, &sell) != 0)
+    {
+      printf("> ❌ Memory allocation failed!\n");
+      free(expected);
+      free(actual);
+      return 0;
+    }
+
+    matvec_mult_row(matrix, vector, expected);
+    char label[48];
+    snprintf(label, sizeof(label), "dense SIMD, density %.3f", densities[d]);
+    double time_dense = measure_execution_time(label, matvec_mult_row_simd, matrix, vector, actual);
+
+    snprintf(label, sizeof(label), "CSR, density %.3f", densities[d]);
+    double time_csr = measure_csr_time(label, matvec_csr_mult, &csr, vector, actual);
+    int density_match = compare_vectors(expected, actual, rows);
+    snprintf(label, sizeof(label), "CSR omp, density %.3f", densities[d]);
+    double time_csr_parallel = measure_csr_time(label, matvec_csr_mult_parallel, &csr, vector, actual);
+    density_match = density_match && compare_vectors(expected, actual, rows);
+    snprintf(label, sizeof(label), "SELL, density %.3f", densities[d]);
+    double time_sell = measure_sell_time(label, matvec_sell_mult, &sell, vector, actual);
+    density_match = density_match && compare_vectors(expected, actual, rows);
+    snprintf(label, sizeof(label), "SELL omp, density %.3f", densities[d]);
+    double time_sell_parallel = measure_sell_time(label, matvec_sell_mult_parallel, &sell, vector, actual);
+    density_match = density_match && compare_vectors(expected, actual, rows);
+
+    printf("%8.3f | %9zu | %7.1f | %7.1f | %14.6f | %8.6f | %11.6f | %8.6f | %12.6f %s\n", densities[d], csr.nnz,
+           matvec_csr_bytes(&csr) / (1024.0 * 1024.0), matvec_sell_bytes(&sell) / (1024.0 * 1024.0), time_dense,
+           time_csr, time_csr_parallel, time_sell, time_sell_parallel, density_match ? "✅" : "❌");
+    match = match && density_match;
+
+    matvec_csr_free(&csr);
+    matvec_sell_free(&sell);
+  }
+  printf("\n");
+
+  free(expected);
+  free(actual);
+  return match;
+}
+
+/**
+ * @brief Prints the command-line usage.
+ * @param program Program name.
+ */
+void print_usage(const char *program)
+{
+  printf("Usage: %s [--layout row|col] [--size N] [--type int8|int16|int32|half|float|all] [--parallel] [--threads N] [--batch] [--sparse]\n       %s\n", program, bench_usage());
+}
+
 /**
  * @brief Main function to initialize data and compare execution times.
  * @return 0 on successful execution.
  */
-int main()
+int main(int argc, char *argv[])
 {
-  printf("\n💡 Matrix-vector multiplication with SIZE=%d.\n\n", SIZE);
+  matvec_layout layout = MATVEC_ROW_MAJOR;
+  size_t size = SIZE;
+  matvec_type type = MATVEC_TYPE_INT32;
+  int all_types = 0;
+  int parallel = 0;
+  int batch = 0;
+  int sparse = 0;
+  bench_config config = bench_default_config();
 
-  int **matrix = (int **)malloc(SIZE * sizeof(int *));
-  for (int i = 0; i < SIZE; i++)
+  for (int i = 1; i < argc; i++)
   {
-    matrix[i] = (int *)malloc(SIZE * sizeof(int));
+    if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc && matvec_parse_layout(argv[i + 1], &layout) == 0)
+    {
+      i++;
+    }
+    else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+    {
+      size = (size_t)atol(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--type") == 0 && i + 1 < argc && strcmp(argv[i + 1], "all") == 0)
+    {
+      all_types = 1;
+      i++;
+    }
+    else if (strcmp(argv[i], "--type") == 0 && i + 1 < argc && matvec_parse_type(argv[i + 1], &type) == 0)
+    {
+      i++;
+    }
+    else if (strcmp(argv[i], "--sparse") == 0)
+    {
+      sparse = 1;
+    }
+    else if (strcmp(argv[i], "--batch") == 0)
+    {
+      batch = 1;
+    }
+    else if (strcmp(argv[i], "--parallel") == 0)
+    {
+      parallel = 1;
+    }
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+    {
+      omp_set_num_threads(atoi(argv[++i]));
+      parallel = 1;
+    }
+    else if (bench_parse_arg(&config, argc, argv, &i))
+    {
+      continue;
+    }
+    else
+    {
+      print_usage(argv[0]);
+      return 1;
+    }
   }
-  int *vector = (int *)malloc(SIZE * sizeof(int));
-  int *result_row = (int *)malloc(SIZE * sizeof(int));
-  int *result_col = (int *)malloc(SIZE * sizeof(int));
 
-  if (matrix == NULL || vector == NULL || result_row == NULL || result_col == NULL)
+  matvec_simd_init();
+  printf("\n💡 Matrix-vector multiplication with SIZE=%zu (%s storage).\n\n", size, matvec_layout_name(layout));
+
+  matvec_matrix matrix;
+  int alloc_status = matvec_alloc(&matrix, size, size, layout);
+  int *vector = (int *)malloc(size * sizeof(int));
+  int *result_row = (int *)malloc(size * sizeof(int));
+  int *result_col = (int *)malloc(size * sizeof(int));
+  int *result_blocked = (int *)malloc(size * sizeof(int));
+
+  if (alloc_status != 0 || vector == NULL || result_row == NULL || result_col == NULL || result_blocked == NULL)
   {
     printf("> ❌ Memory allocation failed!\n");
     return 1;
@@ -120,23 +543,113 @@ int main()
     printf("> ✅ Memory allocation success!\n");
   }
 
-  srand(time(NULL));
+  // Opens the counters before the first parallel region so the OpenMP workers inherit them.
+  bench_session_init(&session, &config);
+  if (config.counters && !session.counters_open)
+  {
+    printf("> ⚠️ Hardware counters unavailable (%s), check /proc/sys/kernel/perf_event_paranoid\n",
+           strerror(session.counters.error));
+  }
+
+  double init_start = bench_now(BENCH_CLOCK_RAW);
+  if (parallel)
+  {
+    matvec_fill_random_parallel(&matrix, vector, (unsigned int)time(NULL));
+  }
+  else
+  {
+    srand(time(NULL));
+    matvec_fill_random(&matrix, vector);
+  }
+  double time_init = bench_now(BENCH_CLOCK_RAW) - init_start;
+  printf("> 🧵 Initialization (%s): %f seconds\n", parallel ? "parallel first touch" : "serial", time_init);
+  printf("> ⏱️ Median of %d runs after %d warmup runs, %s cache\n", config.repetitions, config.warmup,
+         config.cache == BENCH_COLD ? "cold" : "warm");
+
+  matvec_tiling tiling = matvec_get_tiling();
+  printf("> 🧱 Tile: %zu rows x %zu columns, panel: %zu elements\n", tiling.row_block, tiling.col_block, tiling.panel);
+
+  double time_row = measure_execution_time("row-major", matvec_mult_row, &matrix, vector, result_row);
+  printf("\n- 🎯 Execution time (row-major): %f seconds\n", time_row);
+  double time_col = measure_execution_time("column-major", matvec_mult_col, &matrix, vector, result_col);
+  printf("- 🎯 Execution time (column-major): %f seconds\n", time_col);
+
+  int match = compare_vectors(result_row, result_col, size);
+
+  double time_row_blocked = measure_execution_time("row-major, blocked", matvec_mult_row_blocked, &matrix, vector, result_blocked);
+  printf("- 🎯 Execution time (row-major, blocked): %f seconds\n", time_row_blocked);
+  match = match && compare_vectors(result_row, result_blocked, size);
+
+  double time_col_blocked = measure_execution_time("column-major, blocked", matvec_mult_col_blocked, &matrix, vector, result_blocked);
+  printf("- 🎯 Execution time (column-major, blocked): %f seconds\n", time_col_blocked);
+  match = match && compare_vectors(result_row, result_blocked, size);
+
+  double time_simd = measure_execution_time("row-major, SIMD", matvec_mult_row_simd, &matrix, vector, result_blocked);
+  printf("- 🎯 Execution time (row-major, SIMD %s): %f seconds\n\n", matvec_isa_name(matvec_selected_isa()), time_simd);
+  match = match && compare_vectors(result_row, result_blocked, size);
+
+  if (batch)
+  {
+    match = run_batch_sweep(&matrix) && match;
+  }
+
+  if (parallel)
+  {
+    int threads = omp_get_max_threads();
+    double time_row_parallel = measure_execution_time("row-partitioned", matvec_mult_row_parallel, &matrix, vector, result_blocked);
+    printf("- 🧵 Execution time (row-partitioned, %d threads): %f seconds\n", threads, time_row_parallel);
+    match = match && compare_vectors(result_row, result_blocked, size);
+
+    double time_col_parallel = measure_execution_time("column-partitioned", matvec_mult_col_parallel, &matrix, vector, result_blocked);
+    printf("- 🧵 Execution time (column-partitioned, %d threads): %f seconds\n\n", threads, time_col_parallel);
+    match = match && compare_vectors(result_row, result_blocked, size);
+  }
 
-  for (int i = 0; i < SIZE; i++)
+  if (layout == MATVEC_ROW_MAJOR)
   {
-    for (int j = 0; j < SIZE; j++)
+    matvec_typed_matrix typed;
+    if (matvec_typed_from(&matrix, vector, type, &typed) != 0)
+    {
+      printf("> ❌ Memory allocation failed!\n");
+      return 1;
+    }
+
+    const double bytes = (double)matvec_typed_bytes(&typed);
+    for (int isa = MATVEC_ISA_SCALAR; isa < MATVEC_ISA_COUNT; isa++)
     {
-      matrix[i][j] = rand() % 10;
+      if (!matvec_isa_supported((matvec_isa)isa))
+        continue;
+      char label[32];
+      snprintf(label, sizeof(label), "%s dot, %s", matvec_type_name(type), matvec_isa_name((matvec_isa)isa));
+      double time_isa = measure_simd_time(label, (matvec_isa)isa, &typed, result_blocked);
+      int isa_match = compare_vectors(result_row, result_blocked, size);
+      printf("- 🧮 %s dot (%s): %f seconds, %.2f GB/s %s\n", matvec_type_name(type), matvec_isa_name((matvec_isa)isa), time_isa,
+             bytes / time_isa / 1e9, isa_match ? "✅" : "❌");
+      match = match && isa_match;
+    }
+    printf("\n");
+    matvec_typed_free(&typed);
+
+    if (all_types)
+    {
+      match = run_type_sweep(&matrix, vector, result_row) && match;
     }
-    vector[i] = rand() % 10;
   }
 
-  double time_row = measure_execution_time(matrix_vector_multiplication_row, matrix, vector, result_row);
-  printf("\n- 🎯 Execution time (row-major): %f seconds\n", time_row);
-  double time_col = measure_execution_time(matrix_vector_multiplication_col, matrix, vector, result_col);
-  printf("- 🎯 Execution time (column-major): %f seconds\n\n", time_col);
+  // Runs last: the sweep overwrites the matrix and the vector.
+  if (sparse)
+  {
+    match = run_sparse_sweep(&matrix, vector) && match;
+  }
 
-  if (compare_vectors(result_row, result_col))
+  print_spread();
+  print_counters();
+  if (bench_session_write(&session) != 0)
+  {
+    printf("> ❌ Could not write the benchmark report!\n");
+  }
+
+  if (match)
   {
     printf("> Results match! ✅\n\n");
   }
@@ -145,14 +658,12 @@ int main()
     printf("> Results do NOT match! ❌\n\n");
   }
 
-  for (int i = 0; i < SIZE; i++)
-  {
-    free(matrix[i]);
-  }
-  free(matrix);
+  matvec_free(&matrix);
   free(vector);
   free(result_row);
   free(result_col);
+  free(result_blocked);
+  bench_session_free(&session);
 
   return 0;
-}
\ No newline at end of file
+}
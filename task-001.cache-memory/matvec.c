@@ -0,0 +1,300 @@
+/**
+ * @file matvec.c
+ * @brief Contiguous, cache-blocked matrix-vector multiplication engine.
+ */
+
+#include "matvec.h"
+#include "matvec_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MATVEC_DEFAULT_L1 (32 * 1024)  ///< Fallback L1 data cache size in bytes.
+#define MATVEC_DEFAULT_L2 (256 * 1024) ///< Fallback L2 cache size in bytes.
+#define MATVEC_LINE_INTS (MATVEC_ALIGNMENT / sizeof(int))
+
+static matvec_tiling current_tiling = {0, 0, 0};
+
+/**
+ * @brief Rounds n up to a multiple of m.
+ */
+static size_t round_up(size_t n, size_t m)
+{
+  return (n + m - 1) / m * m;
+}
+
+int matvec_alloc(matvec_matrix *matrix, size_t rows, size_t cols, matvec_layout layout)
+{
+  size_t inner = layout == MATVEC_ROW_MAJOR ? cols : rows;
+  size_t outer = layout == MATVEC_ROW_MAJOR ? rows : cols;
+
+  // Pad every row/column to a whole number of cache lines, and avoid a
+  // leading dimension that is a multiple of 4 KB: otherwise consecutive
+  // rows alias to the same L1 set during a strided walk.
+  size_t ld = round_up(inner, MATVEC_LINE_INTS);
+  if ((ld * sizeof(int)) % 4096 == 0)
+    ld += MATVEC_LINE_INTS;
+
+  size_t bytes = round_up(ld * outer * sizeof(int), MATVEC_ALIGNMENT);
+  int *data = aligned_alloc(MATVEC_ALIGNMENT, bytes);
+  if (!data)
+    return -1;
+
+  matrix->data = data;
+  matrix->rows = rows;
+  matrix->cols = cols;
+  matrix->ld = ld;
+  matrix->layout = layout;
+  return 0;
+}
+
+void matvec_free(matvec_matrix *matrix)
+{
+  free(matrix->data);
+  matrix->data = NULL;
+}
+
+void matvec_fill_random(matvec_matrix *matrix, int *vector)
+{
+  for (size_t i = 0; i < matrix->rows; i++)
+  {
+    for (size_t j = 0; j < matrix->cols; j++)
+    {
+      *matvec_at(matrix, i, j) = rand() % 10;
+    }
+    if (i < matrix->cols)
+      vector[i] = rand() % 10;
+  }
+  for (size_t i = matrix->rows; i < matrix->cols; i++)
+    vector[i] = rand() % 10;
+}
+
+int matvec_parse_layout(const char *name, matvec_layout *layout)
+{
+  if (strcmp(name, "row") == 0)
+    *layout = MATVEC_ROW_MAJOR;
+  else if (strcmp(name, "col") == 0)
+    *layout = MATVEC_COL_MAJOR;
+  else
+    return -1;
+  return 0;
+}
+
+const char *matvec_layout_name(matvec_layout layout)
+{
+  return layout == MATVEC_ROW_MAJOR ? "row-major" : "column-major";
+}
+
+matvec_tiling matvec_default_tiling(void)
+{
+  long l1 = -1, l2 = -1;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+  l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+  if (l1 <= 0)
+    l1 = MATVEC_DEFAULT_L1;
+  if (l2 <= 0)
+    l2 = MATVEC_DEFAULT_L2;
+
+  // Four cache lines per tile row keeps each hardware prefetch stream
+  // useful; the tile height is whatever fills half of L1.
+  matvec_tiling tiling;
+  tiling.col_block = 4 * MATVEC_LINE_INTS;
+  tiling.row_block = (size_t)l1 / 2 / (tiling.col_block * sizeof(int));
+  tiling.row_block = tiling.row_block / MATVEC_LINE_INTS * MATVEC_LINE_INTS;
+  if (tiling.row_block < MATVEC_LINE_INTS)
+    tiling.row_block = MATVEC_LINE_INTS;
+
+  // The vector and result slices touched by one band of tiles must stay
+  // in L2 while the band is processed.
+  while ((tiling.row_block + tiling.col_block) * sizeof(int) > (size_t)l2 / 2 && tiling.row_block > MATVEC_LINE_INTS)
+    tiling.row_block /= 2;
+
+  tiling.panel = (size_t)l2 / 2 / sizeof(int);
+  return tiling;
+}
+
+void matvec_set_tiling(matvec_tiling tiling)
+{
+  matvec_tiling defaults = matvec_get_tiling();
+  current_tiling.row_block = tiling.row_block ? tiling.row_block : defaults.row_block;
+  current_tiling.col_block = tiling.col_block ? tiling.col_block : defaults.col_block;
+  current_tiling.panel = tiling.panel ? tiling.panel : defaults.panel;
+}
+
+matvec_tiling matvec_get_tiling(void)
+{
+  if (current_tiling.row_block == 0 || current_tiling.col_block == 0 || current_tiling.panel == 0)
+    current_tiling = matvec_default_tiling();
+  return current_tiling;
+}
+
+void matvec_mult_row(const matvec_matrix *matrix, const int *vector, int *result)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+
+  if (matrix->layout == MATVEC_ROW_MAJOR)
+  {
+    for (size_t i = 0; i < rows; i++)
+    {
+      const int *row = matrix->data + i * ld;
+      int sum = 0;
+      for (size_t j = 0; j < cols; j++)
+      {
+        sum += row[j] * vector[j];
+      }
+      result[i] = sum;
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < rows; i++)
+    {
+      int sum = 0;
+      for (size_t j = 0; j < cols; j++)
+      {
+        sum += matrix->data[j * ld + i] * vector[j];
+      }
+      result[i] = sum;
+    }
+  }
+}
+
+void matvec_mult_row_simd(const matvec_matrix *matrix, const int *vector, int *result)
+{
+  if (matrix->layout != MATVEC_ROW_MAJOR)
+  {
+    matvec_mult_row(matrix, vector, result);
+    return;
+  }
+  matvec_gemv_i32(matrix->data, matrix->rows, matrix->cols, matrix->ld, vector, result, NULL);
+}
+
+void matvec_mult_col(const matvec_matrix *matrix, const int *vector, int *result)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+
+  for (size_t i = 0; i < rows; i++)
+  {
+    result[i] = 0;
+  }
+
+  if (matrix->layout == MATVEC_COL_MAJOR)
+  {
+    for (size_t j = 0; j < cols; j++)
+    {
+      const int *col = matrix->data + j * ld;
+      const int x = vector[j];
+      for (size_t i = 0; i < rows; i++)
+      {
+        result[i] += col[i] * x;
+      }
+    }
+  }
+  else
+  {
+    for (size_t j = 0; j < cols; j++)
+    {
+      const int x = vector[j];
+      for (size_t i = 0; i < rows; i++)
+      {
+        result[i] += matrix->data[i * ld + j] * x;
+      }
+    }
+  }
+}
+
+void matvec_mult_row_blocked(const matvec_matrix *matrix, const int *vector, int *result)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+  const matvec_tiling tiling = matvec_get_tiling();
+
+  for (size_t i = 0; i < rows; i++)
+  {
+    result[i] = 0;
+  }
+
+  if (matrix->layout == MATVEC_ROW_MAJOR)
+  {
+    // Rows are contiguous: only split them into panels so the vector
+    // slice stays in L2 while every row streams through it.
+    for (size_t jb = 0; jb < cols; jb += tiling.panel)
+    {
+      const size_t j_end = jb + tiling.panel < cols ? jb + tiling.panel : cols;
+      for (size_t i = 0; i < rows; i++)
+      {
+        const int *row = matrix->data + i * ld;
+        int sum = 0;
+        for (size_t j = jb; j < j_end; j++)
+          sum += row[j] * vector[j];
+        result[i] += sum;
+      }
+    }
+    return;
+  }
+
+  for (size_t ib = 0; ib < rows; ib += tiling.row_block)
+  {
+    const size_t i_end = ib + tiling.row_block < rows ? ib + tiling.row_block : rows;
+    for (size_t jb = 0; jb < cols; jb += tiling.col_block)
+    {
+      const size_t j_end = jb + tiling.col_block < cols ? jb + tiling.col_block : cols;
+      for (size_t i = ib; i < i_end; i++)
+      {
+        int sum = 0;
+        for (size_t j = jb; j < j_end; j++)
+          sum += matrix->data[j * ld + i] * vector[j];
+        result[i] += sum;
+      }
+    }
+  }
+}
+
+void matvec_mult_col_blocked(const matvec_matrix *matrix, const int *vector, int *result)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+  const matvec_tiling tiling = matvec_get_tiling();
+
+  for (size_t i = 0; i < rows; i++)
+  {
+    result[i] = 0;
+  }
+
+  if (matrix->layout == MATVEC_COL_MAJOR)
+  {
+    // Columns are contiguous: only split them into panels so the result
+    // slice stays in L2 while every column is accumulated into it.
+    for (size_t ib = 0; ib < rows; ib += tiling.panel)
+    {
+      const size_t i_end = ib + tiling.panel < rows ? ib + tiling.panel : rows;
+      for (size_t j = 0; j < cols; j++)
+      {
+        const int *col = matrix->data + j * ld;
+        const int x = vector[j];
+        for (size_t i = ib; i < i_end; i++)
+          result[i] += col[i] * x;
+      }
+    }
+    return;
+  }
+
+  // Bands of rows outermost: the result slice of a band stays in cache
+  // while every column of the band is applied to it, and each L1 tile is
+  // fully consumed before moving right.
+  for (size_t ib = 0; ib < rows; ib += tiling.row_block)
+  {
+    const size_t i_end = ib + tiling.row_block < rows ? ib + tiling.row_block : rows;
+    for (size_t jb = 0; jb < cols; jb += tiling.col_block)
+    {
+      const size_t j_end = jb + tiling.col_block < cols ? jb + tiling.col_block : cols;
+      for (size_t j = jb; j < j_end; j++)
+      {
+        const int x = vector[j];
+        for (size_t i = ib; i < i_end; i++)
+          result[i] += matrix->data[i * ld + j] * x;
+      }
+    }
+  }
+}
@@ -0,0 +1,226 @@
+/**
+ * @file matvec.h
+ * @brief Contiguous, cache-blocked matrix-vector multiplication engine.
+ *
+ * The matrix is stored in a single aligned buffer (instead of one `malloc`
+ * per row) in either row-major or column-major layout. Every kernel works
+ * on both layouts, so the row-wise vs column-wise traversal comparison can
+ * be made on exactly the same storage.
+ */
+
+#ifndef MATVEC_H
+#define MATVEC_H
+
+#include <stddef.h>
+
+#define MATVEC_ALIGNMENT 64 ///< Buffer and leading-dimension alignment in bytes (one cache line).
+
+/**
+ * @enum matvec_layout
+ * @brief Storage order of the matrix elements.
+ */
+typedef enum
+{
+  MATVEC_ROW_MAJOR, ///< Element (i, j) at data[i * ld + j].
+  MATVEC_COL_MAJOR  ///< Element (i, j) at data[j * ld + i].
+} matvec_layout;
+
+/**
+ * @struct matvec_matrix
+ * @brief Dense integer matrix stored in one contiguous aligned buffer.
+ */
+typedef struct
+{
+  int *data;            ///< Aligned element buffer.
+  size_t rows;          ///< Number of rows.
+  size_t cols;          ///< Number of columns.
+  size_t ld;            ///< Leading dimension (padded row or column length, in elements).
+  matvec_layout layout; ///< Storage order.
+} matvec_matrix;
+
+/**
+ * @struct matvec_tiling
+ * @brief Tile sizes used by the blocked kernels.
+ */
+typedef struct
+{
+  size_t row_block; ///< Rows per tile.
+  size_t col_block; ///< Columns per tile.
+  size_t panel;     ///< Contiguous elements per pass when the traversal follows the storage order.
+} matvec_tiling;
+
+/**
+ * @brief Signature shared by all matrix-vector kernels.
+ */
+typedef void (*matvec_kernel)(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief Allocates a matrix in a single aligned buffer.
+ * @param matrix Matrix to initialize.
+ * @param rows Number of rows.
+ * @param cols Number of columns.
+ * @param layout Storage order.
+ * @return 0 on success, -1 if the allocation failed.
+ */
+int matvec_alloc(matvec_matrix *matrix, size_t rows, size_t cols, matvec_layout layout);
+
+/**
+ * @brief Releases the buffer of a matrix.
+ * @param matrix Matrix to release.
+ */
+void matvec_free(matvec_matrix *matrix);
+
+/**
+ * @brief Returns a pointer to element (i, j), independent of the layout.
+ */
+static inline int *matvec_at(const matvec_matrix *matrix, size_t i, size_t j)
+{
+  return matrix->layout == MATVEC_ROW_MAJOR ? &matrix->data[i * matrix->ld + j]
+                                            : &matrix->data[j * matrix->ld + i];
+}
+
+/**
+ * @brief Computes the contiguous band [begin, end) of n items owned by a thread.
+ *
+ * Every parallel loop over the outer storage dimension uses this split, so
+ * first-touch initialization and the kernels agree on page ownership.
+ */
+static inline void matvec_thread_band(size_t n, int tid, int threads, size_t *begin, size_t *end)
+{
+  *begin = n * tid / threads;
+  *end = n * (tid + 1) / threads;
+}
+
+/**
+ * @brief Fills the matrix with `rand() % 10`, in logical row order.
+ *
+ * Elements are generated in the same order as the original `int **`
+ * version, so a given seed produces the same matrix for both layouts.
+ *
+ * @param matrix Matrix to fill.
+ * @param vector Vector of length `matrix->cols` filled in the same pass.
+ */
+void matvec_fill_random(matvec_matrix *matrix, int *vector);
+
+/**
+ * @brief Fills the matrix and vector in parallel, by first touch (see matvec_parallel.c).
+ *
+ * Uses the same per-thread bands of the outer storage dimension as the
+ * parallel kernels, so pages land on the NUMA node of the thread that will
+ * read them. Values are a hash of (seed, index) modulo 10, independent of
+ * the number of threads.
+ *
+ * The matrix buffer must not have been written before this call.
+ *
+ * @param matrix Freshly allocated matrix to fill.
+ * @param vector Freshly allocated vector of length `matrix->cols`.
+ * @param seed Generator seed.
+ */
+void matvec_fill_random_parallel(matvec_matrix *matrix, int *vector, unsigned int seed);
+
+/**
+ * @brief Parses "row" or "col" into a layout.
+ * @param name Layout name.
+ * @param layout Parsed layout.
+ * @return 0 on success, -1 if the name is unknown.
+ */
+int matvec_parse_layout(const char *name, matvec_layout *layout);
+
+/**
+ * @brief Returns the printable name of a layout.
+ */
+const char *matvec_layout_name(matvec_layout layout);
+
+/**
+ * @brief Chooses tile sizes from the L1/L2 data cache sizes of the host.
+ *
+ * When a kernel walks against the storage order, it works on tiles of
+ * row_block x col_block ints that fit in half of L1, so the cache lines of
+ * a tile are reused by the following rows/columns. When it walks along
+ * the storage order, it only splits the contiguous dimension into panels
+ * whose vector or result slice fits in half of L2.
+ *
+ * @return Tile sizes for the current machine.
+ */
+matvec_tiling matvec_default_tiling(void);
+
+/**
+ * @brief Overrides the tiling used by the blocked kernels.
+ * @param tiling New tile sizes (zero fields keep the current value).
+ */
+void matvec_set_tiling(matvec_tiling tiling);
+
+/**
+ * @brief Returns the tiling currently used by the blocked kernels.
+ */
+matvec_tiling matvec_get_tiling(void);
+
+/**
+ * @brief Row-wise traversal: for each row i, dot product with the vector.
+ */
+void matvec_mult_row(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief Row-wise traversal using the dispatched SIMD dot product (see matvec_simd.h).
+ *
+ * On column-major storage the rows are not contiguous, so this falls back
+ * to matvec_mult_row().
+ */
+void matvec_mult_row_simd(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief Column-wise traversal: for each column j, axpy into the result.
+ */
+void matvec_mult_col(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief Row-wise traversal tiled so the vector slice stays in cache.
+ */
+void matvec_mult_row_blocked(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief Column-wise traversal tiled so each tile stays in L1.
+ */
+void matvec_mult_col_blocked(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief OpenMP row-partitioned product: each thread computes a band of result rows.
+ *
+ * Rows are split into one contiguous band per thread; on row-major storage
+ * each row uses the dispatched SIMD dot product.
+ */
+void matvec_mult_row_parallel(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief OpenMP column-partitioned product with private result vectors.
+ *
+ * Each thread accumulates its band of columns into a private, cache-line
+ * aligned result vector; the vectors are then combined by a tree reduction
+ * in log2(threads) rounds.
+ */
+void matvec_mult_col_parallel(const matvec_matrix *matrix, const int *vector, int *result);
+
+/**
+ * @brief Batched product Y = A X for k right-hand sides (see matvec_batch.c).
+ *
+ * The k vectors are interleaved: element j of vector v is
+ * `vectors[j * k + v]`, and element i of result v is `results[i * k + v]`.
+ * Each matrix element is read once for all k vectors. Rows are split
+ * across OpenMP threads with matvec_thread_band().
+ *
+ * @param matrix Input matrix (either layout).
+ * @param vectors Interleaved input vectors, `matrix->cols * k` ints.
+ * @param results Interleaved output vectors, `matrix->rows * k` ints.
+ * @param k Number of right-hand sides.
+ */
+void matvec_mult_batch(const matvec_matrix *matrix, const int *vectors, int *results, size_t k);
+
+/**
+ * @brief Number of columns processed per pass by matvec_mult_batch() for k vectors.
+ *
+ * Chosen so the slice of the interleaved vectors read by one pass fits in
+ * half of L2.
+ */
+size_t matvec_batch_panel(size_t k);
+
+#endif
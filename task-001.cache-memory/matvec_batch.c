@@ -0,0 +1,211 @@
+/**
+ * @file matvec_batch.c
+ * @brief Batched matrix-multi-vector product (Y = A X for K right-hand sides).
+ *
+ * Multiplying the same matrix by K vectors one at a time streams the whole
+ * matrix from DRAM K times. Here each matrix element is loaded once and
+ * applied to all K vectors: the vectors are stored interleaved
+ * (X[j * K + k] is element j of vector k), so the K values that multiply
+ * A(i, j) are contiguous and map onto SIMD lanes.
+ *
+ * The micro-kernels keep a BATCH_MR x KR tile of results in registers
+ * (KR = 16, 8, 4, 2 or 1) while they walk a panel of columns, so every
+ * A(i, j) load feeds KR multiply-adds and every X load feeds BATCH_MR of
+ * them. Arithmetic intensity therefore grows with K up to BATCH_KR, and
+ * beyond that the matrix is still read only once.
+ */
+
+#include "matvec.h"
+#include "matvec_simd.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+
+#define BATCH_MR 4  ///< Matrix rows per register tile (one accumulator array each in the micro-kernels).
+#define BATCH_KR 16 ///< Widest right-hand-side tile (one AVX-512 or two AVX2 registers of int).
+#define BATCH_SMALL_K 8 ///< Below this many right-hand sides, row-major storage uses repeated dot products.
+
+/**
+ * @brief Defines a register-tiled update of a full BATCH_MR x KR result tile.
+ *
+ * Generated kernel parameters:
+ * - a: pointer to A(i, j_begin).
+ * - row_stride / col_stride: distance to A(i + 1, j) / A(i, j + 1).
+ * - n: number of columns in the panel.
+ * - x: pointer to X[j_begin * k + kb].
+ * - k: number of right-hand sides (distance between consecutive x rows).
+ * - y: pointer to Y[i * k + kb].
+ * - first: non-zero on the first panel (the tile starts at zero).
+ */
+#define BATCH_MICRO_KERNEL(KR)                                                                \
+  MATVEC_TARGET_CLONES static void batch_micro_kernel_##KR(                                   \
+      const int *a, size_t row_stride, size_t col_stride, size_t n,                           \
+      const int *x, size_t k, int *y, int first)                                              \
+  {                                                                                           \
+    int acc0[KR], acc1[KR], acc2[KR], acc3[KR];                                               \
+    _Pragma("omp simd") for (int c = 0; c < KR; c++)                                          \
+    {                                                                                         \
+      acc0[c] = first ? 0 : y[c];                                                             \
+      acc1[c] = first ? 0 : y[k + c];                                                         \
+      acc2[c] = first ? 0 : y[2 * k + c];                                                     \
+      acc3[c] = first ? 0 : y[3 * k + c];                                                     \
+    }                                                                                         \
+    for (size_t j = 0; j < n; j++)                                                            \
+    {                                                                                         \
+      const int *xj = x + j * k;                                                              \
+      const int *aj = a + j * col_stride;                                                     \
+      const int a0 = aj[0], a1 = aj[row_stride], a2 = aj[2 * row_stride], a3 = aj[3 * row_stride]; \
+      _Pragma("omp simd") for (int c = 0; c < KR; c++)                                        \
+      {                                                                                       \
+        acc0[c] += a0 * xj[c];                                                                \
+        acc1[c] += a1 * xj[c];                                                                \
+        acc2[c] += a2 * xj[c];                                                                \
+        acc3[c] += a3 * xj[c];                                                                \
+      }                                                                                       \
+    }                                                                                         \
+    _Pragma("omp simd") for (int c = 0; c < KR; c++)                                          \
+    {                                                                                         \
+      y[c] = acc0[c];                                                                         \
+      y[k + c] = acc1[c];                                                                     \
+      y[2 * k + c] = acc2[c];                                                                 \
+      y[3 * k + c] = acc3[c];                                                                 \
+    }                                                                                         \
+  }
+
+BATCH_MICRO_KERNEL(16)
+BATCH_MICRO_KERNEL(8)
+BATCH_MICRO_KERNEL(4)
+BATCH_MICRO_KERNEL(2)
+BATCH_MICRO_KERNEL(1)
+
+typedef void (*batch_kernel)(const int *, size_t, size_t, size_t, const int *, size_t, int *, int);
+
+/// Micro-kernels indexed by their tile width.
+static const batch_kernel batch_kernels[BATCH_KR + 1] = {
+    [1] = batch_micro_kernel_1, [2] = batch_micro_kernel_2, [4] = batch_micro_kernel_4,
+    [8] = batch_micro_kernel_8, [16] = batch_micro_kernel_16};
+
+/**
+ * @brief Generic update of a partial (edge) result tile of mr x kr.
+ * @see BATCH_MICRO_KERNEL
+ */
+static void batch_edge_kernel(const int *a, size_t row_stride, size_t col_stride, size_t n,
+                              const int *x, size_t k, int *y, int first, size_t mr, size_t kr)
+{
+  for (size_t r = 0; r < mr; r++)
+  {
+    for (size_t c = 0; c < kr; c++)
+    {
+      int sum = first ? 0 : y[r * k + c];
+      for (size_t j = 0; j < n; j++)
+        sum += a[r * row_stride + j * col_stride] * x[j * k + c];
+      y[r * k + c] = sum;
+    }
+  }
+}
+
+size_t matvec_batch_panel(size_t k)
+{
+  long l2 = -1;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+  if (l2 <= 0)
+    l2 = 256 * 1024;
+
+  // The X panel (panel x k ints) is re-read for every tile of rows, so it
+  // must stay in half of L2.
+  size_t panel = (size_t)l2 / 2 / (k * sizeof(int));
+  return panel < 16 ? 16 : panel;
+}
+
+/**
+ * @brief Batched product for fewer than BATCH_SMALL_K right-hand sides on row-major storage.
+ *
+ * Tiles narrower than eight lanes leave most of each SIMD register idle
+ * and spend more instructions broadcasting A than multiplying.
+ * Instead, the vectors are de-interleaved once and each row is multiplied
+ * by all of them with the dispatched dot product: the row is streamed from
+ * memory by the first dot product and re-read from cache by the others.
+ *
+ * @return 0 on success, -1 if the de-interleaved copy could not be allocated.
+ */
+static int batch_small_k_row_major(const matvec_matrix *matrix, const int *vectors, int *results, size_t k)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+  int *split = malloc(cols * k * sizeof(int));
+  if (!split)
+    return -1;
+
+  for (size_t j = 0; j < cols; j++)
+    for (size_t v = 0; v < k; v++)
+      split[v * cols + j] = vectors[j * k + v];
+
+#pragma omp parallel
+  {
+    size_t begin, end;
+    matvec_thread_band(rows, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+    for (size_t i = begin; i < end; i++)
+    {
+      const int *row = matrix->data + i * ld;
+      for (size_t v = 0; v < k; v++)
+        results[i * k + v] = matvec_dot_i32(row, split + v * cols, cols);
+    }
+  }
+
+  free(split);
+  return 0;
+}
+
+void matvec_mult_batch(const matvec_matrix *matrix, const int *vectors, int *results, size_t k)
+{
+  if (k < BATCH_SMALL_K && matrix->layout == MATVEC_ROW_MAJOR && batch_small_k_row_major(matrix, vectors, results, k) == 0)
+    return;
+
+  const size_t rows = matrix->rows, cols = matrix->cols;
+  const size_t row_stride = matrix->layout == MATVEC_ROW_MAJOR ? matrix->ld : 1;
+  const size_t col_stride = matrix->layout == MATVEC_ROW_MAJOR ? 1 : matrix->ld;
+  const size_t panel = matvec_batch_panel(k);
+
+#pragma omp parallel
+  {
+    // Rows are split in the same bands as matvec_fill_random_parallel(),
+    // so on row-major storage each thread streams its local pages.
+    size_t begin, end;
+    matvec_thread_band(rows, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+
+    for (size_t jb = 0; jb < cols; jb += panel)
+    {
+      const size_t n = jb + panel < cols ? panel : cols - jb;
+      const int first = jb == 0;
+
+      for (size_t i = begin; i < end; i += BATCH_MR)
+      {
+        const size_t mr = i + BATCH_MR <= end ? BATCH_MR : end - i;
+        const int *a = matrix->data + i * row_stride + jb * col_stride;
+
+        size_t kb = 0;
+        while (kb < k)
+        {
+          const size_t remaining = k - kb;
+          const int *x = vectors + jb * k + kb;
+          int *y = results + i * k + kb;
+
+          if (mr < BATCH_MR)
+          {
+            batch_edge_kernel(a, row_stride, col_stride, n, x, k, y, first, mr, remaining);
+            break;
+          }
+
+          // Widest register tile that fits in the remaining right-hand sides.
+          size_t kr = BATCH_KR;
+          while (kr > remaining)
+            kr /= 2;
+          batch_kernels[kr](a, row_stride, col_stride, n, x, k, y, first);
+          kb += kr;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,205 @@
+/**
+ * @file matvec_parallel.c
+ * @brief OpenMP matrix-vector kernels and NUMA-aware first-touch initialization.
+ *
+ * Linux places a page on the NUMA node of the thread that first writes it.
+ * All loops here split the outer storage dimension into the same
+ * contiguous per-thread bands (see matvec_thread_band()), so the thread that
+ * initializes a band of rows (or columns) is the same thread that later
+ * reads it in the matching kernel, and its pages are local to that
+ * thread's socket.
+ */
+
+#include "matvec.h"
+#include "matvec_simd.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <omp.h>
+
+/**
+ * @brief Stateless hash used as a per-element random generator.
+ *
+ * Unlike `rand()`, the value of an element depends only on the seed and
+ * its index, so the matrix is the same whatever thread fills it.
+ */
+static inline uint32_t element_hash(uint64_t seed, uint64_t index)
+{
+  uint64_t z = seed + index * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+void matvec_fill_random_parallel(matvec_matrix *matrix, int *vector, unsigned int seed)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+  const size_t outer = matrix->layout == MATVEC_ROW_MAJOR ? rows : cols;
+  const size_t inner = matrix->layout == MATVEC_ROW_MAJOR ? cols : rows;
+
+#pragma omp parallel
+  {
+    size_t begin, end;
+    matvec_thread_band(outer, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+    for (size_t o = begin; o < end; o++)
+    {
+      int *line = matrix->data + o * ld;
+      for (size_t k = 0; k < inner; k++)
+      {
+        size_t i = matrix->layout == MATVEC_ROW_MAJOR ? o : k;
+        size_t j = matrix->layout == MATVEC_ROW_MAJOR ? k : o;
+        line[k] = element_hash(seed, i * cols + j) % 10;
+      }
+      // Touch the padding too, so it is not faulted in later by another thread.
+      for (size_t k = inner; k < ld; k++)
+        line[k] = 0;
+    }
+
+#pragma omp for schedule(static)
+    for (size_t j = 0; j < cols; j++)
+    {
+      vector[j] = element_hash(~(uint64_t)seed, j) % 10;
+    }
+  }
+}
+
+void matvec_mult_row_parallel(const matvec_matrix *matrix, const int *vector, int *result)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+
+#pragma omp parallel
+  {
+    size_t begin, end;
+    matvec_thread_band(rows, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+
+    if (matrix->layout == MATVEC_ROW_MAJOR)
+    {
+      for (size_t i = begin; i < end; i++)
+      {
+        result[i] = matvec_dot_i32(matrix->data + i * ld, vector, cols);
+      }
+    }
+    else
+    {
+      for (size_t i = begin; i < end; i++)
+      {
+        int sum = 0;
+        for (size_t j = 0; j < cols; j++)
+        {
+          sum += matrix->data[j * ld + i] * vector[j];
+        }
+        result[i] = sum;
+      }
+    }
+  }
+}
+
+void matvec_mult_col_parallel(const matvec_matrix *matrix, const int *vector, int *result)
+{
+  const size_t rows = matrix->rows, cols = matrix->cols, ld = matrix->ld;
+  const size_t partial_ld = (rows + MATVEC_ALIGNMENT / sizeof(int) - 1) / (MATVEC_ALIGNMENT / sizeof(int)) * (MATVEC_ALIGNMENT / sizeof(int));
+  const matvec_tiling tiling = matvec_get_tiling();
+  int **partials = NULL;
+  int failed = 0;
+
+#pragma omp parallel
+  {
+    const int tid = omp_get_thread_num();
+    const int threads = omp_get_num_threads();
+
+#pragma omp single
+    {
+      partials = calloc(threads, sizeof(int *));
+      failed = partials == NULL;
+    }
+
+    // Other threads may be setting `failed` meanwhile, so every read is atomic.
+    int any_failed;
+#pragma omp atomic read
+    any_failed = failed;
+
+    // Each thread allocates and zeroes its own private result vector, so
+    // it lives on the thread's node and never shares a line with another.
+    int *partial = any_failed ? NULL : aligned_alloc(MATVEC_ALIGNMENT, partial_ld * sizeof(int));
+    if (partial)
+    {
+      for (size_t i = 0; i < rows; i++)
+        partial[i] = 0;
+    }
+    else
+    {
+#pragma omp atomic write
+      failed = 1;
+    }
+    if (partials)
+      partials[tid] = partial;
+#pragma omp barrier
+
+    // Every write happened before the barrier, so all threads take the same branch.
+#pragma omp atomic read
+    any_failed = failed;
+    if (!any_failed)
+    {
+      size_t j_begin, j_end;
+      matvec_thread_band(cols, tid, threads, &j_begin, &j_end);
+
+      if (matrix->layout == MATVEC_COL_MAJOR)
+      {
+        for (size_t j = j_begin; j < j_end; j++)
+        {
+          const int *col = matrix->data + j * ld;
+          const int x = vector[j];
+          for (size_t i = 0; i < rows; i++)
+            partial[i] += col[i] * x;
+        }
+      }
+      else
+      {
+        // Rows are the contiguous dimension: walk the band in L1 tiles as
+        // matvec_mult_col_blocked() does.
+        for (size_t ib = 0; ib < rows; ib += tiling.row_block)
+        {
+          const size_t i_end = ib + tiling.row_block < rows ? ib + tiling.row_block : rows;
+          for (size_t jb = j_begin; jb < j_end; jb += tiling.col_block)
+          {
+            const size_t jb_end = jb + tiling.col_block < j_end ? jb + tiling.col_block : j_end;
+            for (size_t j = jb; j < jb_end; j++)
+            {
+              const int x = vector[j];
+              for (size_t i = ib; i < i_end; i++)
+                partial[i] += matrix->data[i * ld + j] * x;
+            }
+          }
+        }
+      }
+#pragma omp barrier
+
+      // Tree reduction: in round s, thread t (a multiple of 2s) adds the
+      // vector of thread t + s into its own, so log2(threads) rounds leave
+      // the total in thread 0's vector.
+      for (int stride = 1; stride < threads; stride *= 2)
+      {
+        if (tid % (2 * stride) == 0 && tid + stride < threads)
+        {
+          const int *other = partials[tid + stride];
+          for (size_t i = 0; i < rows; i++)
+            partial[i] += other[i];
+        }
+#pragma omp barrier
+      }
+
+#pragma omp for schedule(static)
+      for (size_t i = 0; i < rows; i++)
+        result[i] = partials[0][i];
+    }
+
+#pragma omp barrier
+    free(partial);
+  }
+
+  free(partials);
+
+  // Out of memory for the private vectors: fall back to the serial kernel.
+  if (failed)
+    matvec_mult_col(matrix, vector, result);
+}
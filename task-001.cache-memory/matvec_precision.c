@@ -0,0 +1,174 @@
+/**
+ * @file matvec_precision.c
+ * @brief Reduced-precision copies of a matrix for the bandwidth-bound row-wise product.
+ */
+
+#include "matvec_precision.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+size_t matvec_type_size(matvec_type type)
+{
+  static const size_t sizes[MATVEC_TYPE_COUNT] = {sizeof(int8_t), sizeof(int16_t), sizeof(int), sizeof(matvec_half), sizeof(float)};
+  return type < MATVEC_TYPE_COUNT ? sizes[type] : 0;
+}
+
+/**
+ * @brief Bytes per vector element of a type (half matrices use a float vector).
+ */
+static size_t vector_type_size(matvec_type type)
+{
+  return type == MATVEC_TYPE_HALF ? sizeof(float) : matvec_type_size(type);
+}
+
+const char *matvec_type_name(matvec_type type)
+{
+  static const char *names[MATVEC_TYPE_COUNT] = {"int8", "int16", "int32", "half", "float"};
+  return type < MATVEC_TYPE_COUNT ? names[type] : "unknown";
+}
+
+int matvec_parse_type(const char *name, matvec_type *type)
+{
+  for (int t = 0; t < MATVEC_TYPE_COUNT; t++)
+  {
+    if (strcmp(name, matvec_type_name((matvec_type)t)) == 0)
+    {
+      *type = (matvec_type)t;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Stores an int value as element `index` of a buffer of the given type.
+ */
+static void store_as(void *buffer, size_t index, matvec_type type, int value)
+{
+  switch (type)
+  {
+  case MATVEC_TYPE_INT8:
+    ((int8_t *)buffer)[index] = (int8_t)value;
+    break;
+  case MATVEC_TYPE_INT16:
+    ((int16_t *)buffer)[index] = (int16_t)value;
+    break;
+  case MATVEC_TYPE_INT32:
+    ((int *)buffer)[index] = value;
+    break;
+  case MATVEC_TYPE_HALF:
+    ((matvec_half *)buffer)[index] = matvec_half_from_float((float)value);
+    break;
+  default:
+    ((float *)buffer)[index] = (float)value;
+    break;
+  }
+}
+
+int matvec_typed_from(const matvec_matrix *matrix, const int *vector, matvec_type type, matvec_typed_matrix *typed)
+{
+  if (matrix->layout != MATVEC_ROW_MAJOR || type >= MATVEC_TYPE_COUNT)
+    return -1;
+
+  const size_t size = matvec_type_size(type);
+  const size_t line = MATVEC_ALIGNMENT / size;
+  const matvec_type vector_type = type == MATVEC_TYPE_HALF ? MATVEC_TYPE_FLOAT : type;
+
+  memset(typed, 0, sizeof(*typed));
+  typed->rows = matrix->rows;
+  typed->cols = matrix->cols;
+  typed->type = type;
+  typed->vector = malloc((matrix->cols ? matrix->cols : 1) * vector_type_size(type));
+  if (!typed->vector)
+    return -1;
+  for (size_t j = 0; j < matrix->cols; j++)
+    store_as(typed->vector, j, vector_type, vector[j]);
+
+  if (type == MATVEC_TYPE_INT32)
+  {
+    typed->data = matrix->data;
+    typed->ld = matrix->ld;
+    return 0;
+  }
+
+  // Same padding rule as matvec_alloc(): whole cache lines, never a 4 KB multiple.
+  typed->ld = (matrix->cols + line - 1) / line * line;
+  if ((typed->ld * size) % 4096 == 0)
+    typed->ld += line;
+  typed->data = aligned_alloc(MATVEC_ALIGNMENT, (typed->rows ? typed->rows : 1) * typed->ld * size);
+  typed->owns_data = 1;
+  if (!typed->data)
+  {
+    matvec_typed_free(typed);
+    return -1;
+  }
+
+  for (size_t i = 0; i < matrix->rows; i++)
+  {
+    for (size_t j = 0; j < typed->ld; j++)
+      store_as(typed->data, i * typed->ld + j, type, j < matrix->cols ? matrix->data[i * matrix->ld + j] : 0);
+  }
+  return 0;
+}
+
+void matvec_typed_free(matvec_typed_matrix *typed)
+{
+  if (typed->owns_data)
+    free(typed->data);
+  free(typed->vector);
+  typed->data = NULL;
+  typed->vector = NULL;
+  typed->owns_data = 0;
+}
+
+size_t matvec_typed_bytes(const matvec_typed_matrix *typed)
+{
+  return typed->rows * typed->cols * matvec_type_size(typed->type) + typed->cols * vector_type_size(typed->type) +
+         typed->rows * sizeof(int);
+}
+
+void matvec_typed_mult(const matvec_typed_matrix *typed, matvec_isa isa, int *result)
+{
+  const size_t rows = typed->rows, cols = typed->cols, ld = typed->ld;
+
+  switch (typed->type)
+  {
+  case MATVEC_TYPE_INT8:
+  {
+    const matvec_dot_i8_fn dot = matvec_dot_i8_for(isa);
+    const int8_t *data = typed->data;
+    for (size_t i = 0; i < rows; i++)
+      result[i] = dot(data + i * ld, typed->vector, cols);
+    break;
+  }
+  case MATVEC_TYPE_INT16:
+  {
+    const matvec_dot_i16_fn dot = matvec_dot_i16_for(isa);
+    const int16_t *data = typed->data;
+    for (size_t i = 0; i < rows; i++)
+      result[i] = dot(data + i * ld, typed->vector, cols);
+    break;
+  }
+  case MATVEC_TYPE_INT32:
+    matvec_gemv_i32(typed->data, rows, cols, ld, typed->vector, result, matvec_dot_i32_for(isa));
+    break;
+  case MATVEC_TYPE_HALF:
+  {
+    const matvec_dot_f16_fn dot = matvec_dot_f16_for(isa);
+    const matvec_half *data = typed->data;
+    for (size_t i = 0; i < rows; i++)
+      result[i] = (int)dot(data + i * ld, typed->vector, cols);
+    break;
+  }
+  default:
+  {
+    const matvec_dot_f32_fn dot = matvec_dot_f32_for(isa);
+    const float *data = typed->data;
+    for (size_t i = 0; i < rows; i++)
+      result[i] = (int)dot(data + i * ld, typed->vector, cols);
+    break;
+  }
+  }
+}
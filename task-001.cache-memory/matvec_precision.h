@@ -0,0 +1,103 @@
+/**
+ * @file matvec_precision.h
+ * @brief Reduced-precision copies of a matrix for the bandwidth-bound row-wise product.
+ *
+ * The benchmark matrices only hold values 0-9, yet a 32-bit `int` spends
+ * four bytes on each. Since the row-wise product streams the whole matrix
+ * once per call, its time is set by the bytes moved: storing the same
+ * values as int8 or int16 (or half instead of float) divides the traffic
+ * by four or two. The products use the widening kernels of matvec_simd.h,
+ * which accumulate in int32 or float, so results stay exact.
+ */
+
+#ifndef MATVEC_PRECISION_H
+#define MATVEC_PRECISION_H
+
+#include <stddef.h>
+
+#include "matvec.h"
+#include "matvec_simd.h"
+
+/**
+ * @enum matvec_type
+ * @brief Element type of a typed matrix copy.
+ */
+typedef enum
+{
+  MATVEC_TYPE_INT8,  ///< int8 matrix and vector, int32 accumulation.
+  MATVEC_TYPE_INT16, ///< int16 matrix and vector, int32 accumulation.
+  MATVEC_TYPE_INT32, ///< int32 matrix and vector (the original storage).
+  MATVEC_TYPE_HALF,  ///< half matrix, float vector, float accumulation.
+  MATVEC_TYPE_FLOAT, ///< float matrix and vector.
+  MATVEC_TYPE_COUNT
+} matvec_type;
+
+/**
+ * @struct matvec_typed_matrix
+ * @brief Row-major matrix and vector converted to one element type.
+ */
+typedef struct
+{
+  void *data;       ///< Matrix elements (row-major, aligned rows).
+  void *vector;     ///< Input vector in the matching type.
+  size_t rows;      ///< Number of rows.
+  size_t cols;      ///< Number of columns.
+  size_t ld;        ///< Row length in elements, padded to a cache line.
+  matvec_type type; ///< Element type.
+  int owns_data;    ///< Zero when data aliases the int32 source matrix.
+} matvec_typed_matrix;
+
+/**
+ * @brief Bytes per matrix element of a type.
+ */
+size_t matvec_type_size(matvec_type type);
+
+/**
+ * @brief Returns the printable name of a type ("int8", "int16", "int32", "half", "float").
+ */
+const char *matvec_type_name(matvec_type type);
+
+/**
+ * @brief Parses a type name.
+ * @return 0 on success, -1 if the name is unknown.
+ */
+int matvec_parse_type(const char *name, matvec_type *type);
+
+/**
+ * @brief Converts a row-major int32 matrix and its vector to another element type.
+ *
+ * Values must be representable in the target type (0-9 always are). The
+ * int32 copy shares the source buffer instead of duplicating it.
+ *
+ * @param matrix Source matrix (row-major).
+ * @param vector Source vector of length `matrix->cols`.
+ * @param type Target element type.
+ * @param typed Copy to initialize.
+ * @return 0 on success, -1 for a column-major source or a failed allocation.
+ */
+int matvec_typed_from(const matvec_matrix *matrix, const int *vector, matvec_type type, matvec_typed_matrix *typed);
+
+/**
+ * @brief Releases a typed copy.
+ */
+void matvec_typed_free(matvec_typed_matrix *typed);
+
+/**
+ * @brief Bytes one product moves: the matrix and the vector read once, the int32/float result written once.
+ */
+size_t matvec_typed_bytes(const matvec_typed_matrix *typed);
+
+/**
+ * @brief Row-wise product with the dot-product kernel of the given ISA.
+ *
+ * Float results are converted back to int: products of values in 0..9
+ * summed over up to 2^24 / 81 columns are exact in float, so they match
+ * the int32 results bit for bit.
+ *
+ * @param typed Typed matrix and vector.
+ * @param isa Instruction set of the kernel (must be supported).
+ * @param result Output vector of length `typed->rows`.
+ */
+void matvec_typed_mult(const matvec_typed_matrix *typed, matvec_isa isa, int *result);
+
+#endif
@@ -0,0 +1,756 @@
+/**
+ * @file matvec_simd.c
+ * @brief Explicitly vectorized dot-product kernels with runtime ISA dispatch.
+ *
+ * The x86 kernels are compiled with per-function `target` attributes, so
+ * this file builds without any `-m` flag and only the selected kernel ever
+ * executes wider instructions. On other architectures only the scalar
+ * kernels are built.
+ */
+
+#include "matvec_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATVEC_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Scalar int32 dot product with four independent accumulators.
+ */
+static int dot_i32_scalar(const int *a, const int *b, size_t n)
+{
+  int sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; i++)
+    sum0 += a[i] * b[i];
+  return sum0 + sum1 + sum2 + sum3;
+}
+
+/**
+ * @brief Scalar float dot product with four independent accumulators.
+ */
+static float dot_f32_scalar(const float *a, const float *b, size_t n)
+{
+  float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; i++)
+    sum0 += a[i] * b[i];
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/**
+ * @brief Scalar int8 dot product with four independent int32 accumulators.
+ */
+static int dot_i8_scalar(const int8_t *a, const int8_t *b, size_t n)
+{
+  int sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; i++)
+    sum0 += a[i] * b[i];
+  return sum0 + sum1 + sum2 + sum3;
+}
+
+/**
+ * @brief Scalar int16 dot product with four independent int32 accumulators.
+ */
+static int dot_i16_scalar(const int16_t *a, const int16_t *b, size_t n)
+{
+  int sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; i++)
+    sum0 += a[i] * b[i];
+  return sum0 + sum1 + sum2 + sum3;
+}
+
+/**
+ * @brief Scalar half x float dot product, converting each half in software.
+ */
+static float dot_f16_scalar(const matvec_half *a, const float *b, size_t n)
+{
+  float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    sum0 += matvec_half_to_float(a[i]) * b[i];
+    sum1 += matvec_half_to_float(a[i + 1]) * b[i + 1];
+    sum2 += matvec_half_to_float(a[i + 2]) * b[i + 2];
+    sum3 += matvec_half_to_float(a[i + 3]) * b[i + 3];
+  }
+  for (; i < n; i++)
+    sum0 += matvec_half_to_float(a[i]) * b[i];
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+#ifdef MATVEC_X86
+
+__attribute__((target("sse4.1"))) static int dot_i32_sse41(const int *a, const int *b, size_t n)
+{
+  __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+  __m128i acc2 = _mm_setzero_si128(), acc3 = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    acc0 = _mm_add_epi32(acc0, _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+    acc1 = _mm_add_epi32(acc1, _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)(a + i + 4)), _mm_loadu_si128((const __m128i *)(b + i + 4))));
+    acc2 = _mm_add_epi32(acc2, _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)(a + i + 8)), _mm_loadu_si128((const __m128i *)(b + i + 8))));
+    acc3 = _mm_add_epi32(acc3, _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)(a + i + 12)), _mm_loadu_si128((const __m128i *)(b + i + 12))));
+  }
+  for (; i + 4 <= n; i += 4)
+    acc0 = _mm_add_epi32(acc0, _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+
+  __m128i acc = _mm_add_epi32(_mm_add_epi32(acc0, acc1), _mm_add_epi32(acc2, acc3));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  int sum = _mm_cvtsi128_si32(acc);
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("sse4.1"))) static float dot_f32_sse41(const float *a, const float *b, size_t n)
+{
+  __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+  __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+    acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+  }
+  for (; i + 4 <= n; i += 4)
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+  __m128 acc = _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3));
+  acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+  acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+  float sum = _mm_cvtss_f32(acc);
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("avx2"))) static int dot_i32_avx2(const int *a, const int *b, size_t n)
+{
+  __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+  __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    acc0 = _mm256_add_epi32(acc0, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+    acc1 = _mm256_add_epi32(acc1, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a + i + 8)), _mm256_loadu_si256((const __m256i *)(b + i + 8))));
+    acc2 = _mm256_add_epi32(acc2, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a + i + 16)), _mm256_loadu_si256((const __m256i *)(b + i + 16))));
+    acc3 = _mm256_add_epi32(acc3, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a + i + 24)), _mm256_loadu_si256((const __m256i *)(b + i + 24))));
+  }
+  for (; i + 8 <= n; i += 8)
+    acc0 = _mm256_add_epi32(acc0, _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+
+  __m256i acc = _mm256_add_epi32(_mm256_add_epi32(acc0, acc1), _mm256_add_epi32(acc2, acc3));
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+  int sum = _mm_cvtsi128_si32(half);
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("avx2,fma"))) static float dot_f32_avx2(const float *a, const float *b, size_t n)
+{
+  __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+  __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+    acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+  }
+  for (; i + 8 <= n; i += 8)
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+
+  __m256 acc = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  float sum = _mm_cvtss_f32(half);
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("avx512f"))) static int dot_i32_avx512(const int *a, const int *b, size_t n)
+{
+  __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+  __m512i acc2 = _mm512_setzero_si512(), acc3 = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    acc0 = _mm512_add_epi32(acc0, _mm512_mullo_epi32(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+    acc1 = _mm512_add_epi32(acc1, _mm512_mullo_epi32(_mm512_loadu_si512(a + i + 16), _mm512_loadu_si512(b + i + 16)));
+    acc2 = _mm512_add_epi32(acc2, _mm512_mullo_epi32(_mm512_loadu_si512(a + i + 32), _mm512_loadu_si512(b + i + 32)));
+    acc3 = _mm512_add_epi32(acc3, _mm512_mullo_epi32(_mm512_loadu_si512(a + i + 48), _mm512_loadu_si512(b + i + 48)));
+  }
+  for (; i + 16 <= n; i += 16)
+    acc0 = _mm512_add_epi32(acc0, _mm512_mullo_epi32(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+  if (i < n)
+  {
+    // Masked loads read only the remaining elements.
+    __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+    acc1 = _mm512_add_epi32(acc1, _mm512_mullo_epi32(_mm512_maskz_loadu_epi32(mask, a + i), _mm512_maskz_loadu_epi32(mask, b + i)));
+  }
+
+  __m512i acc = _mm512_add_epi32(_mm512_add_epi32(acc0, acc1), _mm512_add_epi32(acc2, acc3));
+  return _mm512_reduce_add_epi32(acc);
+}
+
+__attribute__((target("avx512f"))) static float dot_f32_avx512(const float *a, const float *b, size_t n)
+{
+  __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+  __m512 acc2 = _mm512_setzero_ps(), acc3 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32), acc2);
+    acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48), acc3);
+  }
+  for (; i + 16 <= n; i += 16)
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+  if (i < n)
+  {
+    __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+    acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc1);
+  }
+
+  __m512 acc = _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3));
+  return _mm512_reduce_add_ps(acc);
+}
+
+/**
+ * @brief Horizontal sum of the four int32 lanes of an SSE register.
+ */
+__attribute__((target("sse4.1"))) static inline int hsum_epi32_sse41(__m128i acc)
+{
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(acc);
+}
+
+/**
+ * @brief Horizontal sum of the eight int32 lanes of an AVX2 register.
+ */
+__attribute__((target("avx2"))) static inline int hsum_epi32_avx2(__m256i acc)
+{
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(half);
+}
+
+/**
+ * @brief Sign-extends 8 int8 pairs to int16 and multiply-adds them into 4 int32 lanes.
+ */
+__attribute__((target("sse4.1"))) static inline __m128i madd_i8x8_sse41(const int8_t *a, const int8_t *b)
+{
+  return _mm_madd_epi16(_mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)a)),
+                        _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)b)));
+}
+
+__attribute__((target("sse4.1"))) static int dot_i8_sse41(const int8_t *a, const int8_t *b, size_t n)
+{
+  __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+  __m128i acc2 = _mm_setzero_si128(), acc3 = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    acc0 = _mm_add_epi32(acc0, madd_i8x8_sse41(a + i, b + i));
+    acc1 = _mm_add_epi32(acc1, madd_i8x8_sse41(a + i + 8, b + i + 8));
+    acc2 = _mm_add_epi32(acc2, madd_i8x8_sse41(a + i + 16, b + i + 16));
+    acc3 = _mm_add_epi32(acc3, madd_i8x8_sse41(a + i + 24, b + i + 24));
+  }
+  for (; i + 8 <= n; i += 8)
+    acc0 = _mm_add_epi32(acc0, madd_i8x8_sse41(a + i, b + i));
+
+  int sum = hsum_epi32_sse41(_mm_add_epi32(_mm_add_epi32(acc0, acc1), _mm_add_epi32(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("sse4.1"))) static int dot_i16_sse41(const int16_t *a, const int16_t *b, size_t n)
+{
+  __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+  __m128i acc2 = _mm_setzero_si128(), acc3 = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+    acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i + 8)), _mm_loadu_si128((const __m128i *)(b + i + 8))));
+    acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i + 16)), _mm_loadu_si128((const __m128i *)(b + i + 16))));
+    acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i + 24)), _mm_loadu_si128((const __m128i *)(b + i + 24))));
+  }
+  for (; i + 8 <= n; i += 8)
+    acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+
+  int sum = hsum_epi32_sse41(_mm_add_epi32(_mm_add_epi32(acc0, acc1), _mm_add_epi32(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+/**
+ * @brief Sign-extends 16 int8 pairs to int16 and multiply-adds them into 8 int32 lanes.
+ */
+__attribute__((target("avx2"))) static inline __m256i madd_i8x16_avx2(const int8_t *a, const int8_t *b)
+{
+  return _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)a)),
+                           _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)b)));
+}
+
+__attribute__((target("avx2"))) static int dot_i8_avx2(const int8_t *a, const int8_t *b, size_t n)
+{
+  __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+  __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    acc0 = _mm256_add_epi32(acc0, madd_i8x16_avx2(a + i, b + i));
+    acc1 = _mm256_add_epi32(acc1, madd_i8x16_avx2(a + i + 16, b + i + 16));
+    acc2 = _mm256_add_epi32(acc2, madd_i8x16_avx2(a + i + 32, b + i + 32));
+    acc3 = _mm256_add_epi32(acc3, madd_i8x16_avx2(a + i + 48, b + i + 48));
+  }
+  for (; i + 16 <= n; i += 16)
+    acc0 = _mm256_add_epi32(acc0, madd_i8x16_avx2(a + i, b + i));
+
+  int sum = hsum_epi32_avx2(_mm256_add_epi32(_mm256_add_epi32(acc0, acc1), _mm256_add_epi32(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("avx2"))) static int dot_i16_avx2(const int16_t *a, const int16_t *b, size_t n)
+{
+  __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+  __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+    acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i + 16)), _mm256_loadu_si256((const __m256i *)(b + i + 16))));
+    acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i + 32)), _mm256_loadu_si256((const __m256i *)(b + i + 32))));
+    acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i + 48)), _mm256_loadu_si256((const __m256i *)(b + i + 48))));
+  }
+  for (; i + 16 <= n; i += 16)
+    acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+
+  int sum = hsum_epi32_avx2(_mm256_add_epi32(_mm256_add_epi32(acc0, acc1), _mm256_add_epi32(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("avx2,fma,f16c"))) static float dot_f16_avx2(const matvec_half *a, const float *b, size_t n)
+{
+  __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+  __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    acc0 = _mm256_fmadd_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i))), _mm256_loadu_ps(b + i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i + 8))), _mm256_loadu_ps(b + i + 8), acc1);
+    acc2 = _mm256_fmadd_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i + 16))), _mm256_loadu_ps(b + i + 16), acc2);
+    acc3 = _mm256_fmadd_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i + 24))), _mm256_loadu_ps(b + i + 24), acc3);
+  }
+  for (; i + 8 <= n; i += 8)
+    acc0 = _mm256_fmadd_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i))), _mm256_loadu_ps(b + i), acc0);
+
+  __m256 acc = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  float sum = _mm_cvtss_f32(half);
+  for (; i < n; i++)
+    sum += matvec_half_to_float(a[i]) * b[i];
+  return sum;
+}
+
+/**
+ * @brief Sign-extends 16 int8 pairs to int32 and multiplies them (AVX-512F has no byte/word madd).
+ */
+__attribute__((target("avx512f"))) static inline __m512i mul_i8x16_avx512(const int8_t *a, const int8_t *b)
+{
+  return _mm512_mullo_epi32(_mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i *)a)),
+                            _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i *)b)));
+}
+
+__attribute__((target("avx512f"))) static int dot_i8_avx512(const int8_t *a, const int8_t *b, size_t n)
+{
+  __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+  __m512i acc2 = _mm512_setzero_si512(), acc3 = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    acc0 = _mm512_add_epi32(acc0, mul_i8x16_avx512(a + i, b + i));
+    acc1 = _mm512_add_epi32(acc1, mul_i8x16_avx512(a + i + 16, b + i + 16));
+    acc2 = _mm512_add_epi32(acc2, mul_i8x16_avx512(a + i + 32, b + i + 32));
+    acc3 = _mm512_add_epi32(acc3, mul_i8x16_avx512(a + i + 48, b + i + 48));
+  }
+  for (; i + 16 <= n; i += 16)
+    acc0 = _mm512_add_epi32(acc0, mul_i8x16_avx512(a + i, b + i));
+
+  int sum = _mm512_reduce_add_epi32(_mm512_add_epi32(_mm512_add_epi32(acc0, acc1), _mm512_add_epi32(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+/**
+ * @brief Sign-extends 16 int16 pairs to int32 and multiplies them.
+ */
+__attribute__((target("avx512f"))) static inline __m512i mul_i16x16_avx512(const int16_t *a, const int16_t *b)
+{
+  return _mm512_mullo_epi32(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)a)),
+                            _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)b)));
+}
+
+__attribute__((target("avx512f"))) static int dot_i16_avx512(const int16_t *a, const int16_t *b, size_t n)
+{
+  __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+  __m512i acc2 = _mm512_setzero_si512(), acc3 = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    acc0 = _mm512_add_epi32(acc0, mul_i16x16_avx512(a + i, b + i));
+    acc1 = _mm512_add_epi32(acc1, mul_i16x16_avx512(a + i + 16, b + i + 16));
+    acc2 = _mm512_add_epi32(acc2, mul_i16x16_avx512(a + i + 32, b + i + 32));
+    acc3 = _mm512_add_epi32(acc3, mul_i16x16_avx512(a + i + 48, b + i + 48));
+  }
+  for (; i + 16 <= n; i += 16)
+    acc0 = _mm512_add_epi32(acc0, mul_i16x16_avx512(a + i, b + i));
+
+  int sum = _mm512_reduce_add_epi32(_mm512_add_epi32(_mm512_add_epi32(acc0, acc1), _mm512_add_epi32(acc2, acc3)));
+  for (; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+__attribute__((target("avx512f"))) static float dot_f16_avx512(const matvec_half *a, const float *b, size_t n)
+{
+  __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+  __m512 acc2 = _mm512_setzero_ps(), acc3 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    acc0 = _mm512_fmadd_ps(_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(a + i))), _mm512_loadu_ps(b + i), acc0);
+    acc1 = _mm512_fmadd_ps(_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(a + i + 16))), _mm512_loadu_ps(b + i + 16), acc1);
+    acc2 = _mm512_fmadd_ps(_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(a + i + 32))), _mm512_loadu_ps(b + i + 32), acc2);
+    acc3 = _mm512_fmadd_ps(_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(a + i + 48))), _mm512_loadu_ps(b + i + 48), acc3);
+  }
+  for (; i + 16 <= n; i += 16)
+    acc0 = _mm512_fmadd_ps(_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(a + i))), _mm512_loadu_ps(b + i), acc0);
+
+  float sum = _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)));
+  for (; i < n; i++)
+    sum += matvec_half_to_float(a[i]) * b[i];
+  return sum;
+}
+
+#endif
+
+int matvec_isa_supported(matvec_isa isa)
+{
+  switch (isa)
+  {
+  case MATVEC_ISA_SCALAR:
+    return 1;
+#ifdef MATVEC_X86
+  case MATVEC_ISA_SSE41:
+    return __builtin_cpu_supports("sse4.1");
+  case MATVEC_ISA_AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case MATVEC_ISA_AVX512:
+    return __builtin_cpu_supports("avx512f");
+#endif
+  default:
+    return 0;
+  }
+}
+
+const char *matvec_isa_name(matvec_isa isa)
+{
+  static const char *names[MATVEC_ISA_COUNT] = {"scalar", "sse4.1", "avx2", "avx512"};
+  return isa < MATVEC_ISA_COUNT ? names[isa] : "unknown";
+}
+
+matvec_isa matvec_selected_isa(void)
+{
+  // Parallel kernels may get here together; they all compute the same value.
+  static int selected = -1;
+  const int cached = __atomic_load_n(&selected, __ATOMIC_RELAXED);
+  if (cached >= 0)
+    return (matvec_isa)cached;
+
+  matvec_isa best = MATVEC_ISA_SCALAR;
+  for (int isa = MATVEC_ISA_COUNT - 1; isa > MATVEC_ISA_SCALAR; isa--)
+  {
+    if (matvec_isa_supported((matvec_isa)isa))
+    {
+      best = (matvec_isa)isa;
+      break;
+    }
+  }
+
+  const char *forced = getenv("MATVEC_ISA");
+  if (forced)
+  {
+    for (int isa = 0; isa < (int)best; isa++)
+    {
+      if (strcmp(forced, matvec_isa_name((matvec_isa)isa)) == 0)
+        best = (matvec_isa)isa;
+    }
+  }
+
+  __atomic_store_n(&selected, (int)best, __ATOMIC_RELAXED);
+  return best;
+}
+
+matvec_dot_i32_fn matvec_dot_i32_for(matvec_isa isa)
+{
+  switch (isa)
+  {
+#ifdef MATVEC_X86
+  case MATVEC_ISA_SSE41:
+    return dot_i32_sse41;
+  case MATVEC_ISA_AVX2:
+    return dot_i32_avx2;
+  case MATVEC_ISA_AVX512:
+    return dot_i32_avx512;
+#endif
+  default:
+    return dot_i32_scalar;
+  }
+}
+
+matvec_dot_f32_fn matvec_dot_f32_for(matvec_isa isa)
+{
+  switch (isa)
+  {
+#ifdef MATVEC_X86
+  case MATVEC_ISA_SSE41:
+    return dot_f32_sse41;
+  case MATVEC_ISA_AVX2:
+    return dot_f32_avx2;
+  case MATVEC_ISA_AVX512:
+    return dot_f32_avx512;
+#endif
+  default:
+    return dot_f32_scalar;
+  }
+}
+
+matvec_dot_i8_fn matvec_dot_i8_for(matvec_isa isa)
+{
+  switch (isa)
+  {
+#ifdef MATVEC_X86
+  case MATVEC_ISA_SSE41:
+    return dot_i8_sse41;
+  case MATVEC_ISA_AVX2:
+    return dot_i8_avx2;
+  case MATVEC_ISA_AVX512:
+    return dot_i8_avx512;
+#endif
+  default:
+    return dot_i8_scalar;
+  }
+}
+
+matvec_dot_i16_fn matvec_dot_i16_for(matvec_isa isa)
+{
+  switch (isa)
+  {
+#ifdef MATVEC_X86
+  case MATVEC_ISA_SSE41:
+    return dot_i16_sse41;
+  case MATVEC_ISA_AVX2:
+    return dot_i16_avx2;
+  case MATVEC_ISA_AVX512:
+    return dot_i16_avx512;
+#endif
+  default:
+    return dot_i16_scalar;
+  }
+}
+
+matvec_dot_f16_fn matvec_dot_f16_for(matvec_isa isa)
+{
+  switch (isa)
+  {
+#ifdef MATVEC_X86
+  case MATVEC_ISA_AVX2:
+    return __builtin_cpu_supports("f16c") ? dot_f16_avx2 : dot_f16_scalar;
+  case MATVEC_ISA_AVX512:
+    return dot_f16_avx512;
+#endif
+  default:
+    return dot_f16_scalar;
+  }
+}
+
+matvec_half matvec_half_from_float(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign = (bits >> 16) & 0x8000;
+  const int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+  uint32_t mantissa = bits & 0x7fffff;
+
+  if ((bits & 0x7fffffff) > 0x7f800000)
+    return (matvec_half)(sign | 0x7e00); // NaN
+  if (exponent >= 31)
+    return (matvec_half)(sign | 0x7c00); // Overflow and infinity.
+
+  if (exponent <= 0)
+  {
+    // Subnormal half: shift the mantissa (with its implicit 1) into place.
+    if (exponent < -10)
+      return (matvec_half)sign;
+    mantissa |= 0x800000;
+    const int shift = 14 - exponent;
+    uint32_t half = mantissa >> shift;
+    const uint32_t rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1)))
+      half++;
+    return (matvec_half)(sign | half);
+  }
+
+  // A carry out of the mantissa correctly bumps the exponent (up to infinity).
+  uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+  const uint32_t rest = mantissa & 0x1fff;
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+    half++;
+  return (matvec_half)half;
+}
+
+float matvec_half_to_float(matvec_half value)
+{
+  const uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1f;
+  const uint32_t mantissa = value & 0x3ff;
+  uint32_t bits;
+
+  if (exponent == 0)
+  {
+    // Zero or subnormal: mantissa * 2^-24, exact in float.
+    float magnitude = (float)mantissa * (1.0f / 16777216.0f);
+    return sign ? -magnitude : magnitude;
+  }
+  if (exponent == 31)
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  else
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static int dot_i32_resolve(const int *a, const int *b, size_t n);
+static float dot_f32_resolve(const float *a, const float *b, size_t n);
+
+static matvec_dot_i32_fn dot_i32_impl = dot_i32_resolve;
+static matvec_dot_f32_fn dot_f32_impl = dot_f32_resolve;
+
+/**
+ * @brief First call of matvec_dot_i32 (without matvec_simd_init): binds the selected kernel, then runs it.
+ */
+static int dot_i32_resolve(const int *a, const int *b, size_t n)
+{
+  const matvec_dot_i32_fn impl = matvec_dot_i32_for(matvec_selected_isa());
+  __atomic_store_n(&dot_i32_impl, impl, __ATOMIC_RELEASE);
+  return impl(a, b, n);
+}
+
+/**
+ * @brief First call of matvec_dot_f32 (without matvec_simd_init): binds the selected kernel, then runs it.
+ */
+static float dot_f32_resolve(const float *a, const float *b, size_t n)
+{
+  const matvec_dot_f32_fn impl = matvec_dot_f32_for(matvec_selected_isa());
+  __atomic_store_n(&dot_f32_impl, impl, __ATOMIC_RELEASE);
+  return impl(a, b, n);
+}
+
+void matvec_simd_init(void)
+{
+  const matvec_isa isa = matvec_selected_isa();
+  __atomic_store_n(&dot_i32_impl, matvec_dot_i32_for(isa), __ATOMIC_RELEASE);
+  __atomic_store_n(&dot_f32_impl, matvec_dot_f32_for(isa), __ATOMIC_RELEASE);
+}
+
+int matvec_dot_i32(const int *a, const int *b, size_t n)
+{
+  return __atomic_load_n(&dot_i32_impl, __ATOMIC_ACQUIRE)(a, b, n);
+}
+
+float matvec_dot_f32(const float *a, const float *b, size_t n)
+{
+  return __atomic_load_n(&dot_f32_impl, __ATOMIC_ACQUIRE)(a, b, n);
+}
+
+void matvec_gemv_i32(const int *matrix, size_t rows, size_t cols, size_t ld, const int *vector, int *result, matvec_dot_i32_fn dot)
+{
+  if (!dot)
+    dot = matvec_dot_i32;
+  for (size_t i = 0; i < rows; i++)
+  {
+    result[i] = dot(matrix + i * ld, vector, cols);
+  }
+}
+
+void matvec_gemv_f32(const float *matrix, size_t rows, size_t cols, size_t ld, const float *vector, float *result, matvec_dot_f32_fn dot)
+{
+  if (!dot)
+    dot = matvec_dot_f32;
+  for (size_t i = 0; i < rows; i++)
+  {
+    result[i] = dot(matrix + i * ld, vector, cols);
+  }
+}
@@ -0,0 +1,167 @@
+/**
+ * @file matvec_simd.h
+ * @brief Explicitly vectorized dot-product kernels with runtime ISA dispatch.
+ *
+ * Each kernel keeps several independent vector accumulators in registers,
+ * so the inner loop of a row-wise matrix-vector product neither writes
+ * `result[i]` per element nor waits on a single add chain. The widest
+ * instruction set supported by the CPU is picked on first use (through
+ * cpuid, via `__builtin_cpu_supports`); the scalar kernel is always
+ * available as a fallback. Setting `MATVEC_ISA=scalar|sse4.1|avx2|avx512`
+ * forces a narrower kernel.
+ *
+ * Kernels only work on raw pointers, so they serve both the contiguous
+ * matrix of matvec.h and the mmap buffer of the static version. Besides
+ * int32 and float, there are widening kernels for narrower storage (int8
+ * and int16 accumulated in int32, half accumulated in float), used by
+ * matvec_precision.h.
+ */
+
+#ifndef MATVEC_SIMD_H
+#define MATVEC_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @enum matvec_isa
+ * @brief Instruction sets a kernel can be built for, narrowest first.
+ */
+typedef enum
+{
+  MATVEC_ISA_SCALAR, ///< Plain C, always available.
+  MATVEC_ISA_SSE41,  ///< 128-bit SSE4.1 (`pmulld`).
+  MATVEC_ISA_AVX2,   ///< 256-bit AVX2 (+FMA for float).
+  MATVEC_ISA_AVX512, ///< 512-bit AVX-512F.
+  MATVEC_ISA_COUNT
+} matvec_isa;
+
+/**
+ * @brief Builds a function for AVX-512F, AVX2 and baseline x86-64, picked at load time from cpuid.
+ *
+ * For plain-C loops that rely on auto-vectorization (the `-O2` baseline has
+ * no packed 32-bit multiply or gather). Expands to nothing where GCC's
+ * `target_clones` is unavailable.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define MATVEC_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define MATVEC_TARGET_CLONES
+#endif
+
+/**
+ * @brief IEEE 754 binary16 value, stored as its bit pattern.
+ */
+typedef uint16_t matvec_half;
+
+typedef int (*matvec_dot_i32_fn)(const int *a, const int *b, size_t n);
+typedef float (*matvec_dot_f32_fn)(const float *a, const float *b, size_t n);
+typedef int (*matvec_dot_i8_fn)(const int8_t *a, const int8_t *b, size_t n);
+typedef int (*matvec_dot_i16_fn)(const int16_t *a, const int16_t *b, size_t n);
+typedef float (*matvec_dot_f16_fn)(const matvec_half *a, const float *b, size_t n);
+
+/**
+ * @brief Returns 1 if the CPU (and OS) can run kernels of the given ISA.
+ */
+int matvec_isa_supported(matvec_isa isa);
+
+/**
+ * @brief Returns the ISA used by the dispatched kernels.
+ *
+ * This is the widest supported ISA, unless `MATVEC_ISA` names a narrower
+ * supported one.
+ */
+matvec_isa matvec_selected_isa(void);
+
+/**
+ * @brief Returns the printable name of an ISA ("scalar", "sse4.1", ...).
+ */
+const char *matvec_isa_name(matvec_isa isa);
+
+/**
+ * @brief Returns the int32 dot-product kernel built for an ISA.
+ *
+ * The caller must check matvec_isa_supported() before calling it.
+ */
+matvec_dot_i32_fn matvec_dot_i32_for(matvec_isa isa);
+
+/**
+ * @brief Returns the float dot-product kernel built for an ISA.
+ *
+ * The caller must check matvec_isa_supported() before calling it.
+ */
+matvec_dot_f32_fn matvec_dot_f32_for(matvec_isa isa);
+
+/**
+ * @brief Returns the int8 dot-product kernel built for an ISA.
+ *
+ * Elements are sign-extended to 16 or 32 bits before the multiply, and the
+ * products are accumulated in int32 lanes.
+ * The caller must check matvec_isa_supported() before calling it.
+ */
+matvec_dot_i8_fn matvec_dot_i8_for(matvec_isa isa);
+
+/**
+ * @brief Returns the int16 dot-product kernel built for an ISA, accumulating in int32.
+ *
+ * The caller must check matvec_isa_supported() before calling it.
+ */
+matvec_dot_i16_fn matvec_dot_i16_for(matvec_isa isa);
+
+/**
+ * @brief Returns the half x float dot-product kernel built for an ISA, accumulating in float.
+ *
+ * Half elements are widened with F16C (`vcvtph2ps`); without it (SSE4.1,
+ * or AVX2 CPUs lacking F16C) the scalar kernel converts them in software.
+ * The caller must check matvec_isa_supported() before calling it.
+ */
+matvec_dot_f16_fn matvec_dot_f16_for(matvec_isa isa);
+
+/**
+ * @brief Converts a float to half, rounding to nearest even.
+ */
+matvec_half matvec_half_from_float(float value);
+
+/**
+ * @brief Converts a half to float (exact).
+ */
+float matvec_half_to_float(matvec_half value);
+
+/**
+ * @brief Selects the ISA and binds the dispatched kernels.
+ *
+ * Call it once before the first parallel region. Without it, the first
+ * call of matvec_dot_i32()/matvec_dot_f32() binds its kernel (atomically,
+ * so concurrent first calls are still safe).
+ */
+void matvec_simd_init(void);
+
+/**
+ * @brief Dispatched int32 dot product of two vectors of length n.
+ */
+int matvec_dot_i32(const int *a, const int *b, size_t n);
+
+/**
+ * @brief Dispatched float dot product of two vectors of length n.
+ */
+float matvec_dot_f32(const float *a, const float *b, size_t n);
+
+/**
+ * @brief Row-major int32 matrix-vector product using the given dot kernel.
+ * @param matrix Row-major matrix with leading dimension ld.
+ * @param rows Number of rows.
+ * @param cols Number of columns.
+ * @param ld Leading dimension in elements.
+ * @param vector Input vector of length cols.
+ * @param result Output vector of length rows.
+ * @param dot Dot-product kernel (NULL for the dispatched one).
+ */
+void matvec_gemv_i32(const int *matrix, size_t rows, size_t cols, size_t ld, const int *vector, int *result, matvec_dot_i32_fn dot);
+
+/**
+ * @brief Row-major float matrix-vector product using the given dot kernel.
+ * @see matvec_gemv_i32
+ */
+void matvec_gemv_f32(const float *matrix, size_t rows, size_t cols, size_t ld, const float *vector, float *result, matvec_dot_f32_fn dot);
+
+#endif
@@ -0,0 +1,303 @@
+/**
+ * @file matvec_sparse.c
+ * @brief Compressed sparse storage (CSR and SELL-C-sigma) and SpMV kernels.
+ */
+
+#include "matvec_sparse.h"
+#include "matvec_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#define SELL_MAX_CHUNK 64 ///< Largest supported chunk height (size of the kernel's register tile).
+
+void matvec_fill_random_sparse(matvec_matrix *matrix, int *vector, double density)
+{
+  const int threshold = (int)(density * RAND_MAX);
+  for (size_t i = 0; i < matrix->rows; i++)
+  {
+    for (size_t j = 0; j < matrix->cols; j++)
+    {
+      *matvec_at(matrix, i, j) = rand() <= threshold && density > 0.0 ? rand() % 9 + 1 : 0;
+    }
+  }
+  for (size_t j = 0; j < matrix->cols; j++)
+    vector[j] = rand() % 10;
+}
+
+int matvec_csr_from_dense(const matvec_matrix *dense, matvec_csr *csr)
+{
+  const size_t rows = dense->rows, cols = dense->cols;
+
+  csr->rows = rows;
+  csr->cols = cols;
+  csr->row_ptr = malloc((rows + 1) * sizeof(size_t));
+  if (!csr->row_ptr)
+    return -1;
+
+  size_t nnz = 0;
+  csr->row_ptr[0] = 0;
+  for (size_t i = 0; i < rows; i++)
+  {
+    for (size_t j = 0; j < cols; j++)
+      nnz += *matvec_at(dense, i, j) != 0;
+    csr->row_ptr[i + 1] = nnz;
+  }
+
+  csr->nnz = nnz;
+  csr->col_idx = malloc((nnz ? nnz : 1) * sizeof(int));
+  csr->values = malloc((nnz ? nnz : 1) * sizeof(int));
+  if (!csr->col_idx || !csr->values)
+  {
+    matvec_csr_free(csr);
+    return -1;
+  }
+
+  size_t k = 0;
+  for (size_t i = 0; i < rows; i++)
+  {
+    for (size_t j = 0; j < cols; j++)
+    {
+      const int value = *matvec_at(dense, i, j);
+      if (value != 0)
+      {
+        csr->col_idx[k] = (int)j;
+        csr->values[k] = value;
+        k++;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Row index and length, used to sort rows inside a sigma window.
+ */
+struct row_length
+{
+  size_t length;
+  int row;
+};
+
+/**
+ * @brief qsort comparator: decreasing length, then increasing row index.
+ */
+static int compare_row_length(const void *a, const void *b)
+{
+  const struct row_length *ra = a, *rb = b;
+  if (ra->length != rb->length)
+    return ra->length < rb->length ? 1 : -1;
+  return ra->row - rb->row;
+}
+
+int matvec_sell_from_csr(const matvec_csr *csr, size_t chunk, size_t sigma, matvec_sell *sell)
+{
+  if (chunk == 0 || chunk > SELL_MAX_CHUNK)
+    return -1;
+  if (sigma < chunk)
+    sigma = 1;
+  else
+    sigma = (sigma + chunk - 1) / chunk * chunk;
+
+  memset(sell, 0, sizeof(*sell));
+  sell->rows = csr->rows;
+  sell->cols = csr->cols;
+  sell->nnz = csr->nnz;
+  sell->chunk = chunk;
+  sell->sigma = sigma;
+  sell->chunks = (csr->rows + chunk - 1) / chunk;
+
+  const size_t padded_rows = sell->chunks * chunk;
+  struct row_length *order = malloc((padded_rows ? padded_rows : 1) * sizeof(*order));
+  sell->chunk_ptr = malloc((sell->chunks + 1) * sizeof(size_t));
+  sell->chunk_len = malloc((sell->chunks ? sell->chunks : 1) * sizeof(int));
+  sell->perm = malloc((padded_rows ? padded_rows : 1) * sizeof(int));
+  if (!order || !sell->chunk_ptr || !sell->chunk_len || !sell->perm)
+  {
+    free(order);
+    matvec_sell_free(sell);
+    return -1;
+  }
+
+  for (size_t i = 0; i < padded_rows; i++)
+  {
+    order[i].row = i < csr->rows ? (int)i : -1;
+    order[i].length = i < csr->rows ? csr->row_ptr[i + 1] - csr->row_ptr[i] : 0;
+  }
+  if (sigma > 1)
+  {
+    for (size_t w = 0; w < csr->rows; w += sigma)
+    {
+      const size_t n = w + sigma <= csr->rows ? sigma : csr->rows - w;
+      qsort(order + w, n, sizeof(*order), compare_row_length);
+    }
+  }
+
+  sell->chunk_ptr[0] = 0;
+  for (size_t c = 0; c < sell->chunks; c++)
+  {
+    size_t longest = 0;
+    for (size_t r = 0; r < chunk; r++)
+    {
+      sell->perm[c * chunk + r] = order[c * chunk + r].row;
+      if (order[c * chunk + r].length > longest)
+        longest = order[c * chunk + r].length;
+    }
+    sell->chunk_len[c] = (int)longest;
+    sell->chunk_ptr[c + 1] = sell->chunk_ptr[c] + longest * chunk;
+  }
+
+  const size_t stored = sell->chunk_ptr[sell->chunks];
+  sell->col_idx = malloc((stored ? stored : 1) * sizeof(int));
+  sell->values = malloc((stored ? stored : 1) * sizeof(int));
+  if (!sell->col_idx || !sell->values)
+  {
+    free(order);
+    matvec_sell_free(sell);
+    return -1;
+  }
+
+  for (size_t c = 0; c < sell->chunks; c++)
+  {
+    for (size_t r = 0; r < chunk; r++)
+    {
+      const int row = sell->perm[c * chunk + r];
+      const size_t begin = row >= 0 ? csr->row_ptr[row] : 0;
+      const size_t length = row >= 0 ? csr->row_ptr[row + 1] - begin : 0;
+      for (size_t l = 0; l < (size_t)sell->chunk_len[c]; l++)
+      {
+        const size_t at = sell->chunk_ptr[c] + l * chunk + r;
+        // Padding points at column 0 with value 0, so the kernel needs no mask.
+        sell->col_idx[at] = l < length ? csr->col_idx[begin + l] : 0;
+        sell->values[at] = l < length ? csr->values[begin + l] : 0;
+      }
+    }
+  }
+
+  free(order);
+  return 0;
+}
+
+void matvec_csr_free(matvec_csr *csr)
+{
+  free(csr->row_ptr);
+  free(csr->col_idx);
+  free(csr->values);
+  csr->row_ptr = NULL;
+  csr->col_idx = NULL;
+  csr->values = NULL;
+}
+
+void matvec_sell_free(matvec_sell *sell)
+{
+  free(sell->chunk_ptr);
+  free(sell->chunk_len);
+  free(sell->perm);
+  free(sell->col_idx);
+  free(sell->values);
+  sell->chunk_ptr = NULL;
+  sell->chunk_len = NULL;
+  sell->perm = NULL;
+  sell->col_idx = NULL;
+  sell->values = NULL;
+}
+
+size_t matvec_csr_bytes(const matvec_csr *csr)
+{
+  return (csr->rows + 1) * sizeof(size_t) + csr->nnz * (sizeof(int) + sizeof(int));
+}
+
+size_t matvec_sell_bytes(const matvec_sell *sell)
+{
+  const size_t stored = sell->chunk_ptr[sell->chunks];
+  return (sell->chunks + 1) * sizeof(size_t) + sell->chunks * sizeof(int) +
+         sell->chunks * sell->chunk * sizeof(int) + stored * (sizeof(int) + sizeof(int));
+}
+
+/**
+ * @brief Products of the CSR rows [begin, end).
+ */
+static void csr_rows(const matvec_csr *csr, const int *vector, int *result, size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; i++)
+  {
+    int sum = 0;
+    for (size_t k = csr->row_ptr[i]; k < csr->row_ptr[i + 1]; k++)
+      sum += csr->values[k] * vector[csr->col_idx[k]];
+    result[i] = sum;
+  }
+}
+
+void matvec_csr_mult(const matvec_csr *csr, const int *vector, int *result)
+{
+  csr_rows(csr, vector, result, 0, csr->rows);
+}
+
+/**
+ * @brief First row whose non-zeros start at or after the given offset.
+ */
+static size_t csr_row_at(const matvec_csr *csr, size_t offset)
+{
+  size_t low = 0, high = csr->rows;
+  while (low < high)
+  {
+    size_t mid = low + (high - low) / 2;
+    if (csr->row_ptr[mid] < offset)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+void matvec_csr_mult_parallel(const matvec_csr *csr, const int *vector, int *result)
+{
+#pragma omp parallel
+  {
+    // Split the non-zeros (the actual work), not the rows, evenly.
+    const size_t tid = omp_get_thread_num(), threads = omp_get_num_threads();
+    const size_t begin = tid == 0 ? 0 : csr_row_at(csr, csr->nnz * tid / threads);
+    const size_t end = tid + 1 == threads ? csr->rows : csr_row_at(csr, csr->nnz * (tid + 1) / threads);
+    csr_rows(csr, vector, result, begin, end);
+  }
+}
+
+/**
+ * @brief Product of one SELL chunk; the chunk's rows are the SIMD lanes.
+ */
+MATVEC_TARGET_CLONES static void sell_chunk(const matvec_sell *sell, size_t c, const int *vector, int *result)
+{
+  const size_t chunk = sell->chunk;
+  const int *values = sell->values + sell->chunk_ptr[c];
+  const int *cols = sell->col_idx + sell->chunk_ptr[c];
+  int sum[SELL_MAX_CHUNK] = {0};
+
+  for (int l = 0; l < sell->chunk_len[c]; l++)
+  {
+#pragma omp simd
+    for (size_t r = 0; r < chunk; r++)
+      sum[r] += values[l * chunk + r] * vector[cols[l * chunk + r]];
+  }
+
+  const int *rows = sell->perm + c * chunk;
+  for (size_t r = 0; r < chunk; r++)
+  {
+    if (rows[r] >= 0)
+      result[rows[r]] = sum[r];
+  }
+}
+
+void matvec_sell_mult(const matvec_sell *sell, const int *vector, int *result)
+{
+  for (size_t c = 0; c < sell->chunks; c++)
+    sell_chunk(sell, c, vector, result);
+}
+
+void matvec_sell_mult_parallel(const matvec_sell *sell, const int *vector, int *result)
+{
+  // Chunk lengths vary with the row lengths, so hand them out dynamically.
+#pragma omp parallel for schedule(dynamic, 32)
+  for (size_t c = 0; c < sell->chunks; c++)
+    sell_chunk(sell, c, vector, result);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file matvec_sparse.h
+ * @brief Compressed sparse storage (CSR and SELL-C-sigma) and SpMV kernels.
+ *
+ * Both formats are built from a dense matvec_matrix, so the sparse kernels
+ * can be checked against the dense ones on exactly the same data. Values
+ * and column indices are 32-bit, so each stored non-zero costs 8 bytes
+ * against 4 bytes per element in dense storage: sparse storage uses less
+ * memory below 50% density, and 10-100x less at 5-0.5%.
+ */
+
+#ifndef MATVEC_SPARSE_H
+#define MATVEC_SPARSE_H
+
+#include <stddef.h>
+
+#include "matvec.h"
+
+/**
+ * @struct matvec_csr
+ * @brief Compressed Sparse Row matrix.
+ *
+ * The non-zeros of row i are `values[row_ptr[i] .. row_ptr[i + 1] - 1]`,
+ * in increasing column order, with their columns in `col_idx`.
+ */
+typedef struct
+{
+  size_t rows;     ///< Number of rows.
+  size_t cols;     ///< Number of columns.
+  size_t nnz;      ///< Number of stored non-zeros.
+  size_t *row_ptr; ///< rows + 1 offsets into col_idx/values.
+  int *col_idx;    ///< Column of each non-zero.
+  int *values;     ///< Value of each non-zero.
+} matvec_csr;
+
+/**
+ * @struct matvec_sell
+ * @brief SELL-C-sigma (sliced ELLPACK) matrix.
+ *
+ * Rows are sorted by decreasing length inside windows of `sigma` rows and
+ * grouped into chunks of `chunk` consecutive sorted rows. Each chunk is
+ * padded to its longest row and stored column by column, so one step of
+ * the kernel processes `chunk` rows with contiguous loads that map onto
+ * SIMD lanes. Sorting keeps rows of similar length together, which limits
+ * the padding.
+ */
+typedef struct
+{
+  size_t rows;       ///< Number of rows.
+  size_t cols;       ///< Number of columns.
+  size_t nnz;        ///< Number of real non-zeros (without padding).
+  size_t chunk;      ///< Rows per chunk (C).
+  size_t sigma;      ///< Sorting window in rows.
+  size_t chunks;     ///< Number of chunks.
+  size_t *chunk_ptr; ///< chunks + 1 offsets into col_idx/values.
+  int *chunk_len;    ///< Padded row length of each chunk.
+  int *perm;         ///< Original row of each sorted row (chunks * chunk entries, -1 for padding rows).
+  int *col_idx;      ///< Column of each stored element (chunk-column-major).
+  int *values;       ///< Value of each stored element (0 for padding).
+} matvec_sell;
+
+/**
+ * @brief Fills the matrix so each element is non-zero with the given probability.
+ *
+ * Non-zero values are `rand() % 9 + 1`; the vector is filled with `rand() % 10`.
+ *
+ * @param matrix Matrix to fill.
+ * @param vector Vector of length `matrix->cols`.
+ * @param density Probability of a non-zero element, in [0, 1].
+ */
+void matvec_fill_random_sparse(matvec_matrix *matrix, int *vector, double density);
+
+/**
+ * @brief Converts a dense matrix (either layout) to CSR.
+ * @return 0 on success, -1 if the allocation failed.
+ */
+int matvec_csr_from_dense(const matvec_matrix *dense, matvec_csr *csr);
+
+/**
+ * @brief Converts a CSR matrix to SELL-C-sigma.
+ * @param csr Source matrix.
+ * @param chunk Rows per chunk (C), typically the SIMD width in ints.
+ * @param sigma Sorting window in rows (rounded up to a multiple of chunk; 1 disables sorting).
+ * @param sell Destination matrix.
+ * @return 0 on success, -1 if the allocation failed.
+ */
+int matvec_sell_from_csr(const matvec_csr *csr, size_t chunk, size_t sigma, matvec_sell *sell);
+
+/**
+ * @brief Releases a CSR matrix.
+ */
+void matvec_csr_free(matvec_csr *csr);
+
+/**
+ * @brief Releases a SELL-C-sigma matrix.
+ */
+void matvec_sell_free(matvec_sell *sell);
+
+/**
+ * @brief Bytes used by the CSR arrays.
+ */
+size_t matvec_csr_bytes(const matvec_csr *csr);
+
+/**
+ * @brief Bytes used by the SELL-C-sigma arrays, padding included.
+ */
+size_t matvec_sell_bytes(const matvec_sell *sell);
+
+/**
+ * @brief Serial CSR sparse matrix-vector product.
+ */
+void matvec_csr_mult(const matvec_csr *csr, const int *vector, int *result);
+
+/**
+ * @brief OpenMP CSR product; each thread gets a band of rows with the same number of non-zeros.
+ */
+void matvec_csr_mult_parallel(const matvec_csr *csr, const int *vector, int *result);
+
+/**
+ * @brief Serial SELL-C-sigma sparse matrix-vector product.
+ */
+void matvec_sell_mult(const matvec_sell *sell, const int *vector, int *result);
+
+/**
+ * @brief OpenMP SELL-C-sigma product, distributing chunks across threads.
+ */
+void matvec_sell_mult_parallel(const matvec_sell *sell, const int *vector, int *result);
+
+#endif
@@ -1,89 +1,359 @@
 /**
- * @file matrix_vector_mult.c
- * @brief Implements two versions of matrix-vector multiplication: row-major and column-major access.
+ * @file static_matrix_vector_mult.c
+ * @brief Compile-time-specialized vs runtime-sized matrix-vector multiplication.
  *
- * This program generates a random matrix and vector, performs multiplication
- * using both row-major and column-major access patterns, and measures execution
- * time for each method. The goal is to analyze performance differences based
- * on memory access patterns and cache utilization.
+ * The original version kept `int matrix[SIZE][SIZE]` on the stack, which
+ * capped SIZE at 1444. Here the fixed-size kernels are kept, but generated
+ * for each size in STATIC_SIZES (512, 1024, 2048 and 4096) so the compiler
+ * sees constant trip counts and can fully unroll and vectorize them. Next to
+ * them, a generic path takes the size at runtime.
+ *
+ * Both paths run on the same heap storage: one contiguous buffer from
+ * `mmap`, backed either by regular 4 KB pages or by 2 MB huge pages
+ * (`MAP_HUGETLB` when the system has reserved huge pages, otherwise
+ * transparent huge pages through `madvise(MADV_HUGEPAGE)`). For each size
+ * the harness reports whether the specialized kernels beat the generic
+ * ones, and how much the huge-page backing saves: a 4096 x 4096 matrix
+ * spans 16384 small pages but only 32 huge pages, so the column-wise walk
+ * stops missing the TLB on every row.
+ *
+ * The row-wise product is also run with the SIMD dot-product kernel picked
+ * at startup for this CPU (see matvec_simd.h), and split across OpenMP
+ * threads by rows.
+ *
+ * Times are medians of repeated runs taken with the shared harness of
+ * common/bench.h, whose options (`--reps`, `--cold`, `--csv`, ...) are
+ * accepted as well.
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <omp.h>
 
-#define SIZE 1444 ///< Default matrix and vector size.
+#include "matvec_simd.h"
+#include "../common/bench.h"
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)   ///< Size of an x86-64 huge page.
+#define MIN_MEASURED_ELEMENTS (1UL << 24)    ///< Each timed run repeats small sizes until this many elements are processed.
 
 /**
- * @brief Function to measure execution time of a function call.
- * @param func Function pointer to the multiplication function.
- * @param matrix Input matrix.
- * @param vector Input vector.
- * @param result Output vector.
- * @return Execution time in seconds.
+ * @brief Signature shared by the specialized and the generic kernels.
+ *
+ * The specialized kernels ignore `size`: it is a compile-time constant for them.
+ */
+typedef void (*static_kernel)(const int *matrix, const int *vector, int *result, size_t size);
+
+/**
+ * @brief Generates the row-major and column-major kernels for a fixed size N.
+ *
+ * The buffer is viewed as `const int (*)[N]`, so every index computation
+ * and loop bound is a constant.
+ */
+#define DEFINE_STATIC_KERNELS(N)                                                                    \
+  void matrix_vector_multiplication_row_##N(const int *data, const int *vector, int *result, size_t size) \
+  {                                                                                                 \
+    (void)size;                                                                                     \
+    const int(*matrix)[N] = (const int(*)[N])data;                                                  \
+    for (int i = 0; i < N; i++)                                                                     \
+    {                                                                                               \
+      int sum = 0;                                                                                  \
+      for (int j = 0; j < N; j++)                                                                   \
+      {                                                                                             \
+        sum += matrix[i][j] * vector[j];                                                            \
+      }                                                                                             \
+      result[i] = sum;                                                                              \
+    }                                                                                               \
+  }                                                                                                 \
+                                                                                                    \
+  void matrix_vector_multiplication_col_##N(const int *data, const int *vector, int *result, size_t size) \
+  {                                                                                                 \
+    (void)size;                                                                                     \
+    const int(*matrix)[N] = (const int(*)[N])data;                                                  \
+    for (int i = 0; i < N; i++)                                                                     \
+    {                                                                                               \
+      result[i] = 0;                                                                                \
+    }                                                                                               \
+    for (int j = 0; j < N; j++)                                                                     \
+    {                                                                                               \
+      for (int i = 0; i < N; i++)                                                                   \
+      {                                                                                             \
+        result[i] += matrix[i][j] * vector[j];                                                      \
+      }                                                                                             \
+    }                                                                                               \
+  }
+
+#define STATIC_SIZES(X) X(512) X(1024) X(2048) X(4096)
+
+STATIC_SIZES(DEFINE_STATIC_KERNELS)
+
+/**
+ * @struct static_variant
+ * @brief Specialized kernels generated for one size.
  */
-double measure_execution_time(void (*func)(int matrix[SIZE][SIZE], int *vector, int *result), int matrix[SIZE][SIZE], int *vector, int *result)
+struct static_variant
 {
-  struct timeval start, end;
-  gettimeofday(&start, NULL);
+  size_t size;       ///< Matrix and vector size.
+  static_kernel row; ///< Specialized row-major kernel.
+  static_kernel col; ///< Specialized column-major kernel.
+};
 
-  func(matrix, vector, result);
+#define STATIC_VARIANT(N) {N, matrix_vector_multiplication_row_##N, matrix_vector_multiplication_col_##N},
 
-  gettimeofday(&end, NULL);
+static const struct static_variant variants[] = {STATIC_SIZES(STATIC_VARIANT)};
+
+/**
+ * @brief Performs matrix-vector multiplication with row-major order for a runtime size.
+ * @param matrix Input matrix (size x size, row-major).
+ * @param vector Input vector.
+ * @param result Output vector.
+ * @param size Matrix and vector size.
+ */
+void matrix_vector_multiplication_row(const int *matrix, const int *vector, int *result, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    int sum = 0;
+    for (size_t j = 0; j < size; j++)
+    {
+      sum += matrix[i * size + j] * vector[j];
+    }
+    result[i] = sum;
+  }
+}
 
-  double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
-  return elapsed;
+/**
+ * @brief Performs matrix-vector multiplication with row-major order using the dispatched SIMD dot product.
+ * @param matrix Input matrix.
+ * @param vector Input vector.
+ * @param result Output vector.
+ * @param size Matrix and vector size.
+ */
+void matrix_vector_multiplication_row_simd(const int *matrix, const int *vector, int *result, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    result[i] = matvec_dot_i32(matrix + i * size, vector, size);
+  }
 }
 
 /**
- * @brief Performs matrix-vector multiplication with row-major order.
+ * @brief Performs matrix-vector multiplication with row-major order, one band of rows per OpenMP thread.
  * @param matrix Input matrix.
  * @param vector Input vector.
  * @param result Output vector.
+ * @param size Matrix and vector size.
  */
-void matrix_vector_multiplication_row(int matrix[SIZE][SIZE], int *vector, int *result)
+void matrix_vector_multiplication_row_parallel(const int *matrix, const int *vector, int *result, size_t size)
 {
-  for (int i = 0; i < SIZE; i++)
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < size; i++)
   {
-    result[i] = 0;
-    for (int j = 0; j < SIZE; j++)
-    {
-      result[i] += matrix[i][j] * vector[j];
-    }
+    result[i] = matvec_dot_i32(matrix + i * size, vector, size);
   }
 }
 
 /**
- * @brief Performs matrix-vector multiplication with column-major order.
+ * @brief Performs matrix-vector multiplication with column-major order for a runtime size.
  * @param matrix Input matrix.
  * @param vector Input vector.
  * @param result Output vector.
+ * @param size Matrix and vector size.
  */
-void matrix_vector_multiplication_col(int matrix[SIZE][SIZE], int *vector, int *result)
+void matrix_vector_multiplication_col(const int *matrix, const int *vector, int *result, size_t size)
 {
-  for (int i = 0; i < SIZE; i++)
+  for (size_t i = 0; i < size; i++)
   {
     result[i] = 0;
   }
-  for (int j = 0; j < SIZE; j++)
+  for (size_t j = 0; j < size; j++)
   {
-    for (int i = 0; i < SIZE; i++)
+    for (size_t i = 0; i < size; i++)
     {
-      result[i] += matrix[i][j] * vector[j];
+      result[i] += matrix[i * size + j] * vector[j];
     }
   }
 }
 
+/**
+ * @struct page_buffer
+ * @brief Contiguous matrix storage obtained from mmap.
+ */
+struct page_buffer
+{
+  void *base;          ///< Start of the mapping.
+  size_t length;       ///< Length of the mapping.
+  int *data;           ///< Matrix data (2 MB aligned inside the mapping).
+  const char *backing; ///< How the buffer is backed ("4K pages", "hugetlbfs", "THP").
+};
+
+/**
+ * @brief Allocates a contiguous buffer backed by small or huge pages.
+ *
+ * With huge pages, `MAP_HUGETLB` is tried first; it needs pages reserved in
+ * /proc/sys/vm/nr_hugepages, so when that fails the buffer falls back to a
+ * regular mapping aligned to 2 MB and marked with `MADV_HUGEPAGE`. Without
+ * huge pages the mapping is marked `MADV_NOHUGEPAGE`, so the kernel does
+ * not promote it behind our back and the comparison stays fair.
+ *
+ * @param buffer Buffer to initialize.
+ * @param bytes Number of bytes needed.
+ * @param huge Non-zero to request huge pages.
+ * @return 0 on success, -1 on failure.
+ */
+int page_buffer_alloc(struct page_buffer *buffer, size_t bytes, int huge)
+{
+  size_t length = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+#ifdef MAP_HUGETLB
+  if (huge)
+  {
+    void *mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping != MAP_FAILED)
+    {
+      buffer->base = mapping;
+      buffer->length = length;
+      buffer->data = mapping;
+      buffer->backing = "hugetlbfs";
+      return 0;
+    }
+  }
+#endif
+
+  // One extra huge page of slack to align the data on a 2 MB boundary.
+  size_t padded = length + HUGE_PAGE_SIZE;
+  void *mapping = mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED)
+    return -1;
+
+  uintptr_t aligned = ((uintptr_t)mapping + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+  buffer->base = mapping;
+  buffer->length = padded;
+  buffer->data = (int *)aligned;
+  buffer->backing = "4K pages";
+
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+  if (madvise((void *)aligned, length, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) == 0 && huge)
+    buffer->backing = "THP";
+#endif
+  return 0;
+}
+
+/**
+ * @brief Releases a buffer from page_buffer_alloc().
+ */
+void page_buffer_free(struct page_buffer *buffer)
+{
+  munmap(buffer->base, buffer->length);
+}
+
+/**
+ * @brief Returns how many bytes of a mapping are backed by huge pages.
+ *
+ * Sums the `AnonHugePages` (transparent huge pages), `Private_Hugetlb` and
+ * `Shared_Hugetlb` (`MAP_HUGETLB` pages) fields of the mapping in
+ * /proc/self/smaps, so the report shows whether the kernel actually gave
+ * us huge pages, whichever way they were requested.
+ *
+ * @param address Any address inside the mapping.
+ * @return Bytes in huge pages, or 0 if unknown.
+ */
+size_t huge_page_bytes(const void *address)
+{
+  FILE *smaps = fopen("/proc/self/smaps", "r");
+  if (!smaps)
+    return 0;
+
+  char line[256];
+  int inside = 0, found = 0;
+  size_t total_kb = 0, kb;
+  while (fgets(line, sizeof(line), smaps))
+  {
+    unsigned long start, end;
+    if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+    {
+      // The fields of our mapping are over once the next mapping starts.
+      if (found)
+        break;
+      inside = (uintptr_t)address >= start && (uintptr_t)address < end;
+      found = inside;
+    }
+    else if (inside && (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1 || sscanf(line, "Private_Hugetlb: %zu kB", &kb) == 1 ||
+                        sscanf(line, "Shared_Hugetlb: %zu kB", &kb) == 1))
+    {
+      total_kb += kb;
+    }
+  }
+  fclose(smaps);
+  return total_kb * 1024;
+}
+
+static bench_session session; ///< Every measurement of this run, written as CSV/JSON at the end.
+
+/**
+ * @struct kernel_call
+ * @brief Arguments of one timed run: `repetitions` calls of a kernel.
+ */
+struct kernel_call
+{
+  static_kernel func;
+  const int *matrix;
+  const int *vector;
+  int *result;
+  size_t size;
+  size_t repetitions;
+};
+
+static void run_kernel(void *arg)
+{
+  const struct kernel_call *call = arg;
+  for (size_t r = 0; r < call->repetitions; r++)
+    call->func(call->matrix, call->vector, call->result, call->size);
+}
+
+/**
+ * @brief Function to measure the execution time of a kernel.
+ *
+ * Small matrices are multiplied repeatedly in each timed run until
+ * MIN_MEASURED_ELEMENTS elements have been processed, and the median time
+ * per call is returned.
+ *
+ * @param kernel Kernel label.
+ * @param backing Page backing of the matrix, for the label.
+ * @param func Multiplication kernel.
+ * @param matrix Input matrix.
+ * @param vector Input vector.
+ * @param result Output vector.
+ * @param size Matrix and vector size.
+ * @return Execution time of one call in seconds.
+ */
+double measure_execution_time(const char *kernel, const char *backing, static_kernel func, const int *matrix, const int *vector,
+                              int *result, size_t size)
+{
+  struct kernel_call call = {func, matrix, vector, result, size, MIN_MEASURED_ELEMENTS / (size * size)};
+  if (call.repetitions == 0)
+    call.repetitions = 1;
+
+  // The recorded statistics are per timed run, so the label says how many calls one run makes.
+  char name[80];
+  snprintf(name, sizeof(name), "%s, %zu, %s, %zu calls/run", kernel, size, backing, call.repetitions);
+
+  return bench_session_run(&session, name, run_kernel, &call).median / call.repetitions;
+}
+
 /**
  * @brief Compares two vectors for equality.
  * @param vec1 First vector.
  * @param vec2 Second vector.
+ * @param size Number of elements.
  * @return 1 if vectors are equal, 0 otherwise.
  */
-int compare_vectors(int *vec1, int *vec2)
+int compare_vectors(const int *vec1, const int *vec2, size_t size)
 {
-  for (int i = 0; i < SIZE; i++)
+  for (size_t i = 0; i < size; i++)
   {
     if (vec1[i] != vec2[i])
     {
@@ -93,43 +363,195 @@ int compare_vectors(int *vec1, int *vec2)
   return 1;
 }
 
+/**
+ * @brief Deterministic element value in [0, 10) for a flat index (a multiplicative hash, so rows differ).
+ */
+static inline int fill_value(size_t index)
+{
+  return (int)((uint32_t)(index * 2654435761u) >> 16) % 10;
+}
+
+/**
+ * @brief Fills the matrix and the vector in parallel, with the row split of the OpenMP kernel.
+ *
+ * The first write to a page places it on the NUMA node of the writing
+ * thread. Filling with the same `schedule(static)` row split as
+ * matrix_vector_multiplication_row_parallel() puts each thread's rows on
+ * its own node; a serial fill would put the whole matrix on the master's.
+ * The values depend only on the index, so they are the same whatever the
+ * thread count.
+ */
+void fill_parallel(int *matrix, int *vector, size_t size)
+{
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < size; i++)
+  {
+    for (size_t j = 0; j < size; j++)
+    {
+      matrix[i * size + j] = fill_value(i * size + j);
+    }
+    vector[i] = fill_value(size * size + i);
+  }
+}
+
+/**
+ * @brief Runs every kernel for one size and page backing and prints a table row.
+ * @param size Matrix and vector size.
+ * @param variant Specialized kernels for this size, or NULL for a size without them.
+ * @param huge Non-zero to back the matrix with huge pages.
+ * @return 1 if all results match, 0 if they do not, -1 if the allocation failed.
+ */
+int run_size(size_t size, const struct static_variant *variant, int huge)
+{
+  struct page_buffer buffer;
+  int *vector = (int *)malloc(size * sizeof(int));
+  int *reference = (int *)malloc(size * sizeof(int));
+  int *result = (int *)malloc(size * sizeof(int));
+  if (!vector || !reference || !result || page_buffer_alloc(&buffer, size * size * sizeof(int), huge) != 0)
+  {
+    free(vector);
+    free(reference);
+    free(result);
+    return -1;
+  }
+
+  int *matrix = buffer.data;
+  fill_parallel(matrix, vector, size);
+
+  double time_row = measure_execution_time("row", buffer.backing, matrix_vector_multiplication_row, matrix, vector, reference, size);
+  double time_col = measure_execution_time("col", buffer.backing, matrix_vector_multiplication_col, matrix, vector, result, size);
+  int match = compare_vectors(reference, result, size);
+  double time_simd = measure_execution_time("row SIMD", buffer.backing, matrix_vector_multiplication_row_simd, matrix, vector, result, size);
+  match = match && compare_vectors(reference, result, size);
+  double time_parallel = measure_execution_time("row OMP", buffer.backing, matrix_vector_multiplication_row_parallel, matrix, vector, result, size);
+  match = match && compare_vectors(reference, result, size);
+
+  double time_row_static = 0.0, time_col_static = 0.0;
+  if (variant)
+  {
+    time_row_static = measure_execution_time("row specialized", buffer.backing, variant->row, matrix, vector, result, size);
+    match = match && compare_vectors(reference, result, size);
+    time_col_static = measure_execution_time("col specialized", buffer.backing, variant->col, matrix, vector, result, size);
+    match = match && compare_vectors(reference, result, size);
+  }
+
+  char huge_info[32];
+  snprintf(huge_info, sizeof(huge_info), "%s (%zu MB huge)", buffer.backing, huge_page_bytes(matrix) / (1024 * 1024));
+
+  printf("%5zu | %-22s | %10.6f | %10.6f | %10.6f | %10.6f | %10.6f | %10.6f | %s",
+         size, huge_info, time_row, time_col, time_simd, time_parallel, time_row_static, time_col_static, match ? "✅" : "❌");
+  if (variant)
+    printf(" specialized speedup: row %.2fx, col %.2fx\n", time_row / time_row_static, time_col / time_col_static);
+  else
+    printf(" (no specialized kernel)\n");
+
+  page_buffer_free(&buffer);
+  free(vector);
+  free(reference);
+  free(result);
+  return match;
+}
+
+/**
+ * @brief Prints the hardware counters of every measurement (with `--counters`).
+ *
+ * The dTLB misses of the 4K and huge-page rows show how much of the
+ * difference comes from page walks.
+ */
+void print_counters(void)
+{
+  if (!session.counters_open)
+  {
+    return;
+  }
+  printf("\n> 📊 Hardware counters (per run):\n");
+  for (size_t i = 0; i < session.count; i++)
+  {
+    char prefix[128];
+    snprintf(prefix, sizeof(prefix), "  - %s: ", session.results[i].name);
+    bench_print_counters(prefix, &session.results[i]);
+  }
+}
+
 /**
  * @brief Main function to initialize data and compare execution times.
+ *
+ * Without arguments, runs every size that has specialized kernels; with
+ * `--size N`, runs only that size (specialized kernels are used if N is
+ * one of STATIC_SIZES).
+ *
  * @return 0 on successful execution.
  */
-int main()
+int main(int argc, char *argv[])
 {
-  printf("\n💡 Matrix-vector multiplication with SIZE=%d.\n\n", SIZE);
-
-  // Definir a matriz como estática
-  int matrix[SIZE][SIZE];
-  int vector[SIZE];
-  int result_row[SIZE];
-  int result_col[SIZE];
+  size_t only_size = 0;
+  bench_config config = bench_default_config();
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+    {
+      only_size = (size_t)atol(argv[++i]);
+    }
+    else if (!bench_parse_arg(&config, argc, argv, &i))
+    {
+      printf("Usage: %s [--size N] %s\n", argv[0], bench_usage());
+      return 1;
+    }
+  }
+  matvec_simd_init();
+  // Opens the counters before the first parallel region so the OpenMP workers inherit them.
+  bench_session_init(&session, &config);
+  if (config.counters && !session.counters_open)
+  {
+    printf("> ⚠️ Hardware counters unavailable (%s), check /proc/sys/kernel/perf_event_paranoid\n",
+           strerror(session.counters.error));
+  }
 
-  srand(time(NULL));
+  printf("\n💡 Matrix-vector multiplication: specialized sizes vs runtime size, 4K vs huge pages.\n");
+  printf("> SIMD kernel: %s, threads: %d\n", matvec_isa_name(matvec_selected_isa()), omp_get_max_threads());
+  printf("> ⏱️ Median of %d runs after %d warmup runs, %s cache\n\n", config.repetitions, config.warmup,
+         config.cache == BENCH_COLD ? "cold" : "warm");
+  printf(" SIZE | Backing                |    Row (s) |    Col (s) |   SIMD (s) |    OMP (s) | Row N (s)  | Col N (s)  |\n");
+  printf("-----------------------------------------------------------------------------------------------------------------\n");
 
-  for (int i = 0; i < SIZE; i++)
+  int all_match = 1;
+  const size_t count = sizeof(variants) / sizeof(variants[0]);
+  for (size_t v = 0; v < (only_size ? 1 : count); v++)
   {
-    for (int j = 0; j < SIZE; j++)
+    size_t size = only_size ? only_size : variants[v].size;
+    const struct static_variant *variant = NULL;
+    for (size_t k = 0; k < count; k++)
     {
-      matrix[i][j] = rand() % 10;
+      if (variants[k].size == size)
+        variant = &variants[k];
+    }
+
+    for (int huge = 0; huge <= 1; huge++)
+    {
+      int status = run_size(size, variant, huge);
+      if (status < 0)
+      {
+        printf("> ❌ Memory allocation failed!\n");
+        return 1;
+      }
+      all_match = all_match && status;
     }
-    vector[i] = rand() % 10;
   }
 
-  double time_row = measure_execution_time(matrix_vector_multiplication_row, matrix, vector, result_row);
-  printf("- 🎯 Execution time (row-major): %f seconds\n", time_row);
-  double time_col = measure_execution_time(matrix_vector_multiplication_col, matrix, vector, result_col);
-  printf("- 🎯 Execution time (column-major): %f seconds\n\n", time_col);
+  print_counters();
+  if (bench_session_write(&session) != 0)
+  {
+    printf("> ❌ Could not write the benchmark report!\n");
+  }
+  bench_session_free(&session);
 
-  if (compare_vectors(result_row, result_col))
+  if (all_match)
   {
-    printf("> Results match! ✅\n\n");
+    printf("\n> Results match! ✅\n\n");
   }
   else
   {
-    printf("> Results do NOT match! ❌\n\n");
+    printf("\n> Results do NOT match! ❌\n\n");
   }
 
   return 0;
@@ -7,22 +7,105 @@
  * - Independent summations using multiple accumulators to break dependencies.
  *
  * The execution times of each method are compared under different optimization levels.
+ *
+ * Each summation is measured with the shared harness of common/bench.h:
+ * warmup runs, repeated timed runs and median/p95/stddev, optionally with
+ * a flushed last-level cache and CSV/JSON output (see bench_parse_arg()).
+ * With `--counters`, each summation also reports cycles, instructions,
+ * IPC, cache/TLB misses and branch misses per call (common/perf_counters.h),
+ * which shows whether more accumulators raise IPC or only move the
+ * bottleneck to memory.
+ *
+ * The hand-written sums above stay as the ILP illustration (they return an
+ * `int`, which overflows for this N). After them, the same array is summed
+ * with common/reduce.h: SIMD vectors x 1..16 accumulators, int64 result,
+ * serial and with one chunk per OpenMP thread. With `--float`, a float copy
+ * of the array compares plain, Kahan and pairwise summation.
+ *
+ * With `--input PATH`, the program sums a binary file of int32 values
+ * instead of the heap array, one chunk at a time (input_stream.h: `mmap`,
+ * or double-buffered `pread`, optionally with `O_DIRECT`), so files
+ * larger than RAM work. Opening the file and waiting for data are
+ * reported apart from the reduction itself. `--generate PATH COUNT`
+ * writes such a file with the same values as initialize_array(), and
+ * exits unless `--input` is also given.
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <string.h>
+
+#include "../common/bench.h"
+#include "../common/reduce.h"
+#include "input_stream.h"
 
 #define N 100000000 ///< Size of the array
 
 /**
  * @struct execution_result
- * @brief Stores execution time and result of summation functions.
+ * @brief Stores execution time, hardware counters and result of summation functions.
+ *
+ * Counters are the mean of one call; they are -1 when unavailable
+ * (no `--counters`, or perf_event_open denied).
  */
 struct execution_result
 {
-  double time; ///< Execution time in seconds
-  int result;  ///< Computed sum result
+  double time;          ///< Median execution time in seconds
+  int result;           ///< Computed sum result
+  bench_stats stats;    ///< Statistics of all timed runs
+  double cycles;        ///< Core cycles
+  double instructions;  ///< Retired instructions
+  double ipc;           ///< Instructions per cycle
+  double l1d_misses;    ///< L1 data cache read misses
+  double llc_misses;    ///< Last-level cache misses
+  double dtlb_misses;   ///< Data TLB read misses
+  double branch_misses; ///< Mispredicted branches
+};
+
+/**
+ * @struct sum_call
+ * @brief Arguments and result of one summation call, as passed through bench_run().
+ */
+struct sum_call
+{
+  int (*func)(int *); ///< Summation function
+  int *arr;           ///< Input array
+  int result;         ///< Result of the last call
+};
+
+/**
+ * @struct reduce_call
+ * @brief Arguments and result of one common/reduce.h call, as passed through bench_run().
+ */
+struct reduce_call
+{
+  reduce_i32_fn func;   ///< int32 kernel
+  reduce_f32_fn f32;    ///< float kernel (used when arr is NULL)
+  const int32_t *arr;   ///< int32 input, or NULL
+  const float *farr;    ///< float input
+  int parallel;         ///< Non-zero to split the array across OpenMP threads
+  int64_t result;       ///< int32 sum of the last call
+  float fresult;        ///< float sum of the last call
+};
+
+/**
+ * @struct stream_call
+ * @brief Settings and timings of one pass over an input file, as passed through bench_run().
+ */
+struct stream_call
+{
+  const char *path;   ///< Input file
+  input_mode mode;    ///< Requested input mode
+  size_t chunk;       ///< Chunk size in bytes
+  reduce_i32_fn func; ///< Kernel applied to each chunk
+  input_mode used;    ///< Mode actually used (O_DIRECT may fall back to read)
+  int64_t result;     ///< Sum of the last pass
+  size_t bytes;       ///< Bytes summed by the last pass
+  double init;        ///< Seconds spent opening (and mapping) the file
+  double reduce;      ///< Seconds spent in the kernel
+  double wait;        ///< Seconds spent waiting for the reader thread
+  int error;          ///< errno of the last failure, 0 if none
 };
 
 /**
@@ -60,11 +143,14 @@ int sum_dependent(int *arr)
 int sum_independent_2(int *arr)
 {
   int sum1 = 0, sum2 = 0;
-  for (int i = 0; i < N; i += 2)
+  int i = 0;
+  for (; i + 1 < N; i += 2)
   {
     sum1 += arr[i];
     sum2 += arr[i + 1];
   }
+  for (; i < N; i++) // remainder when N is not a multiple of 2
+    sum1 += arr[i];
   return sum1 + sum2;
 }
 
@@ -76,13 +162,16 @@ int sum_independent_2(int *arr)
 int sum_independent_4(int *arr)
 {
   int sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
-  for (int i = 0; i < N; i += 4)
+  int i = 0;
+  for (; i + 3 < N; i += 4)
   {
     sum1 += arr[i];
     sum2 += arr[i + 1];
     sum3 += arr[i + 2];
     sum4 += arr[i + 3];
   }
+  for (; i < N; i++) // remainder when N is not a multiple of 4
+    sum1 += arr[i];
   return sum1 + sum2 + sum3 + sum4;
 }
 
@@ -94,7 +183,8 @@ int sum_independent_4(int *arr)
 int sum_independent_8(int *arr)
 {
   int sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0, sum5 = 0, sum6 = 0, sum7 = 0, sum8 = 0;
-  for (int i = 0; i < N; i += 8)
+  int i = 0;
+  for (; i + 7 < N; i += 8)
   {
     sum1 += arr[i];
     sum2 += arr[i + 1];
@@ -105,32 +195,364 @@ int sum_independent_8(int *arr)
     sum7 += arr[i + 6];
     sum8 += arr[i + 7];
   }
+  for (; i < N; i++) // remainder when N is not a multiple of 8
+    sum1 += arr[i];
   return sum1 + sum2 + sum3 + sum4 + sum5 + sum6 + sum7 + sum8;
 }
 
+/**
+ * @brief Calls the summation function of a sum_call and stores its result.
+ * @param arg Pointer to a struct sum_call.
+ */
+void run_sum(void *arg)
+{
+  struct sum_call *call = arg;
+  call->result = call->func(call->arr);
+}
+
+/**
+ * @brief Calls the kernel of a reduce_call and stores its result.
+ * @param arg Pointer to a struct reduce_call.
+ */
+void run_reduce(void *arg)
+{
+  struct reduce_call *call = arg;
+  if (call->arr && call->parallel)
+    call->result = reduce_sum_i32_parallel(call->func, call->arr, N);
+  else if (call->arr)
+    call->result = call->func(call->arr, N);
+  else if (call->parallel)
+    call->fresult = reduce_sum_f32_parallel(call->f32, call->farr, N);
+  else
+    call->fresult = call->f32(call->farr, N);
+}
+
+/**
+ * @brief Sums an input file chunk by chunk and records where the time went.
+ * @param arg Pointer to a struct stream_call.
+ */
+void run_stream(void *arg)
+{
+  struct stream_call *call = arg;
+  input_stream stream;
+  call->result = 0;
+  call->bytes = 0;
+  call->reduce = 0.0;
+
+  double start = bench_now(BENCH_CLOCK_RAW);
+  if (input_stream_open(&stream, call->path, call->mode, call->chunk) != 0)
+  {
+    call->error = errno;
+    return;
+  }
+  call->init = bench_now(BENCH_CLOCK_RAW) - start;
+  call->used = stream.mode;
+
+  const void *data;
+  size_t bytes;
+  while ((data = input_stream_next(&stream, &bytes)) != NULL)
+  {
+    // Chunks are multiples of 4 KB, so only a truncated last value can be dropped.
+    start = bench_now(BENCH_CLOCK_RAW);
+    call->result += call->func((const int32_t *)data, bytes / sizeof(int32_t));
+    call->reduce += bench_now(BENCH_CLOCK_RAW) - start;
+    call->bytes += bytes - bytes % sizeof(int32_t);
+  }
+  call->wait = stream.wait;
+  call->error = stream.error;
+  input_stream_close(&stream);
+}
+
+/**
+ * @brief Writes a binary file of COUNT int32 values with the contents of initialize_array().
+ * @return 0 on success, -1 on failure (errno is set).
+ */
+int generate_input(const char *path, size_t count)
+{
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return -1;
+  enum { BLOCK = 1 << 20 };
+  int32_t *block = (int32_t *)malloc(BLOCK * sizeof(int32_t));
+  if (!block)
+  {
+    fclose(file);
+    errno = ENOMEM;
+    return -1;
+  }
+  int status = 0;
+  for (size_t i = 0; i < count && status == 0; i += BLOCK)
+  {
+    const size_t n = count - i < BLOCK ? count - i : BLOCK;
+    for (size_t j = 0; j < n; j++)
+      block[j] = (int32_t)(i + j + 2);
+    if (fwrite(block, sizeof(int32_t), n, file) != n)
+      status = -1;
+  }
+  free(block);
+  if (fclose(file) != 0)
+    status = -1;
+  return status;
+}
+
+/**
+ * @brief Returns a counter of a measurement, or -1 if it was not measured.
+ */
+double counter_value(const bench_stats *stats, perf_counter counter)
+{
+  return perf_values_has(&stats->counters, counter) ? stats->counters.values[counter] : -1.0;
+}
+
+/**
+ * @brief Measures a function with the session settings and collects its counters.
+ * @param session Benchmark session that records the measurement.
+ * @param name Label of the measurement.
+ * @param fn Function to measure.
+ * @param arg Argument passed to fn.
+ * @return A struct containing the median execution time, its statistics and counters (result is 0).
+ */
+struct execution_result measure_time(bench_session *session, const char *name, bench_fn fn, void *arg)
+{
+  struct execution_result result;
+  result.stats = bench_session_run(session, name, fn, arg);
+  result.time = result.stats.median;
+  result.result = 0;
+  result.cycles = counter_value(&result.stats, PERF_CYCLES);
+  result.instructions = counter_value(&result.stats, PERF_INSTRUCTIONS);
+  result.ipc = result.cycles > 0.0 && result.instructions >= 0.0 ? result.instructions / result.cycles : -1.0;
+  result.l1d_misses = counter_value(&result.stats, PERF_L1D_MISSES);
+  result.llc_misses = counter_value(&result.stats, PERF_LLC_MISSES);
+  result.dtlb_misses = counter_value(&result.stats, PERF_DTLB_MISSES);
+  result.branch_misses = counter_value(&result.stats, PERF_BRANCH_MISSES);
+  return result;
+}
+
 /**
  * @brief Measures the execution time of a summation function.
+ * @param session Benchmark session that records the measurement.
+ * @param name Label of the measurement.
  * @param func Pointer to the summation function.
  * @param arr Pointer to the integer array.
- * @return A struct containing the execution time and computed sum.
+ * @return A struct containing the median execution time, its statistics, counters and the computed sum.
  */
-struct execution_result measure_sum_time(int (*func)(int *), int *arr)
+struct execution_result measure_sum_time(bench_session *session, const char *name, int (*func)(int *), int *arr)
 {
-  struct timeval start, end;
-  struct execution_result result;
-  gettimeofday(&start, NULL);
-  result.result = func(arr);
-  gettimeofday(&end, NULL);
-  result.time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+  struct sum_call call = {func, arr, 0};
+  struct execution_result result = measure_time(session, name, run_sum, &call);
+  result.result = call.result;
   return result;
 }
 
+/**
+ * @brief Sums an input file with the default reduction kernel and prints the time breakdown.
+ *
+ * The total is the median over the session runs; the initialization,
+ * reduction and I/O wait times are those of the last run, and are labeled so.
+ *
+ * @param session Benchmark session that records the measurement.
+ * @param call Input file and mode; filled with the timings of the last pass.
+ * @return 0 on success, -1 if the file could not be read.
+ */
+int run_input(bench_session *session, struct stream_call *call)
+{
+  char name[64];
+  snprintf(name, sizeof(name), "stream_%s", input_mode_name(call->mode));
+  struct execution_result result = measure_time(session, name, run_stream, call);
+  if (call->error)
+  {
+    printf("Could not read %s: %s\n", call->path, strerror(call->error));
+    return -1;
+  }
+
+  const double gb = call->bytes / 1e9;
+  printf("Input: %s, %.3f GB, mode %s%s, chunks of %zu KB\n", call->path, gb, input_mode_name(call->used),
+         call->used != call->mode ? " (O_DIRECT rejected by the filesystem)" : "", call->chunk / 1024);
+  printf("Initialization time (last run): %.6f seconds (open%s)\n", call->init, call->used == INPUT_MMAP ? " + mmap" : " + reader thread");
+  printf("Time (stream, total): %.6f seconds (p95 %.6f, stddev %.6f, %d runs), %.2f GB/s\n", result.time,
+         result.stats.p95, result.stats.stddev, result.stats.repetitions, result.time > 0.0 ? gb / result.time : 0.0);
+  printf("Time (reduction only, last run): %.6f seconds, %.2f GB/s%s\n", call->reduce, call->reduce > 0.0 ? gb / call->reduce : 0.0,
+         call->used == INPUT_MMAP ? " (includes page faults)" : "");
+  if (call->used != INPUT_MMAP)
+    printf("Time (waiting for I/O, last run): %.6f seconds\n", call->wait);
+  printf("Result: %lld\n", (long long)call->result);
+  return 0;
+}
+
+/**
+ * @brief Prints one measurement.
+ * @param label Description of the summation.
+ * @param result Measurement to print.
+ */
+void print_result(const char *label, const struct execution_result *result)
+{
+  printf("Time (%s): %.6f seconds (p95 %.6f, stddev %.6f, %d runs), Result: %d\n", label, result->time,
+         result->stats.p95, result->stats.stddev, result->stats.repetitions, result->result);
+}
+
+/**
+ * @brief Prints one counter value, or "n/a" if it was not measured.
+ */
+void print_counter(const char *name, double value)
+{
+  if (value < 0.0)
+    printf("  %s n/a", name);
+  else
+    printf("  %s %.0f", name, value);
+}
+
+/**
+ * @brief Prints the hardware counters of one measurement (per call).
+ * @param result Measurement to print.
+ */
+void print_counters(const struct execution_result *result)
+{
+  if (result->ipc < 0.0)
+    printf("  IPC n/a");
+  else
+    printf("  IPC %.2f", result->ipc);
+  print_counter("cycles", result->cycles);
+  print_counter("instructions", result->instructions);
+  print_counter("L1D misses", result->l1d_misses);
+  print_counter("LLC misses", result->llc_misses);
+  print_counter("dTLB misses", result->dtlb_misses);
+  print_counter("branch misses", result->branch_misses);
+  printf("\n");
+}
+
+/**
+ * @brief Sums the array with the common/reduce.h int32 kernels and checks the int64 result.
+ *
+ * arr[i] = i + 2, so the exact sum is N (N - 1) / 2 + 2 N.
+ *
+ * @param session Benchmark session that records the measurements.
+ * @param arr Array filled by initialize_array().
+ * @param counters Non-zero to print the hardware counters.
+ * @return 1 if every kernel returned the exact sum, 0 otherwise.
+ */
+int run_reduce_sweep(bench_session *session, const int32_t *arr, int counters)
+{
+  const int64_t expected = (int64_t)N * (N - 1) / 2 + 2 * (int64_t)N;
+  const int lanes = REDUCE_VECTOR_BYTES / (int)sizeof(int64_t);
+  const int accumulators[] = {1, 2, 4, 8, 16};
+  int all_correct = 1;
+
+  printf("\nReduction library (int64 sum of %d-lane vectors, exact sum %lld):\n", lanes, (long long)expected);
+  for (size_t a = 0; a <= sizeof(accumulators) / sizeof(accumulators[0]); a++)
+  {
+    // The last entry is the default kernel split across the OpenMP threads.
+    const int parallel = a == sizeof(accumulators) / sizeof(accumulators[0]);
+    const int k = parallel ? REDUCE_DEFAULT_ACCUMULATORS : accumulators[a];
+    struct reduce_call call = {reduce_sum_i32_for(k), NULL, arr, NULL, parallel, 0, 0.0f};
+
+    char name[64], label[96];
+    snprintf(name, sizeof(name), "reduce_%d%s", k, parallel ? "_parallel" : "");
+    snprintf(label, sizeof(label), "reduce - %d x %d lanes%s", k, lanes, parallel ? ", all threads" : "");
+    struct execution_result result = measure_time(session, name, run_reduce, &call);
+    printf("Time (%s): %.6f seconds (p95 %.6f, stddev %.6f, %d runs), Result: %lld %s\n", label, result.time,
+           result.stats.p95, result.stats.stddev, result.stats.repetitions, (long long)call.result,
+           call.result == expected ? "(exact)" : "(WRONG)");
+    if (counters)
+      print_counters(&result);
+    all_correct = all_correct && call.result == expected;
+  }
+  return all_correct;
+}
+
+/**
+ * @brief Sums a float copy of the array with plain, Kahan and pairwise summation.
+ *
+ * The values are integers below 2^27, so their double sum is exact and
+ * serves as reference for the relative error of each float method.
+ *
+ * @param session Benchmark session that records the measurements.
+ * @param arr Array filled by initialize_array().
+ * @return 0 on success, -1 if the float copy could not be allocated.
+ */
+int run_float_sweep(bench_session *session, const int32_t *arr)
+{
+  float *farr = (float *)malloc(N * sizeof(float));
+  if (!farr)
+    return -1;
+  double exact = 0.0;
+  for (int i = 0; i < N; i++)
+  {
+    farr[i] = (float)arr[i];
+    exact += farr[i];
+  }
+
+  printf("\nFloat summation (%d accumulators, exact sum %.0f):\n", REDUCE_DEFAULT_ACCUMULATORS, exact);
+  for (int m = 0; m < REDUCE_METHOD_COUNT; m++)
+  {
+    struct reduce_call call = {NULL, reduce_sum_f32_for((reduce_method)m, REDUCE_DEFAULT_ACCUMULATORS), NULL, farr, 0, 0, 0.0f};
+    char name[64];
+    snprintf(name, sizeof(name), "float_%s", reduce_method_name((reduce_method)m));
+    struct execution_result result = measure_time(session, name, run_reduce, &call);
+    printf("Time (float %s): %.6f seconds (p95 %.6f, stddev %.6f, %d runs), Result: %.0f, relative error %.2e\n",
+           reduce_method_name((reduce_method)m), result.time, result.stats.p95, result.stats.stddev,
+           result.stats.repetitions, call.fresult, (call.fresult - exact) / exact);
+  }
+  free(farr);
+  return 0;
+}
+
 /**
  * @brief Main function to execute benchmarks and display results.
  * @return Exit status.
  */
-int main()
+int main(int argc, char *argv[])
 {
+  bench_config config = bench_default_config();
+  int float_sweep = 0, generated = 0;
+  struct stream_call input = {NULL, INPUT_MMAP, INPUT_DEFAULT_CHUNK, NULL, INPUT_MMAP, 0, 0, 0.0, 0.0, 0.0, 0};
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--float") == 0)
+      float_sweep = 1;
+    else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc)
+      input.path = argv[++i];
+    else if (strcmp(argv[i], "--input-mode") == 0 && i + 1 < argc && input_parse_mode(argv[i + 1], &input.mode) == 0)
+      i++;
+    else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+      input.chunk = (size_t)atol(argv[++i]) * 1024 * 1024;
+    else if (strcmp(argv[i], "--generate") == 0 && i + 2 < argc && atoll(argv[i + 2]) > 0)
+    {
+      const size_t count = (size_t)atoll(argv[i + 2]);
+      if (generate_input(argv[i + 1], count) != 0)
+      {
+        printf("Could not write %s: %s\n", argv[i + 1], strerror(errno));
+        return 1;
+      }
+      printf("Generated %s: %zu values, exact sum %lld\n", argv[i + 1], count,
+             (long long)((int64_t)count * (count - 1) / 2 + 2 * (int64_t)count));
+      generated = 1;
+      i += 2;
+    }
+    else if (!bench_parse_arg(&config, argc, argv, &i))
+    {
+      printf("Usage: %s [--float] [--generate PATH COUNT] [--input PATH [--input-mode mmap|read|direct] [--chunk MB]] %s\n",
+             argv[0], bench_usage());
+      return 1;
+    }
+  }
+
+  // --generate alone only writes the file; with --input it is summed next.
+  if (generated && !input.path)
+    return 0;
+
+  if (input.path)
+  {
+    bench_session session;
+    bench_session_init(&session, &config);
+    printf("Median of %d runs after %d warmup runs (warmup runs also fill the page cache)\n\n", config.repetitions,
+           config.warmup);
+    input.func = reduce_sum_i32_for(REDUCE_DEFAULT_ACCUMULATORS);
+    int status = run_input(&session, &input);
+    if (status == 0 && bench_session_write(&session) != 0)
+      printf("Could not write the benchmark report!\n");
+    bench_session_free(&session);
+    return status == 0 ? 0 : 1;
+  }
+
   int *arr = (int *)malloc(N * sizeof(int));
   if (!arr)
   {
@@ -138,30 +560,54 @@ int main()
     return 1;
   }
 
-  struct timeval start, end;
-  gettimeofday(&start, NULL);
+  double start = bench_now(BENCH_CLOCK_RAW);
   initialize_array(arr);
-  gettimeofday(&end, NULL);
-  double init_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+  double init_time = bench_now(BENCH_CLOCK_RAW) - start;
   printf("Initialization time: %.6f seconds\n", init_time);
+  printf("Median of %d runs after %d warmup runs, %s cache\n\n", config.repetitions, config.warmup,
+         config.cache == BENCH_COLD ? "cold" : "warm");
+
+  bench_session session;
+  bench_session_init(&session, &config);
+  if (config.counters && !session.counters_open)
+    printf("Hardware counters unavailable (%s); check /proc/sys/kernel/perf_event_paranoid\n\n",
+           strerror(session.counters.error));
 
-  struct execution_result dep_result = measure_sum_time(sum_dependent, arr);
-  printf("Time (dependent): %.6f seconds, Result: %d\n", dep_result.time, dep_result.result);
+  struct execution_result dep_result = measure_sum_time(&session, "dependent", sum_dependent, arr);
+  print_result("dependent", &dep_result);
+  if (config.counters)
+    print_counters(&dep_result);
 
-  struct execution_result indep_result_2 = measure_sum_time(sum_independent_2, arr);
-  printf("Time (independent - 2 accumulators): %.6f seconds, Result: %d\n", indep_result_2.time, indep_result_2.result);
+  struct execution_result indep_result_2 = measure_sum_time(&session, "independent_2", sum_independent_2, arr);
+  print_result("independent - 2 accumulators", &indep_result_2);
+  if (config.counters)
+    print_counters(&indep_result_2);
 
-  struct execution_result indep_result_4 = measure_sum_time(sum_independent_4, arr);
-  printf("Time (independent - 4 accumulators): %.6f seconds, Result: %d\n", indep_result_4.time, indep_result_4.result);
+  struct execution_result indep_result_4 = measure_sum_time(&session, "independent_4", sum_independent_4, arr);
+  print_result("independent - 4 accumulators", &indep_result_4);
+  if (config.counters)
+    print_counters(&indep_result_4);
 
-  struct execution_result indep_result_8 = measure_sum_time(sum_independent_8, arr);
-  printf("Time (independent - 8 accumulators): %.6f seconds, Result: %d\n", indep_result_8.time, indep_result_8.result);
+  struct execution_result indep_result_8 = measure_sum_time(&session, "independent_8", sum_independent_8, arr);
+  print_result("independent - 8 accumulators", &indep_result_8);
+  if (config.counters)
+    print_counters(&indep_result_8);
 
   int is_correct = dep_result.result == indep_result_2.result &&
                    dep_result.result == indep_result_4.result &&
                    dep_result.result == indep_result_8.result;
   printf("\nConsistent results for all versions: %s\n", is_correct ? "Yes" : "No");
 
+  int reduce_correct = run_reduce_sweep(&session, arr, config.counters);
+  printf("\nExact results for all reduction kernels: %s\n", reduce_correct ? "Yes" : "No");
+
+  if (float_sweep && run_float_sweep(&session, arr) != 0)
+    printf("Memory allocation error!\n");
+
+  if (bench_session_write(&session) != 0)
+    printf("Could not write the benchmark report!\n");
+
+  bench_session_free(&session);
   free(arr);
   return 0;
 }
@@ -0,0 +1,300 @@
+/**
+ * @file input_stream.c
+ * @brief Chunked input of a binary file: memory-mapped or double-buffered reads.
+ */
+
+#define _GNU_SOURCE
+#include "input_stream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char *mode_names[] = {"mmap", "read", "direct"}; ///< Names of input_mode values.
+
+/**
+ * @brief Reads CLOCK_MONOTONIC in seconds.
+ */
+static double now_seconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Reads up to `bytes` bytes at `offset`, retrying short reads until the end of the file.
+ * @return Bytes read, or -1 on error.
+ */
+static ssize_t read_full(int fd, char *buffer, size_t bytes, size_t offset)
+{
+  size_t done = 0;
+  while (done < bytes)
+  {
+    ssize_t r = pread(fd, buffer + done, bytes - done, (off_t)(offset + done));
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r < 0)
+      return -1;
+    if (r == 0)
+      break;
+    done += (size_t)r;
+  }
+  return (ssize_t)done;
+}
+
+/**
+ * @brief Reader thread: fills the two buffers alternately until the end of the file.
+ *
+ * A buffer is refilled only after the caller released it. The last buffer
+ * delivered has 0 bytes and marks the end of the file (or a read error).
+ */
+static void *reader_main(void *arg)
+{
+  input_stream *stream = arg;
+  size_t offset = 0;
+  int b = 0;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&stream->lock);
+    while (stream->ready[b] && !stream->stop)
+      pthread_cond_wait(&stream->changed, &stream->lock);
+    const int stop = stream->stop;
+    pthread_mutex_unlock(&stream->lock);
+    if (stop)
+      break;
+
+    const size_t want = offset < stream->size ? stream->size - offset : 0;
+    size_t bytes = want < stream->chunk ? want : stream->chunk;
+    int error = 0;
+    if (bytes > 0)
+    {
+      // O_DIRECT transfers whole blocks; the read stops at the end of the file anyway.
+      size_t request = stream->mode == INPUT_DIRECT
+                           ? (bytes + INPUT_DIRECT_ALIGNMENT - 1) / INPUT_DIRECT_ALIGNMENT * INPUT_DIRECT_ALIGNMENT
+                           : bytes;
+      ssize_t got = read_full(stream->fd, stream->buffers[b], request, offset);
+      if (got < 0)
+      {
+        error = errno;
+        bytes = 0;
+      }
+      else
+      {
+        bytes = (size_t)got < bytes ? (size_t)got : bytes;
+      }
+      // Start loading the chunk after the next one while the caller works.
+      if (stream->mode == INPUT_READ && offset + 2 * stream->chunk < stream->size)
+        posix_fadvise(stream->fd, (off_t)(offset + 2 * stream->chunk), (off_t)stream->chunk, POSIX_FADV_WILLNEED);
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    stream->filled[b] = bytes;
+    stream->ready[b] = 1;
+    if (error && !stream->error)
+      stream->error = error;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+
+    if (bytes == 0)
+      break;
+    offset += bytes;
+    b ^= 1;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Reads the first block with O_DIRECT; if the filesystem rejects it, reopens the file without O_DIRECT.
+ *
+ * Some filesystems accept O_DIRECT in open() and only fail the reads with
+ * EINVAL, so the fallback of input_stream_open() cannot rely on open()
+ * alone. The reader thread reads the file from the start either way.
+ *
+ * @return 0 on success, -1 on failure (errno is set).
+ */
+static int probe_direct(input_stream *stream, const char *path)
+{
+  if (stream->size == 0 || read_full(stream->fd, stream->buffers[0], INPUT_DIRECT_ALIGNMENT, 0) >= 0)
+    return 0;
+  if (errno != EINVAL)
+    return -1;
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return -1;
+  close(stream->fd);
+  stream->fd = fd;
+  stream->mode = INPUT_READ;
+  return 0;
+}
+
+int input_stream_open(input_stream *stream, const char *path, input_mode mode, size_t chunk)
+{
+  memset(stream, 0, sizeof(*stream));
+  stream->current = -1;
+  stream->mode = mode;
+  stream->chunk = chunk ? (chunk + INPUT_DIRECT_ALIGNMENT - 1) / INPUT_DIRECT_ALIGNMENT * INPUT_DIRECT_ALIGNMENT
+                        : INPUT_DEFAULT_CHUNK;
+
+  stream->fd = open(path, O_RDONLY | (mode == INPUT_DIRECT ? O_DIRECT : 0));
+  if (stream->fd < 0 && mode == INPUT_DIRECT && errno == EINVAL)
+  {
+    stream->mode = INPUT_READ;
+    stream->fd = open(path, O_RDONLY);
+  }
+  if (stream->fd < 0)
+    return -1;
+
+  struct stat info;
+  if (fstat(stream->fd, &info) != 0)
+  {
+    close(stream->fd);
+    return -1;
+  }
+  stream->size = (size_t)info.st_size;
+
+  if (stream->mode == INPUT_MMAP)
+  {
+    if (stream->size > 0)
+    {
+      stream->map = mmap(NULL, stream->size, PROT_READ, MAP_PRIVATE, stream->fd, 0);
+      if (stream->map == MAP_FAILED)
+      {
+        stream->map = NULL;
+        close(stream->fd);
+        return -1;
+      }
+      madvise(stream->map, stream->size, MADV_SEQUENTIAL);
+    }
+    return 0;
+  }
+
+  for (int b = 0; b < 2; b++)
+  {
+    stream->buffers[b] = aligned_alloc(INPUT_DIRECT_ALIGNMENT, stream->chunk);
+    if (!stream->buffers[b])
+    {
+      input_stream_close(stream);
+      errno = ENOMEM;
+      return -1;
+    }
+  }
+  if (stream->mode == INPUT_DIRECT && probe_direct(stream, path) != 0)
+  {
+    const int saved = errno;
+    input_stream_close(stream);
+    errno = saved;
+    return -1;
+  }
+  if (stream->mode == INPUT_READ)
+    posix_fadvise(stream->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  pthread_mutex_init(&stream->lock, NULL);
+  pthread_cond_init(&stream->changed, NULL);
+  if (pthread_create(&stream->reader, NULL, reader_main, stream) != 0)
+  {
+    pthread_cond_destroy(&stream->changed);
+    pthread_mutex_destroy(&stream->lock);
+    input_stream_close(stream);
+    errno = EAGAIN;
+    return -1;
+  }
+  stream->reader_started = 1;
+  return 0;
+}
+
+const void *input_stream_next(input_stream *stream, size_t *bytes)
+{
+  *bytes = 0;
+  if (stream->mode == INPUT_MMAP)
+  {
+    if (stream->offset >= stream->size)
+      return NULL;
+    const size_t left = stream->size - stream->offset;
+    const char *data = (const char *)stream->map + stream->offset;
+    *bytes = left < stream->chunk ? left : stream->chunk;
+    stream->offset += *bytes;
+    // The kernel starts reading the next chunk while this one is summed.
+    if (stream->offset < stream->size)
+    {
+      const size_t ahead = stream->size - stream->offset;
+      madvise((char *)stream->map + stream->offset, ahead < stream->chunk ? ahead : stream->chunk, MADV_WILLNEED);
+    }
+    return data;
+  }
+
+  pthread_mutex_lock(&stream->lock);
+  if (stream->current >= 0)
+  {
+    stream->ready[stream->current] = 0;
+    stream->current = -1;
+    pthread_cond_broadcast(&stream->changed);
+  }
+  const double start = now_seconds();
+  while (!stream->ready[stream->next])
+    pthread_cond_wait(&stream->changed, &stream->lock);
+  stream->wait += now_seconds() - start;
+
+  const int b = stream->next;
+  // The end marker stays ready, so later calls return NULL too.
+  if (stream->filled[b] == 0)
+  {
+    pthread_mutex_unlock(&stream->lock);
+    return NULL;
+  }
+  stream->current = b;
+  stream->next = b ^ 1;
+  *bytes = stream->filled[b];
+  stream->offset += *bytes;
+  pthread_mutex_unlock(&stream->lock);
+  return stream->buffers[b];
+}
+
+void input_stream_close(input_stream *stream)
+{
+  if (stream->reader_started)
+  {
+    pthread_mutex_lock(&stream->lock);
+    stream->stop = 1;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+    pthread_join(stream->reader, NULL);
+    pthread_cond_destroy(&stream->changed);
+    pthread_mutex_destroy(&stream->lock);
+    stream->reader_started = 0;
+  }
+  for (int b = 0; b < 2; b++)
+  {
+    free(stream->buffers[b]);
+    stream->buffers[b] = NULL;
+  }
+  if (stream->map)
+    munmap(stream->map, stream->size);
+  stream->map = NULL;
+  if (stream->fd >= 0)
+    close(stream->fd);
+  stream->fd = -1;
+}
+
+int input_parse_mode(const char *name, input_mode *mode)
+{
+  for (int m = 0; m < (int)(sizeof(mode_names) / sizeof(mode_names[0])); m++)
+  {
+    if (strcmp(name, mode_names[m]) == 0)
+    {
+      *mode = (input_mode)m;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+const char *input_mode_name(input_mode mode)
+{
+  return (size_t)mode < sizeof(mode_names) / sizeof(mode_names[0]) ? mode_names[mode] : "unknown";
+}
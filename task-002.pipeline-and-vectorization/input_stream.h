@@ -0,0 +1,110 @@
+/**
+ * @file input_stream.h
+ * @brief Chunked input of a binary file: memory-mapped or double-buffered reads.
+ *
+ * Lets ilp_benchmark reduce files larger than RAM instead of a heap array.
+ * The file is handed to the caller one chunk at a time
+ * (input_stream_next()), in one of three modes:
+ *
+ * - INPUT_MMAP: the file is mapped with `MADV_SEQUENTIAL`, and the chunk
+ *   after the current one gets `MADV_WILLNEED`, so the kernel reads ahead
+ *   while the current chunk is summed. No copy is made.
+ * - INPUT_READ: a reader thread fills two buffers alternately with
+ *   `pread` (file opened with `POSIX_FADV_SEQUENTIAL`), so the next chunk
+ *   loads while the caller sums the current one.
+ * - INPUT_DIRECT: same as INPUT_READ, with `O_DIRECT`, bypassing the page
+ *   cache. Buffers and chunk sizes are aligned to INPUT_DIRECT_ALIGNMENT.
+ *   If the filesystem rejects `O_DIRECT` (e.g. tmpfs), in open() or in
+ *   the first read, the stream falls back to INPUT_READ and reports it in
+ *   `mode`.
+ *
+ * The stream also accounts the time the caller spent waiting for data, so
+ * I/O stalls can be told apart from reduction time.
+ */
+
+#ifndef INPUT_STREAM_H
+#define INPUT_STREAM_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+#define INPUT_DIRECT_ALIGNMENT 4096          ///< Buffer, offset and size alignment of O_DIRECT reads.
+#define INPUT_DEFAULT_CHUNK (64 * 1024 * 1024) ///< Default chunk size in bytes.
+
+/**
+ * @enum input_mode
+ * @brief How the file is brought into memory.
+ */
+typedef enum
+{
+  INPUT_MMAP,   ///< Memory-mapped, with read-ahead hints.
+  INPUT_READ,   ///< Double-buffered pread through the page cache.
+  INPUT_DIRECT  ///< Double-buffered pread with O_DIRECT.
+} input_mode;
+
+/**
+ * @struct input_stream
+ * @brief Open file and the state of its chunked reading.
+ */
+typedef struct
+{
+  int fd;            ///< File descriptor.
+  input_mode mode;   ///< Mode in use (INPUT_READ if O_DIRECT was rejected).
+  size_t size;       ///< File size in bytes.
+  size_t chunk;      ///< Chunk size in bytes.
+  size_t offset;     ///< Offset of the next chunk handed to the caller.
+  double wait;       ///< Seconds the caller spent waiting in input_stream_next().
+  int error;         ///< errno of the first read error, 0 if none.
+
+  void *map;         ///< File mapping (INPUT_MMAP).
+
+  void *buffers[2];       ///< Chunk buffers (INPUT_READ, INPUT_DIRECT).
+  size_t filled[2];       ///< Valid bytes in each buffer.
+  int ready[2];           ///< 1 when a buffer holds a chunk not yet handed out.
+  int current;            ///< Buffer handed to the caller, -1 if none.
+  int next;               ///< Buffer the caller gets next.
+  int stop;               ///< Set to make the reader thread exit.
+  int reader_started;     ///< 1 if the reader thread is running.
+  pthread_t reader;       ///< Reader thread.
+  pthread_mutex_t lock;   ///< Protects filled, ready and stop.
+  pthread_cond_t changed; ///< Signaled when a buffer is filled or released.
+} input_stream;
+
+/**
+ * @brief Opens a file for chunked reading.
+ * @param stream Stream to initialize.
+ * @param path File to read.
+ * @param mode Requested mode.
+ * @param chunk Chunk size in bytes (rounded up to INPUT_DIRECT_ALIGNMENT).
+ * @return 0 on success, -1 on failure (errno is set).
+ */
+int input_stream_open(input_stream *stream, const char *path, input_mode mode, size_t chunk);
+
+/**
+ * @brief Returns the next chunk, waiting for it to load if needed.
+ *
+ * The previous chunk is released: its memory must not be used anymore.
+ *
+ * @param stream Open stream.
+ * @param bytes Number of valid bytes in the chunk.
+ * @return Chunk data, or NULL at the end of the file or on a read error (see `error`).
+ */
+const void *input_stream_next(input_stream *stream, size_t *bytes);
+
+/**
+ * @brief Stops the reader thread and releases the stream.
+ */
+void input_stream_close(input_stream *stream);
+
+/**
+ * @brief Parses an input mode name ("mmap", "read", "direct").
+ * @return 0 on success, -1 if the name is unknown.
+ */
+int input_parse_mode(const char *name, input_mode *mode);
+
+/**
+ * @brief Returns the printable name of an input mode.
+ */
+const char *input_mode_name(input_mode mode);
+
+#endif
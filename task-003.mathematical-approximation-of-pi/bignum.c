@@ -0,0 +1,744 @@
+/**
+ * @file bignum.c
+ * @brief Arbitrary-precision signed integers in base 10^9, for the high-precision PI mode.
+ */
+
+#include "bignum.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FFT_PARALLEL_SIZE (1UL << 15) ///< Transforms at least this long run their stages as taskloops.
+#define FFT_GRAIN 4096                ///< Butterflies per task.
+
+/**
+ * @struct complex_t
+ * @brief Complex number for the FFT (plain struct: C99 complex multiplication handles NaN/Inf and is much slower).
+ */
+typedef struct
+{
+  double re;
+  double im;
+} complex_t;
+
+/* ----- Storage ----- */
+
+/**
+ * @brief Ensures x can hold `limbs` limbs (contents are kept).
+ */
+static void reserve(bignum *x, size_t limbs)
+{
+  if (limbs <= x->capacity)
+    return;
+  size_t capacity = x->capacity ? x->capacity : 4;
+  while (capacity < limbs)
+    capacity *= 2;
+  uint32_t *grown = (uint32_t *)realloc(x->limbs, capacity * sizeof(uint32_t));
+  if (!grown)
+  {
+    fprintf(stderr, "bignum: out of memory (%zu limbs)\n", capacity);
+    abort();
+  }
+  x->limbs = grown;
+  x->capacity = capacity;
+}
+
+/**
+ * @brief Drops leading zero limbs; zero is never negative.
+ */
+static void normalize(bignum *x)
+{
+  while (x->size > 0 && x->limbs[x->size - 1] == 0)
+    x->size--;
+  if (x->size == 0)
+    x->negative = 0;
+}
+
+/**
+ * @brief Replaces the limbs of x with a malloc'ed array of `size` limbs.
+ */
+static void adopt(bignum *x, uint32_t *limbs, size_t size, int negative)
+{
+  free(x->limbs);
+  x->limbs = limbs;
+  x->size = size;
+  x->capacity = size;
+  x->negative = negative;
+  normalize(x);
+}
+
+/**
+ * @brief Allocates `limbs` limbs, aborting on failure.
+ */
+static uint32_t *alloc_limbs(size_t limbs)
+{
+  uint32_t *data = (uint32_t *)calloc(limbs ? limbs : 1, sizeof(uint32_t));
+  if (!data)
+  {
+    fprintf(stderr, "bignum: out of memory (%zu limbs)\n", limbs);
+    abort();
+  }
+  return data;
+}
+
+void bignum_init(bignum *x)
+{
+  x->limbs = NULL;
+  x->size = 0;
+  x->capacity = 0;
+  x->negative = 0;
+}
+
+void bignum_free(bignum *x)
+{
+  free(x->limbs);
+  bignum_init(x);
+}
+
+/**
+ * @brief Sets x to an unsigned 128-bit value.
+ */
+static void set_u128(bignum *x, unsigned __int128 value)
+{
+  reserve(x, 5);
+  x->size = 0;
+  x->negative = 0;
+  while (value > 0)
+  {
+    x->limbs[x->size++] = (uint32_t)(value % BIGNUM_BASE);
+    value /= BIGNUM_BASE;
+  }
+}
+
+void bignum_set_i64(bignum *x, int64_t value)
+{
+  const int negative = value < 0;
+  set_u128(x, negative ? (unsigned __int128)(-(value + 1)) + 1 : (unsigned __int128)value);
+  x->negative = negative && x->size > 0;
+}
+
+void bignum_copy(bignum *dst, const bignum *src)
+{
+  if (dst == src)
+    return;
+  reserve(dst, src->size);
+  if (src->size)
+    memcpy(dst->limbs, src->limbs, src->size * sizeof(uint32_t));
+  dst->size = src->size;
+  dst->negative = src->negative;
+}
+
+/* ----- Magnitude arithmetic on limb arrays ----- */
+
+/**
+ * @brief Compares two magnitudes without leading zero limbs.
+ */
+static int mag_cmp(const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+  if (na != nb)
+    return na < nb ? -1 : 1;
+  for (size_t i = na; i-- > 0;)
+  {
+    if (a[i] != b[i])
+      return a[i] < b[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief r[0, rn) += x[0, xn), with xn <= rn; a carry out of r is dropped.
+ */
+static void add_into(uint32_t *r, size_t rn, const uint32_t *x, size_t xn)
+{
+  uint32_t carry = 0;
+  size_t i = 0;
+  for (; i < xn; i++)
+  {
+    uint32_t sum = r[i] + x[i] + carry;
+    carry = sum >= BIGNUM_BASE;
+    r[i] = carry ? sum - BIGNUM_BASE : sum;
+  }
+  for (; carry && i < rn; i++)
+  {
+    uint32_t sum = r[i] + 1;
+    carry = sum == BIGNUM_BASE;
+    r[i] = carry ? 0 : sum;
+  }
+}
+
+/**
+ * @brief r[0, rn) -= x[0, xn), with r >= x and xn <= rn.
+ */
+static void sub_into(uint32_t *r, size_t rn, const uint32_t *x, size_t xn)
+{
+  uint32_t borrow = 0;
+  size_t i = 0;
+  for (; i < xn; i++)
+  {
+    const uint32_t sub = x[i] + borrow;
+    borrow = r[i] < sub;
+    r[i] = borrow ? r[i] + BIGNUM_BASE - sub : r[i] - sub;
+  }
+  for (; borrow && i < rn; i++)
+  {
+    borrow = r[i] == 0;
+    r[i] = borrow ? BIGNUM_BASE - 1 : r[i] - 1;
+  }
+}
+
+/**
+ * @brief r[0, na + nb) = a * b, schoolbook.
+ */
+static void mul_schoolbook(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+  memset(r, 0, (na + nb) * sizeof(uint32_t));
+  for (size_t i = 0; i < na; i++)
+  {
+    uint64_t carry = 0;
+    const uint64_t ai = a[i];
+    for (size_t j = 0; j < nb; j++)
+    {
+      const uint64_t t = r[i + j] + ai * b[j] + carry;
+      r[i + j] = (uint32_t)(t % BIGNUM_BASE);
+      carry = t / BIGNUM_BASE;
+    }
+    r[i + nb] = (uint32_t)carry;
+  }
+}
+
+/**
+ * @brief In-place iterative radix-2 FFT of length n (a power of two); unnormalized when inverse.
+ */
+static void fft(complex_t *x, size_t n, int inverse)
+{
+  for (size_t i = 1, j = 0; i < n; i++)
+  {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+    {
+      complex_t t = x[i];
+      x[i] = x[j];
+      x[j] = t;
+    }
+  }
+
+  complex_t *roots = (complex_t *)malloc((n / 2 + 1) * sizeof(complex_t));
+  if (!roots)
+  {
+    fprintf(stderr, "bignum: out of memory (FFT of %zu points)\n", n);
+    abort();
+  }
+  const double sign = inverse ? 2.0 : -2.0;
+#pragma omp taskloop grainsize(FFT_GRAIN) if (n >= FFT_PARALLEL_SIZE)
+  for (size_t k = 0; k < n / 2; k++)
+  {
+    const double angle = sign * M_PI * (double)k / (double)n;
+    roots[k].re = cos(angle);
+    roots[k].im = sin(angle);
+  }
+
+  for (size_t len = 2, shift = 0; len <= n; len <<= 1, shift++)
+  {
+    const size_t half = len >> 1;
+    const size_t step = n / len;
+#pragma omp taskloop grainsize(FFT_GRAIN) if (n >= FFT_PARALLEL_SIZE)
+    for (size_t t = 0; t < n / 2; t++)
+    {
+      const size_t j = t & (half - 1);
+      const size_t i = ((t >> shift) * len) + j;
+      const complex_t w = roots[j * step];
+      const complex_t u = x[i];
+      const complex_t y = x[i + half];
+      const complex_t v = {y.re * w.re - y.im * w.im, y.re * w.im + y.im * w.re};
+      x[i].re = u.re + v.re;
+      x[i].im = u.im + v.im;
+      x[i + half].re = u.re - v.re;
+      x[i + half].im = u.im - v.im;
+    }
+  }
+  free(roots);
+}
+
+/**
+ * @brief r[0, na + nb) = a * b through one FFT of both operands split into base-1000 digits.
+ *
+ * a goes in the real part and b in the imaginary part; their spectra are
+ * separated with the conjugate symmetry of real signals, multiplied, and
+ * transformed back. Coefficients stay below 3 nb 10^6, far from the 2^53
+ * limit of exact rounding.
+ */
+static void mul_fft(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+  const size_t digits = 3 * (na + nb);
+  size_t n = 1;
+  while (n < digits)
+    n <<= 1;
+
+  complex_t *z = (complex_t *)calloc(n, sizeof(complex_t));
+  complex_t *c = (complex_t *)malloc(n * sizeof(complex_t));
+  if (!z || !c)
+  {
+    fprintf(stderr, "bignum: out of memory (FFT of %zu points)\n", n);
+    abort();
+  }
+  for (size_t i = 0; i < na; i++)
+  {
+    z[3 * i].re = a[i] % 1000;
+    z[3 * i + 1].re = a[i] / 1000 % 1000;
+    z[3 * i + 2].re = a[i] / 1000000;
+  }
+  for (size_t i = 0; i < nb; i++)
+  {
+    z[3 * i].im = b[i] % 1000;
+    z[3 * i + 1].im = b[i] / 1000 % 1000;
+    z[3 * i + 2].im = b[i] / 1000000;
+  }
+
+  fft(z, n, 0);
+  for (size_t k = 0; k < n; k++)
+  {
+    const complex_t zk = z[k];
+    const complex_t zj = z[(n - k) & (n - 1)];
+    // A = (Z[k] + conj(Z[n-k])) / 2, B = (Z[k] - conj(Z[n-k])) / 2i
+    const complex_t fa = {(zk.re + zj.re) * 0.5, (zk.im - zj.im) * 0.5};
+    const complex_t fb = {(zk.im + zj.im) * 0.5, (zj.re - zk.re) * 0.5};
+    c[k].re = fa.re * fb.re - fa.im * fb.im;
+    c[k].im = fa.re * fb.im + fa.im * fb.re;
+  }
+  free(z);
+  fft(c, n, 1);
+
+  uint64_t carry = 0;
+  uint32_t limb = 0, scale = 1;
+  size_t out = 0;
+  for (size_t i = 0; i < digits; i++)
+  {
+    const uint64_t value = (uint64_t)(c[i].re / (double)n + 0.5) + carry;
+    limb += (uint32_t)(value % 1000) * scale;
+    carry = value / 1000;
+    scale *= 1000;
+    if (scale == BIGNUM_BASE)
+    {
+      r[out++] = limb;
+      limb = 0;
+      scale = 1;
+    }
+  }
+  free(c);
+}
+
+static void mul_mag(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb);
+
+/**
+ * @brief r[0, na + nb) = a * b with Karatsuba, for ceil(na / 2) < nb <= na.
+ *
+ * With h = ceil(na / 2): a b = z2 B^2h + (z1 - z0 - z2) B^h + z0, where
+ * z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1).
+ */
+static void mul_karatsuba(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+  const size_t h = (na + 1) / 2;
+  const size_t na1 = na - h, nb1 = nb - h;
+  uint32_t *sa = alloc_limbs(h + 1);
+  uint32_t *sb = alloc_limbs(h + 1);
+  uint32_t *z1 = alloc_limbs(2 * h + 2);
+  uint32_t *z2 = alloc_limbs(na1 + nb1);
+
+  memcpy(sa, a, h * sizeof(uint32_t));
+  add_into(sa, h + 1, a + h, na1);
+  memcpy(sb, b, h * sizeof(uint32_t));
+  add_into(sb, h + 1, b + h, nb1);
+
+  mul_mag(r, a, h, b, h); // z0 in r[0, 2h)
+  mul_mag(z2, a + h, na1, b + h, nb1);
+  mul_mag(z1, sa, h + 1, sb, h + 1);
+  sub_into(z1, 2 * h + 2, r, 2 * h);
+  sub_into(z1, 2 * h + 2, z2, na1 + nb1);
+
+  memcpy(r + 2 * h, z2, (na1 + nb1) * sizeof(uint32_t));
+  // z1 < B^(na + nb - h), so its limbs past that are zero.
+  const size_t room = na + nb - h;
+  add_into(r + h, room, z1, 2 * h + 2 < room ? 2 * h + 2 : room);
+
+  free(sa);
+  free(sb);
+  free(z1);
+  free(z2);
+}
+
+/**
+ * @brief r[0, na + nb) = a * b, choosing schoolbook, Karatsuba or FFT by size. r must not overlap a or b.
+ */
+static void mul_mag(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+  if (na < nb)
+  {
+    const uint32_t *t = a;
+    a = b;
+    b = t;
+    size_t tn = na;
+    na = nb;
+    nb = tn;
+  }
+  if (nb == 0)
+  {
+    memset(r, 0, na * sizeof(uint32_t));
+    return;
+  }
+  if (nb < BIGNUM_KARATSUBA_LIMBS)
+  {
+    mul_schoolbook(r, a, na, b, nb);
+  }
+  else if (nb >= BIGNUM_FFT_LIMBS)
+  {
+    mul_fft(r, a, na, b, nb);
+  }
+  else if (nb <= (na + 1) / 2)
+  {
+    // Unbalanced: multiply b by slices of a as long as b.
+    uint32_t *part = alloc_limbs(2 * nb);
+    memset(r, 0, (na + nb) * sizeof(uint32_t));
+    for (size_t offset = 0; offset < na; offset += nb)
+    {
+      const size_t len = na - offset < nb ? na - offset : nb;
+      mul_mag(part, a + offset, len, b, nb);
+      add_into(r + offset, na + nb - offset, part, len + nb);
+    }
+    free(part);
+  }
+  else
+  {
+    mul_karatsuba(r, a, na, b, nb);
+  }
+}
+
+/* ----- Signed arithmetic ----- */
+
+int bignum_cmp(const bignum *a, const bignum *b)
+{
+  if (a->negative != b->negative)
+    return a->negative ? -1 : 1;
+  const int c = mag_cmp(a->limbs, a->size, b->limbs, b->size);
+  return a->negative ? -c : c;
+}
+
+/**
+ * @brief r = (-1)^a_negative |a| + (-1)^b_negative |b|.
+ *
+ * When r is the larger operand the other one is added in place; an r that
+ * aliases only the smaller operand goes through a temporary.
+ */
+static void add_signed(bignum *r, const bignum *a, int a_negative, const bignum *b, int b_negative)
+{
+  const int c = mag_cmp(a->limbs, a->size, b->limbs, b->size);
+  const bignum *big = c >= 0 ? a : b;
+  const bignum *small = c >= 0 ? b : a;
+  if (r == small && r != big)
+  {
+    bignum t;
+    bignum_init(&t);
+    add_signed(&t, a, a_negative, b, b_negative);
+    bignum_free(r);
+    *r = t;
+    return;
+  }
+
+  const size_t nbig = big->size, nsmall = small->size;
+  const int negative = c >= 0 ? a_negative : b_negative;
+  if (a_negative == b_negative)
+  {
+    reserve(r, nbig + 1);
+    if (r != big)
+      memcpy(r->limbs, big->limbs, nbig * sizeof(uint32_t));
+    r->limbs[nbig] = 0;
+    add_into(r->limbs, nbig + 1, small->limbs, nsmall);
+    r->size = nbig + 1;
+  }
+  else
+  {
+    reserve(r, nbig);
+    if (r != big)
+      memcpy(r->limbs, big->limbs, nbig * sizeof(uint32_t));
+    sub_into(r->limbs, nbig, small->limbs, nsmall);
+    r->size = nbig;
+  }
+  r->negative = negative;
+  normalize(r);
+}
+
+void bignum_add(bignum *r, const bignum *a, const bignum *b)
+{
+  add_signed(r, a, a->negative, b, b->negative);
+}
+
+void bignum_sub(bignum *r, const bignum *a, const bignum *b)
+{
+  add_signed(r, a, a->negative, b, b->size ? !b->negative : 0);
+}
+
+void bignum_mul(bignum *r, const bignum *a, const bignum *b)
+{
+  if (a->size == 0 || b->size == 0)
+  {
+    r->size = 0;
+    r->negative = 0;
+    return;
+  }
+  const size_t n = a->size + b->size;
+  const int negative = a->negative != b->negative;
+  uint32_t *product = alloc_limbs(n);
+  mul_mag(product, a->limbs, a->size, b->limbs, b->size);
+  adopt(r, product, n, negative);
+}
+
+void bignum_mul_small(bignum *r, const bignum *a, uint32_t m)
+{
+  const size_t n = a->size;
+  const int negative = a->negative;
+  reserve(r, n + 1);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    const uint64_t t = (uint64_t)a->limbs[i] * m + carry;
+    r->limbs[i] = (uint32_t)(t % BIGNUM_BASE);
+    carry = t / BIGNUM_BASE;
+  }
+  r->limbs[n] = (uint32_t)carry;
+  r->size = n + 1;
+  r->negative = negative;
+  normalize(r);
+}
+
+/**
+ * @brief r = floor(a / d) for a >= 0 and 0 < d < BIGNUM_BASE.
+ */
+static void div_small(bignum *r, const bignum *a, uint32_t d)
+{
+  const size_t n = a->size;
+  reserve(r, n);
+  uint64_t rem = 0;
+  for (size_t i = n; i-- > 0;)
+  {
+    const uint64_t cur = rem * BIGNUM_BASE + a->limbs[i];
+    r->limbs[i] = (uint32_t)(cur / d);
+    rem = cur % d;
+  }
+  r->size = n;
+  r->negative = 0;
+  normalize(r);
+}
+
+void bignum_shift(bignum *r, const bignum *a, long limbs)
+{
+  const size_t n = a->size;
+  const int negative = a->negative;
+  if (n == 0)
+  {
+    r->size = 0;
+    r->negative = 0;
+    return;
+  }
+  if (limbs >= 0)
+  {
+    reserve(r, n + (size_t)limbs);
+    memmove(r->limbs + limbs, a->limbs, n * sizeof(uint32_t));
+    memset(r->limbs, 0, (size_t)limbs * sizeof(uint32_t));
+    r->size = n + (size_t)limbs;
+  }
+  else if ((size_t)-limbs >= n)
+  {
+    r->size = 0;
+  }
+  else
+  {
+    reserve(r, n);
+    memmove(r->limbs, a->limbs + (-limbs), (n - (size_t)-limbs) * sizeof(uint32_t));
+    r->size = n - (size_t)-limbs;
+  }
+  r->negative = negative;
+  normalize(r);
+}
+
+/* ----- Division and square root ----- */
+
+/**
+ * @brief r ~ B^(2p) / b_p, where b_p is the top p limbs of b (b has at least p limbs, top limb >= B/2).
+ *
+ * Newton iteration with doubling precision: from r_h ~ B^(2h) / b_h,
+ * r0 = r_h B^(p-h) and r = r0 + r0 (B^(2p) - b_p r0) / B^(2p). The result
+ * is within a few units of the exact quotient; callers correct it.
+ */
+static void reciprocal(bignum *r, const bignum *b, size_t p)
+{
+  const uint32_t *top = b->limbs + b->size;
+  if (p <= 2)
+  {
+    const unsigned __int128 b18 = 1000000000000000000ULL;
+    if (p == 1)
+      set_u128(r, b18 / top[-1]);
+    else
+      set_u128(r, b18 * b18 / ((uint64_t)top[-1] * BIGNUM_BASE + top[-2]));
+    return;
+  }
+
+  // One more limb than half, so the squared error of r_h stays below one unit of r.
+  const size_t h = (p + 1) / 2 + 1 < p ? (p + 1) / 2 + 1 : p - 1;
+  bignum r0, bp, e, t;
+  bignum_init(&r0);
+  bignum_init(&bp);
+  bignum_init(&e);
+  bignum_init(&t);
+
+  reciprocal(&r0, b, h);
+  bignum_shift(&r0, &r0, (long)(p - h));
+  bignum_shift(&bp, b, -(long)(b->size - p));
+  bignum_mul(&t, &bp, &r0);
+  bignum_set_i64(&e, 1);
+  bignum_shift(&e, &e, (long)(2 * p));
+  bignum_sub(&e, &e, &t);
+  bignum_mul(&t, &r0, &e);
+  bignum_shift(&t, &t, -(long)(2 * p));
+  bignum_add(r, &r0, &t);
+
+  bignum_free(&r0);
+  bignum_free(&bp);
+  bignum_free(&e);
+  bignum_free(&t);
+}
+
+void bignum_div(bignum *q, const bignum *a, const bignum *b)
+{
+  if (mag_cmp(a->limbs, a->size, b->limbs, b->size) < 0)
+  {
+    q->size = 0;
+    q->negative = 0;
+    return;
+  }
+
+  bignum an, bn, r, t, rem, one;
+  bignum_init(&an);
+  bignum_init(&bn);
+  bignum_init(&r);
+  bignum_init(&t);
+  bignum_init(&rem);
+  bignum_init(&one);
+  bignum_set_i64(&one, 1);
+
+  // Scale both operands so the top limb of the divisor is at least B/2 (the quotient is unchanged).
+  const uint32_t d = BIGNUM_BASE / (b->limbs[b->size - 1] + 1);
+  bignum_mul_small(&an, a, d);
+  bignum_mul_small(&bn, b, d);
+
+  const size_t m = bn.size, n = an.size;
+  const size_t p = (n - m > m ? n - m : m) + 1;
+  bignum_shift(&t, &bn, (long)(p - m));
+  reciprocal(&r, &t, p); // ~ B^(2p) / (bn B^(p-m)) = B^(p+m) / bn
+  bignum_mul(&t, &an, &r);
+  bignum_shift(&t, &t, -(long)(p + m));
+
+  bignum_mul(&rem, &t, &bn);
+  bignum_sub(&rem, &an, &rem);
+  while (rem.negative)
+  {
+    bignum_sub(&t, &t, &one);
+    bignum_add(&rem, &rem, &bn);
+  }
+  while (bignum_cmp(&rem, &bn) >= 0)
+  {
+    bignum_add(&t, &t, &one);
+    bignum_sub(&rem, &rem, &bn);
+  }
+  bignum_copy(q, &t);
+
+  bignum_free(&an);
+  bignum_free(&bn);
+  bignum_free(&r);
+  bignum_free(&t);
+  bignum_free(&rem);
+  bignum_free(&one);
+}
+
+void bignum_sqrt(bignum *r, const bignum *a)
+{
+  const size_t n = a->size;
+  if (n <= 2)
+  {
+    const uint64_t v = n == 0 ? 0 : n == 1 ? a->limbs[0] : (uint64_t)a->limbs[1] * BIGNUM_BASE + a->limbs[0];
+    uint64_t x = (uint64_t)sqrtl((long double)v);
+    while (x > 0 && (unsigned __int128)x * x > v)
+      x--;
+    while ((unsigned __int128)(x + 1) * (x + 1) <= v)
+      x++;
+    set_u128(r, x);
+    return;
+  }
+
+  // sqrt(a) ~ sqrt(a / B^2k) B^k; one Newton step then doubles the correct limbs.
+  const size_t k = n / 4 > 0 ? n / 4 : 1;
+  bignum x, t, rem, step;
+  bignum_init(&x);
+  bignum_init(&t);
+  bignum_init(&rem);
+  bignum_init(&step);
+
+  bignum_shift(&t, a, -(long)(2 * k));
+  bignum_sqrt(&x, &t);
+  bignum_shift(&x, &x, (long)k);
+  bignum_div(&t, a, &x);
+  bignum_add(&x, &x, &t);
+  div_small(&x, &x, 2);
+
+  // rem = a - x^2; move x by one while rem is outside [0, 2x].
+  bignum_mul(&rem, &x, &x);
+  bignum_sub(&rem, a, &rem);
+  while (rem.negative)
+  {
+    // (x - 1)^2 = x^2 - (2x - 1)
+    bignum_add(&step, &x, &x);
+    bignum_set_i64(&t, 1);
+    bignum_sub(&step, &step, &t);
+    bignum_add(&rem, &rem, &step);
+    bignum_sub(&x, &x, &t);
+  }
+  for (;;)
+  {
+    // (x + 1)^2 = x^2 + (2x + 1)
+    bignum_add(&step, &x, &x);
+    bignum_set_i64(&t, 1);
+    bignum_add(&step, &step, &t);
+    if (bignum_cmp(&rem, &step) < 0)
+      break;
+    bignum_sub(&rem, &rem, &step);
+    bignum_add(&x, &x, &t);
+  }
+  bignum_copy(r, &x);
+
+  bignum_free(&x);
+  bignum_free(&t);
+  bignum_free(&rem);
+  bignum_free(&step);
+}
+
+char *bignum_to_string(const bignum *x)
+{
+  char *text = (char *)malloc(x->size * BIGNUM_DIGITS + 3);
+  if (!text)
+    return NULL;
+  if (x->size == 0)
+  {
+    strcpy(text, "0");
+    return text;
+  }
+  char *out = text;
+  if (x->negative)
+    *out++ = '-';
+  out += sprintf(out, "%u", x->limbs[x->size - 1]);
+  for (size_t i = x->size - 1; i-- > 0;)
+    out += sprintf(out, "%09u", x->limbs[i]);
+  return text;
+}
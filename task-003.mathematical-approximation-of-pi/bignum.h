@@ -0,0 +1,114 @@
+/**
+ * @file bignum.h
+ * @brief Arbitrary-precision signed integers in base 10^9, for the high-precision PI mode.
+ *
+ * Each limb holds 9 decimal digits (little-endian), so printing a number
+ * needs no base conversion. Multiplication picks an algorithm by operand
+ * size:
+ *
+ * - schoolbook below BIGNUM_KARATSUBA_LIMBS limbs;
+ * - Karatsuba (three half-size products) up to BIGNUM_FFT_LIMBS;
+ * - above that, a complex FFT on base-1000 digits, with both operands
+ *   packed into one transform (real and imaginary parts). Butterfly
+ *   stages of large transforms run as OpenMP taskloops, so they use the
+ *   threads of the enclosing parallel region.
+ *
+ * Division and square root use Newton iterations built on multiplication
+ * (reciprocal and square root with doubling precision), followed by an
+ * exact correction, so they inherit its O(n log n) cost.
+ *
+ * The value zero has size 0. Functions accept outputs that alias their
+ * inputs.
+ */
+
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BIGNUM_BASE 1000000000u ///< Limb base.
+#define BIGNUM_DIGITS 9         ///< Decimal digits per limb.
+#define BIGNUM_KARATSUBA_LIMBS 32 ///< Smaller operands use schoolbook multiplication.
+#define BIGNUM_FFT_LIMBS 1024     ///< Operands at least this long (the shorter one) use the FFT.
+
+/**
+ * @struct bignum
+ * @brief Signed integer: sign and magnitude in base 10^9.
+ */
+typedef struct
+{
+  uint32_t *limbs;  ///< Magnitude, least significant limb first.
+  size_t size;      ///< Limbs in use (no leading zero limbs).
+  size_t capacity;  ///< Allocated limbs.
+  int negative;     ///< 1 if the value is negative (never set for zero).
+} bignum;
+
+/**
+ * @brief Initializes x to zero.
+ */
+void bignum_init(bignum *x);
+
+/**
+ * @brief Releases x.
+ */
+void bignum_free(bignum *x);
+
+/**
+ * @brief Sets x to a signed 64-bit value.
+ */
+void bignum_set_i64(bignum *x, int64_t value);
+
+/**
+ * @brief Copies src into dst.
+ */
+void bignum_copy(bignum *dst, const bignum *src);
+
+/**
+ * @brief Compares two values.
+ * @return Negative, zero or positive as a < b, a == b or a > b.
+ */
+int bignum_cmp(const bignum *a, const bignum *b);
+
+/**
+ * @brief r = a + b.
+ */
+void bignum_add(bignum *r, const bignum *a, const bignum *b);
+
+/**
+ * @brief r = a - b.
+ */
+void bignum_sub(bignum *r, const bignum *a, const bignum *b);
+
+/**
+ * @brief r = a * b.
+ */
+void bignum_mul(bignum *r, const bignum *a, const bignum *b);
+
+/**
+ * @brief r = a * m, with 0 <= m < BIGNUM_BASE.
+ */
+void bignum_mul_small(bignum *r, const bignum *a, uint32_t m);
+
+/**
+ * @brief r = a * BIGNUM_BASE^limbs (limbs < 0 divides, truncating toward zero).
+ */
+void bignum_shift(bignum *r, const bignum *a, long limbs);
+
+/**
+ * @brief q = floor(a / b) for a >= 0 and b > 0.
+ */
+void bignum_div(bignum *q, const bignum *a, const bignum *b);
+
+/**
+ * @brief r = floor(sqrt(a)) for a >= 0.
+ */
+void bignum_sqrt(bignum *r, const bignum *a);
+
+/**
+ * @brief Decimal representation of x (with a leading '-' if negative).
+ * @return String allocated with malloc, or NULL on allocation failure.
+ */
+char *bignum_to_string(const bignum *x);
+
+#endif
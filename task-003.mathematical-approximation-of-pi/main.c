@@ -1,101 +1,254 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
-#include <time.h>
-#include <sys/time.h>
+#include <omp.h>
+
+#include "../common/async_writer.h"
+#include "pi_chudnovsky.h"
+#include "pi_series.h"
+
+#define DEFAULT_LEIBNIZ_DIGITS 9 ///< Leibniz needs about 10^d terms for d digits.
+#define PI_REFERENCE_DIGITS 100  ///< Decimal places of PI_REFERENCE.
+#define PI_REFERENCE "3.1415926535897932384626433832795028841971693993751058209749445923078164062862089986280348253421170679"
+#define DEFAULT_OUTPUT "./task-3.mathematical-approximation-of-pi/data/pi_approximation.csv"
 
 /**
- * @brief Counts the number of correct decimal places between the approximated and real values of PI.
+ * @struct progress
+ * @brief Output file and best number of correct decimal places printed so far.
+ */
+struct progress
+{
+  async_writer *file;  ///< CSV output.
+  int correct_places;  ///< Correct decimal places of the last printed row.
+};
+
+/**
+ * @brief Prints and records a row each time the approximation gains correct decimal places.
  *
- * This function compares the first 15 decimal places of the approximated and real values of PI.
+ * Called by the series engine between blocks only, so the comparison with
+ * M_PI is done a few dozen times per run instead of once per term. The row
+ * goes to an async_writer, so the run never waits for the disk.
  *
- * @param approx_pi The approximated value of PI.
- * @param real_pi The real value of PI.
- * @return The number of correct decimal places.
+ * @param state Progress of the run after a block.
+ * @param arg Pointer to a struct progress.
+ * @return 0, to keep running until the engine converges.
  */
-int count_correct_decimal_places(double approx_pi, double real_pi)
+int record_progress(const pi_series_state *state, void *arg)
 {
-  char str_approx[50], str_real[50];
-  snprintf(str_approx, sizeof(str_approx), "%.15f", approx_pi);
-  snprintf(str_real, sizeof(str_real), "%.15f", real_pi);
+  struct progress *progress = arg;
+  int correct_places = pi_correct_decimal_places(state->pi, M_PI);
 
-  int count = 0;
-  for (int i = 0; i < 15; i++)
+  if (correct_places > progress->correct_places || state->converged)
   {
-    if (str_approx[i] == str_real[i])
-      count++;
-    else
-      break;
+    double error = fabs(M_PI - state->pi);
+
+    printf("%11zu | %19.15f | %14.10f | %18.6f | %22d\n", state->terms, state->pi, error, state->seconds, correct_places);
+    async_writer_printf(progress->file, "%zu,%.15f,%.10f,%.6f,%d\n", state->terms, state->pi, error, state->seconds,
+                        correct_places);
+    progress->correct_places = correct_places;
   }
-  return count;
+  return 0;
+}
+
+/**
+ * @brief Checks the leading decimal places of a high-precision result against PI_REFERENCE.
+ * @return 1 if they match.
+ */
+int check_reference(const char *pi, size_t digits)
+{
+  const size_t places = digits < PI_REFERENCE_DIGITS ? digits : PI_REFERENCE_DIGITS;
+  return strncmp(pi, PI_REFERENCE, places + 2) == 0;
 }
 
 /**
- * @brief Calculates the approximation of PI using the Leibniz series.
+ * @brief Next thread count of a scaling run: doubles, then ends with the maximum itself.
+ */
+int next_thread_count(int threads, int max_threads)
+{
+  if (threads >= max_threads)
+    return max_threads + 1;
+  return threads * 2 < max_threads ? threads * 2 : max_threads;
+}
+
+/**
+ * @brief Computes PI with `digits` decimal places by binary splitting and prints the timings.
  *
- * This function iterates over the Leibniz series and records the data in the provided file.
+ * With `scaling`, the computation is repeated for 1, 2, 4, ... threads (up
+ * to omp_get_max_threads()) and the speedup over one thread is printed;
+ * every run must produce the same digits.
  *
- * @param iterations A pointer to the current number of correct decimal places.
- * @param file The file where the results will be saved in CSV format.
+ * @return 0 on success, 1 if a result is wrong.
  */
-double calculate_pi(int *iterations, FILE *file)
+int run_precision(size_t digits, int scaling)
 {
-  double approx_pi = 0.0;
-  int i = 0;
-
-  struct timeval start, end;
-  gettimeofday(&start, NULL);
+  const int max_threads = omp_get_max_threads();
+  printf("Chudnovsky by binary splitting: %zu decimal places, %zu terms\n\n", digits,
+         (size_t)(digits / PI_CHUDNOVSKY_DIGITS_PER_TERM) + 2);
+  printf(" Threads | Split (s) | Sqrt (s) | Divide (s) | Total (s) |   Digits/s | Speedup | Efficiency\n");
+  printf("-------------------------------------------------------------------------------------------\n");
 
-  while (1)
+  char *first = NULL;
+  double base_seconds = 0.0;
+  int status = 0;
+  for (int threads = scaling ? 1 : max_threads; threads <= max_threads; threads = next_thread_count(threads, max_threads))
   {
-    double term = (i % 2 == 0 ? 1.0 : -1.0) / (2 * i + 1);
-    approx_pi += term;
-    i++;
-
-    double current_pi = approx_pi * 4.0;
-    int correct_places = count_correct_decimal_places(current_pi, M_PI);
-
-    if (correct_places > *iterations)
+    pi_chudnovsky_stats stats;
+    omp_set_num_threads(threads);
+    char *pi = pi_chudnovsky(digits, &stats);
+    if (!pi)
     {
-      gettimeofday(&end, NULL);
-
-      double execution_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
-      double error = fabs(M_PI - current_pi);
+      printf("Error: out of memory\n");
+      status = 1;
+      break;
+    }
+    if (!first)
+      base_seconds = stats.seconds;
+    const double speedup = stats.seconds > 0.0 ? base_seconds / stats.seconds : 0.0;
+    printf("%8d | %9.3f | %8.3f | %10.3f | %9.3f | %10.3e | %7.2f | %9.1f%%\n", threads, stats.split_seconds,
+           stats.sqrt_seconds, stats.divide_seconds, stats.seconds, digits / stats.seconds, speedup,
+           100.0 * speedup / threads);
 
-      printf("%10d | %18.15f | %13.10f | %19.6f | %10d\n", i, current_pi, error, execution_time, correct_places);
-      fprintf(file, "%d,%.15f,%.10f,%.6f,%d\n", i, current_pi, error, execution_time, correct_places);
-      fflush(file); // Force immediate writing to file
-      *iterations = correct_places;
+    if (!check_reference(pi, digits) || (first && strcmp(pi, first) != 0))
+    {
+      printf("Error: the digits computed with %d threads are wrong\n", threads);
+      status = 1;
     }
+    if (!first)
+      first = pi;
+    else
+      free(pi);
+  }
+  omp_set_num_threads(max_threads);
+
+  if (first)
+  {
+    const size_t shown = digits < 50 ? digits : 50;
+    printf("\nPI = %.*s%s\n", (int)shown + 2, first, shown < digits ? "..." : "");
+    printf("Last digits: ...%s\n", first + 2 + digits - shown);
   }
+  free(first);
+  return status;
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+void print_usage(const char *program)
+{
+  printf("Usage: %s [--series leibniz|euler|machin|chudnovsky] [--digits D] [--max-terms N]\n"
+         "          [--sum plain|kahan|pairwise] [--threads T] [--output PATH]\n"
+         "       %s --precision D [--scaling] [--threads T]\n",
+         program, program);
 }
 
 /**
  * @brief Main function to execute the PI approximation and write the results to a CSV file.
  *
- * This function opens a file for writing, calculates the approximation of PI using the
- * Leibniz series, and writes the results to the file in CSV format.
+ * This function parses the options, sums the selected series with the
+ * series engine until its error bound reaches the requested number of
+ * decimal places (or the maximum number of terms), and writes each gain of
+ * correct decimal places to the file in CSV format.
  *
  * @return Returns 0 on successful execution.
  */
-int main()
+int main(int argc, char *argv[])
 {
-  FILE *file = fopen("./task-3.mathematical-approximation-of-pi/data/pi_approximation.csv", "w");
-  if (!file)
+  const pi_series *series = pi_series_find("leibniz");
+  pi_series_options options = {0, 0, REDUCE_KAHAN};
+  const char *output = DEFAULT_OUTPUT;
+  size_t precision = 0;
+  int scaling = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--series") == 0 && i + 1 < argc && pi_series_find(argv[i + 1]))
+    {
+      series = pi_series_find(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--digits") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+    {
+      options.digits = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--max-terms") == 0 && i + 1 < argc && atoll(argv[i + 1]) > 0)
+    {
+      options.max_terms = (size_t)atoll(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--sum") == 0 && i + 1 < argc)
+    {
+      const char *name = argv[++i];
+      int found = 0;
+      for (int m = 0; m < REDUCE_METHOD_COUNT; m++)
+      {
+        if (strcmp(name, reduce_method_name((reduce_method)m)) == 0)
+        {
+          options.method = (reduce_method)m;
+          found = 1;
+        }
+      }
+      if (!found)
+      {
+        print_usage(argv[0]);
+        return 1;
+      }
+    }
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+    {
+      omp_set_num_threads(atoi(argv[++i]));
+    }
+    else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+    {
+      output = argv[++i];
+    }
+    else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc && atoll(argv[i + 1]) > 0)
+    {
+      precision = (size_t)atoll(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--scaling") == 0)
+    {
+      scaling = 1;
+    }
+    else
+    {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (precision > 0)
+  {
+    return run_precision(precision, scaling);
+  }
+  if (options.digits == 0)
+  {
+    options.digits = strcmp(series->name, "leibniz") == 0 ? DEFAULT_LEIBNIZ_DIGITS : PI_SERIES_MAX_DIGITS;
+  }
+
+  async_writer file;
+  if (async_writer_open(&file, output) != 0)
   {
     printf("Error opening file!\n");
     return 1;
   }
 
-  fprintf(file, "Iterations,Approximation of PI,Absolute Error,Execution Time (s),Correct Decimal Places\n");
+  async_writer_printf(&file, "Iterations,Approximation of PI,Absolute Error,Execution Time (s),Correct Decimal Places\n");
 
+  printf("Series: %s, target: %d decimal places, summation: %s, threads: %d\n\n", series->name, options.digits,
+         reduce_method_name(options.method), omp_get_max_threads());
   printf(" Iterations | Approximation of PI | Absolute Error | Execution Time (s) | Correct Decimal Places\n");
   printf("----------------------------------------------------------------------------------------------\n");
 
-  int correct_places = -1;
-  calculate_pi(&correct_places, file);
+  struct progress progress = {&file, -1};
+  pi_series_state state = pi_series_run(series, &options, record_progress, &progress);
 
-  fclose(file);
-  printf("Data successfully written to pi_approximation.csv\n");
+  if (async_writer_close(&file) != 0)
+  {
+    perror("Error writing the CSV file");
+    return 1;
+  }
+  printf("\n%s after %zu terms: error bound %.3e, %.3f s, %.3e terms/s\n",
+         state.converged ? "Converged" : "Stopped at the term limit", state.terms, state.bound, state.seconds,
+         state.seconds > 0.0 ? state.terms / state.seconds : 0.0);
+  printf("Data successfully written to %s\n", output);
 
   return 0;
 }
@@ -0,0 +1,170 @@
+/**
+ * @file pi_chudnovsky.c
+ * @brief PI to arbitrary precision: Chudnovsky series by parallel binary splitting.
+ */
+
+#include "pi_chudnovsky.h"
+
+#include "bignum.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GUARD_LIMBS 2 ///< Limbs computed beyond the requested digits.
+
+/**
+ * @brief Reads CLOCK_MONOTONIC in seconds.
+ */
+static double now_seconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief P, Q and T of the single term k.
+ *
+ * P = -(6k - 5)(2k - 1)(6k - 1), Q = k^3 640320^3 / 24 (= k^3 320160^2 106720)
+ * and T = P (13591409 + 545140134 k); term 0 has P = Q = 1.
+ */
+static void split_leaf(size_t k, bignum *P, bignum *Q, bignum *T)
+{
+  bignum factor;
+  bignum_init(&factor);
+  if (k == 0)
+  {
+    bignum_set_i64(P, 1);
+    bignum_set_i64(Q, 1);
+  }
+  else
+  {
+    bignum_set_i64(P, -(int64_t)(6 * k - 5));
+    bignum_mul_small(P, P, (uint32_t)(2 * k - 1));
+    bignum_mul_small(P, P, (uint32_t)(6 * k - 1));
+    bignum_set_i64(Q, (int64_t)k);
+    bignum_mul_small(Q, Q, (uint32_t)k);
+    bignum_mul_small(Q, Q, (uint32_t)k);
+    bignum_mul_small(Q, Q, 320160);
+    bignum_mul_small(Q, Q, 320160);
+    bignum_mul_small(Q, Q, 106720);
+  }
+  bignum_set_i64(&factor, 13591409 + 545140134 * (int64_t)k);
+  bignum_mul(T, P, &factor);
+  bignum_free(&factor);
+}
+
+/**
+ * @brief P, Q and T of the terms [a, b); P is skipped when the caller does not need it.
+ *
+ * Only the rightmost ranges of the tree can skip P, which saves one large
+ * product per level on that spine.
+ */
+static void split(size_t a, size_t b, int need_p, bignum *P, bignum *Q, bignum *T)
+{
+  if (b - a == 1)
+  {
+    split_leaf(a, P, Q, T);
+    return;
+  }
+
+  const size_t m = a + (b - a) / 2;
+  const int tasks = b - a >= PI_CHUDNOVSKY_TASK_TERMS;
+  bignum P1, Q1, T1, P2, Q2, T2, product;
+  bignum_init(&P1);
+  bignum_init(&Q1);
+  bignum_init(&T1);
+  bignum_init(&P2);
+  bignum_init(&Q2);
+  bignum_init(&T2);
+  bignum_init(&product);
+
+#pragma omp task shared(P1, Q1, T1) if (tasks)
+  split(a, m, 1, &P1, &Q1, &T1);
+  split(m, b, need_p, &P2, &Q2, &T2);
+#pragma omp taskwait
+
+#pragma omp task shared(T, T1, Q2) if (tasks)
+  bignum_mul(T, &T1, &Q2);
+#pragma omp task shared(product, P1, T2) if (tasks)
+  bignum_mul(&product, &P1, &T2);
+  if (need_p)
+  {
+#pragma omp task shared(P, P1, P2) if (tasks)
+    bignum_mul(P, &P1, &P2);
+  }
+  bignum_mul(Q, &Q1, &Q2);
+#pragma omp taskwait
+  bignum_add(T, T, &product);
+
+  bignum_free(&P1);
+  bignum_free(&Q1);
+  bignum_free(&T1);
+  bignum_free(&P2);
+  bignum_free(&Q2);
+  bignum_free(&T2);
+  bignum_free(&product);
+}
+
+/**
+ * @brief PI B^limbs = 426880 sqrt(10005 B^(2 limbs)) Q / T, truncated.
+ */
+static void evaluate(size_t terms, size_t limbs, bignum *pi, pi_chudnovsky_stats *stats)
+{
+  bignum P, Q, T, root;
+  bignum_init(&P);
+  bignum_init(&Q);
+  bignum_init(&T);
+  bignum_init(&root);
+
+  double start = now_seconds();
+  split(0, terms, 0, &P, &Q, &T);
+  stats->split_seconds = now_seconds() - start;
+
+  start = now_seconds();
+  bignum_set_i64(&root, 10005);
+  bignum_shift(&root, &root, (long)(2 * limbs));
+  bignum_sqrt(&root, &root);
+  stats->sqrt_seconds = now_seconds() - start;
+
+  start = now_seconds();
+  bignum_mul_small(&root, &root, 426880);
+  bignum_mul(&Q, &Q, &root);
+  bignum_div(pi, &Q, &T);
+  stats->divide_seconds = now_seconds() - start;
+
+  bignum_free(&P);
+  bignum_free(&Q);
+  bignum_free(&T);
+  bignum_free(&root);
+}
+
+char *pi_chudnovsky(size_t digits, pi_chudnovsky_stats *stats)
+{
+  pi_chudnovsky_stats local;
+  if (!stats)
+    stats = &local;
+  memset(stats, 0, sizeof(*stats));
+  stats->terms = (size_t)(digits / PI_CHUDNOVSKY_DIGITS_PER_TERM) + 2;
+
+  const size_t limbs = digits / BIGNUM_DIGITS + GUARD_LIMBS;
+  const double start = now_seconds();
+  bignum pi;
+  bignum_init(&pi);
+
+#pragma omp parallel
+#pragma omp single
+  evaluate(stats->terms, limbs, &pi, stats);
+
+  // pi holds "3" followed by 9 limbs digits: insert the point and truncate.
+  char *text = bignum_to_string(&pi);
+  bignum_free(&pi);
+  if (!text)
+    return NULL;
+  memmove(text + 2, text + 1, digits);
+  text[1] = '.';
+  text[digits + 2] = '\0';
+  stats->seconds = now_seconds() - start;
+  return text;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file pi_chudnovsky.h
+ * @brief PI to arbitrary precision: Chudnovsky series by parallel binary splitting.
+ *
+ * The double-precision series engine (pi_series.h) stops at 15 decimal
+ * places. This mode evaluates the Chudnovsky series exactly with bignum.h:
+ *
+ *   PI = 426880 sqrt(10005) Q(0, N) / T(0, N)
+ *
+ * where P, Q and T of a range of terms are built by binary splitting
+ * (P = P1 P2, Q = Q1 Q2, T = T1 Q2 + P1 T2), so the work is a tree of
+ * large products instead of N divisions. The two halves of each range are
+ * OpenMP tasks, and so are the independent products of each merge; the
+ * large products near the root additionally split their FFT stages into
+ * taskloops. The square root and the final division are Newton
+ * iterations on the same multiplication.
+ */
+
+#ifndef PI_CHUDNOVSKY_H
+#define PI_CHUDNOVSKY_H
+
+#include <stddef.h>
+
+#define PI_CHUDNOVSKY_DIGITS_PER_TERM 14.181647462725477 ///< log10(640320^3 / 1728): digits added per term.
+#define PI_CHUDNOVSKY_TASK_TERMS 64                      ///< Ranges shorter than this are split without tasks.
+
+/**
+ * @struct pi_chudnovsky_stats
+ * @brief Terms and time per phase of a computation.
+ */
+typedef struct
+{
+  size_t terms;          ///< Terms of the series.
+  double split_seconds;  ///< Binary splitting.
+  double sqrt_seconds;   ///< Square root of 10005.
+  double divide_seconds; ///< Final multiplication and division.
+  double seconds;        ///< Total, including the conversion to text.
+} pi_chudnovsky_stats;
+
+/**
+ * @brief Computes PI with `digits` decimal places, using the threads of omp_get_max_threads().
+ * @param digits Decimal places (> 0).
+ * @param stats Filled with the terms and timings, or NULL.
+ * @return "3.1415..." with exactly `digits` places (truncated), allocated with malloc; NULL on allocation failure.
+ */
+char *pi_chudnovsky(size_t digits, pi_chudnovsky_stats *stats);
+
+#endif
@@ -0,0 +1,333 @@
+/**
+ * @file pi_series.c
+ * @brief Series engine for approximating PI: SIMD blocks, OpenMP threads, numeric convergence check.
+ */
+
+#include "pi_series.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define TERM_BUFFER 2048 ///< Terms generated at once (16 KB of doubles, fits in L1).
+
+/**
+ * @brief Adds x to a Kahan sum (sum, compensation).
+ */
+#define KAHAN_ADD(sum, comp, x)  \
+  do                             \
+  {                              \
+    double y_ = (x) - (comp);    \
+    double t_ = (sum) + y_;      \
+    (comp) = (t_ - (sum)) - y_;  \
+    (sum) = t_;                  \
+  } while (0)
+
+/**
+ * @brief Reads CLOCK_MONOTONIC in seconds.
+ */
+static double now_seconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Sums terms [first, first + count) generated TERM_BUFFER at a time by `fill`.
+ *
+ * Each buffer is summed with the SIMD kernel of the method; the buffer sums
+ * are added with Kahan summation (plain addition for REDUCE_PLAIN).
+ */
+static double sum_generated(size_t first, size_t count, reduce_method method,
+                            void (*fill)(double *buffer, size_t first, int n))
+{
+  double buffer[TERM_BUFFER];
+  const reduce_f64_fn kernel = reduce_sum_f64_for(method, REDUCE_DEFAULT_ACCUMULATORS);
+  double sum = 0.0, comp = 0.0;
+  for (size_t done = 0; done < count; done += TERM_BUFFER)
+  {
+    const int n = count - done < TERM_BUFFER ? (int)(count - done) : TERM_BUFFER;
+    fill(buffer, first + done, n);
+    const double block = kernel(buffer, (size_t)n);
+    if (method == REDUCE_PLAIN)
+      sum += block;
+    else
+      KAHAN_ADD(sum, comp, block);
+  }
+  return sum;
+}
+
+/* ----- Leibniz: PI = 4 sum (-1)^k / (2k + 1) ----- */
+
+/**
+ * @brief Writes Leibniz terms first .. first + n - 1 (the sign alternates with the index parity).
+ */
+static void leibniz_fill(double *buffer, size_t first, int n)
+{
+  const double k0 = (double)first;
+  const double s0 = first & 1 ? -4.0 : 4.0;
+#pragma omp simd
+  for (int j = 0; j < n; j++)
+  {
+    buffer[j] = (j & 1 ? -s0 : s0) / (2.0 * (k0 + j) + 1.0);
+  }
+}
+
+static double leibniz_partial(size_t first, size_t count, reduce_method method)
+{
+  return sum_generated(first, count, method, leibniz_fill);
+}
+
+static double identity_value(double sum)
+{
+  return sum;
+}
+
+/**
+ * @brief Alternating series with decreasing terms: the error is below the first omitted term.
+ */
+static double leibniz_bound(size_t terms, double sum)
+{
+  (void)sum;
+  return 4.0 / (2.0 * (double)terms + 1.0);
+}
+
+/* ----- Euler transform of Leibniz: PI = 2 sum n! / (2n + 1)!!, t_n = t_(n-1) n / (2n + 1) ----- */
+
+/**
+ * @brief Term t_n of the Euler-transformed series.
+ */
+static double euler_term(size_t n)
+{
+  double term = 1.0;
+  for (size_t k = 1; k <= n && term > 0.0; k++)
+    term *= (double)k / (2.0 * k + 1.0);
+  return term;
+}
+
+static double euler_partial(size_t first, size_t count, reduce_method method)
+{
+  (void)method;
+  double term = euler_term(first);
+  double sum = 0.0, comp = 0.0;
+  for (size_t n = first; n < first + count && term > 0.0; n++)
+  {
+    KAHAN_ADD(sum, comp, term);
+    term *= (double)(n + 1) / (2.0 * (n + 1) + 1.0);
+  }
+  return sum;
+}
+
+static double euler_value(double sum)
+{
+  return 2.0 * sum;
+}
+
+/**
+ * @brief The term ratio is below 1/2, so the tail is below twice the first omitted term.
+ */
+static double euler_bound(size_t terms, double sum)
+{
+  (void)sum;
+  return 4.0 * euler_term(terms);
+}
+
+/* ----- Machin: PI = 16 atan(1/5) - 4 atan(1/239) ----- */
+
+/**
+ * @brief Magnitude of term k of 16 atan(1/5) and of 4 atan(1/239).
+ */
+static void machin_terms(size_t k, double *term5, double *term239)
+{
+  const double power = 2.0 * (double)k + 1.0;
+  *term5 = 16.0 * pow(5.0, -power) / power;
+  *term239 = 4.0 * pow(239.0, -power) / power;
+}
+
+static double machin_partial(size_t first, size_t count, reduce_method method)
+{
+  (void)method;
+  double sum = 0.0, comp = 0.0;
+  for (size_t k = first; k < first + count; k++)
+  {
+    double term5, term239;
+    machin_terms(k, &term5, &term239);
+    if (term5 == 0.0)
+      break;
+    KAHAN_ADD(sum, comp, (k & 1 ? -1.0 : 1.0) * (term5 - term239));
+  }
+  return sum;
+}
+
+/**
+ * @brief Both arctangents are alternating with decreasing terms.
+ */
+static double machin_bound(size_t terms, double sum)
+{
+  (void)sum;
+  double term5, term239;
+  machin_terms(terms, &term5, &term239);
+  return term5 + term239;
+}
+
+/* ----- Chudnovsky: 1 / PI = 12 sum (-1)^k (6k)! (13591409 + 545140134 k) / ((3k)! (k!)^3 640320^(3k + 3/2)) ----- */
+
+#define CHUDNOVSKY_C3_24 10939058860032000.0 ///< 640320^3 / 24.
+
+/**
+ * @brief Term k of S, where PI = 426880 sqrt(10005) / S.
+ *
+ * a_k = a_(k-1) (-(6k - 5)(2k - 1)(6k - 1)) / (k^3 640320^3 / 24), and the
+ * term is a_k (13591409 + 545140134 k). Each term adds about 14 digits.
+ */
+static double chudnovsky_term(size_t k)
+{
+  double a = 1.0;
+  for (size_t j = 1; j <= k && a != 0.0; j++)
+  {
+    const double jd = (double)j;
+    a *= -(6.0 * jd - 5.0) * (2.0 * jd - 1.0) * (6.0 * jd - 1.0) / (jd * jd * jd * CHUDNOVSKY_C3_24);
+  }
+  return a * (13591409.0 + 545140134.0 * (double)k);
+}
+
+static double chudnovsky_partial(size_t first, size_t count, reduce_method method)
+{
+  (void)method;
+  double sum = 0.0, comp = 0.0;
+  for (size_t k = first; k < first + count; k++)
+    KAHAN_ADD(sum, comp, chudnovsky_term(k));
+  return sum;
+}
+
+static double chudnovsky_value(double sum)
+{
+  return 426880.0 * sqrt(10005.0) / sum;
+}
+
+/**
+ * @brief PI is inversely proportional to S, so a relative change of S is the relative error of PI.
+ */
+static double chudnovsky_bound(size_t terms, double sum)
+{
+  if (sum == 0.0)
+    return INFINITY;
+  return 2.0 * fabs(chudnovsky_term(terms) / sum) * chudnovsky_value(sum);
+}
+
+/**
+ * @brief Registered series.
+ */
+static const pi_series registry[] = {
+    {"leibniz", PI_SERIES_FIRST_BLOCK, leibniz_partial, identity_value, leibniz_bound},
+    {"euler", 1, euler_partial, euler_value, euler_bound},
+    {"machin", 1, machin_partial, identity_value, machin_bound},
+    {"chudnovsky", 1, chudnovsky_partial, chudnovsky_value, chudnovsky_bound},
+};
+
+const pi_series *pi_series_find(const char *name)
+{
+  for (size_t s = 0; s < sizeof(registry) / sizeof(registry[0]); s++)
+  {
+    if (strcmp(registry[s].name, name) == 0)
+      return &registry[s];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Sums one block, split into one contiguous range per thread when it is long enough.
+ *
+ * The partial sums are combined in thread order, so a given thread count
+ * always gives the same result. Without a partials array (or OpenMP), the
+ * block is summed by the calling thread.
+ */
+static double sum_block(const pi_series *series, size_t first, size_t count, reduce_method method, double *partials)
+{
+#ifdef _OPENMP
+  if (partials && count >= PI_SERIES_PARALLEL_BLOCK && omp_get_max_threads() > 1)
+  {
+    int threads = 1;
+#pragma omp parallel
+    {
+      const int t = omp_get_thread_num();
+      const int total = omp_get_num_threads();
+      const size_t begin = count * t / total;
+      const size_t end = count * (t + 1) / total;
+      partials[t] = series->partial(first + begin, end - begin, method);
+      if (t == 0)
+        threads = total;
+    }
+    double sum = 0.0, comp = 0.0;
+    for (int t = 0; t < threads; t++)
+      KAHAN_ADD(sum, comp, partials[t]);
+    return sum;
+  }
+#else
+  (void)partials;
+#endif
+  return series->partial(first, count, method);
+}
+
+pi_series_state pi_series_run(const pi_series *series, const pi_series_options *options, pi_series_callback callback,
+                              void *arg)
+{
+  pi_series_state state = {0, 0.0, INFINITY, 0.0, 0};
+  const int digits = options->digits < PI_SERIES_MAX_DIGITS ? options->digits : PI_SERIES_MAX_DIGITS;
+  const double target = 0.5 * pow(10.0, -digits);
+
+#ifdef _OPENMP
+  double *partials = (double *)calloc((size_t)omp_get_max_threads(), sizeof(double));
+#else
+  double *partials = NULL;
+#endif
+  const double start = now_seconds();
+  double sum = 0.0, comp = 0.0;
+  size_t block = series->first_block ? series->first_block : 1;
+
+  while (options->max_terms == 0 || state.terms < options->max_terms)
+  {
+    size_t count = block;
+    if (options->max_terms && count > options->max_terms - state.terms)
+      count = options->max_terms - state.terms;
+
+    const double part = sum_block(series, state.terms, count, options->method, partials);
+    if (options->method == REDUCE_PLAIN)
+      sum += part;
+    else
+      KAHAN_ADD(sum, comp, part);
+
+    state.terms += count;
+    state.pi = series->value(sum);
+    state.bound = series->error_bound(state.terms, sum);
+    state.seconds = now_seconds() - start;
+    state.converged = state.bound <= target;
+    if ((callback && callback(&state, arg)) || state.converged)
+      break;
+    if (block < PI_SERIES_MAX_BLOCK)
+      block *= 2;
+  }
+
+  free(partials);
+  return state;
+}
+
+int pi_correct_decimal_places(double approx, double reference)
+{
+  if (floor(approx) != floor(reference))
+    return 0;
+  double scale = 1.0;
+  for (int d = 1; d <= PI_SERIES_MAX_DIGITS; d++)
+  {
+    scale *= 10.0;
+    if (floor(approx * scale) != floor(reference * scale))
+      return d - 1;
+  }
+  return PI_SERIES_MAX_DIGITS;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file pi_series.h
+ * @brief Series engine for approximating PI: SIMD blocks, OpenMP threads, numeric convergence check.
+ *
+ * The first version of this task added one Leibniz term per iteration and
+ * compared the approximation with M_PI through two `snprintf("%.15f")`
+ * calls per term, so formatting dominated the runtime and the loop never
+ * ended. Here a series is summed in blocks: the terms of a block are
+ * generated into small L1-resident buffers (a loop the compiler
+ * vectorizes), summed with the SIMD kernels of common/reduce.h (plain,
+ * Kahan or pairwise) and, for long blocks, split across OpenMP threads
+ * whose partial sums are combined in thread order. Convergence is checked
+ * only between blocks, against an error bound computed from the series
+ * itself, and the run stops once the bound is below the requested number
+ * of decimal places (or after a maximum number of terms).
+ *
+ * Blocks start small and double up to PI_SERIES_MAX_BLOCK terms, so the
+ * digits gained early are still reported close to the term where they
+ * appear.
+ *
+ * Series are pluggable (pi_series): Leibniz, Leibniz accelerated by the
+ * Euler transform, Machin's formula and Chudnovsky's formula are provided.
+ */
+
+#ifndef PI_SERIES_H
+#define PI_SERIES_H
+
+#include <stddef.h>
+
+#include "../common/reduce.h"
+
+#define PI_SERIES_FIRST_BLOCK 64            ///< Terms of the first block of slow series.
+#define PI_SERIES_MAX_BLOCK (1UL << 26)     ///< Largest block between two convergence checks.
+#define PI_SERIES_PARALLEL_BLOCK (1UL << 16) ///< Blocks at least this long are split across threads.
+#define PI_SERIES_MAX_DIGITS 15             ///< Decimal places a double can resolve.
+
+/**
+ * @struct pi_series
+ * @brief A series whose partial sums converge to PI.
+ */
+typedef struct
+{
+  const char *name;   ///< Name used on the command line.
+  size_t first_block; ///< Terms of the first block (1 for fast series, so every term is reported).
+
+  /**
+   * @brief Sums terms [first, first + count).
+   *
+   * Called concurrently on disjoint ranges, so it must not keep state.
+   */
+  double (*partial)(size_t first, size_t count, reduce_method method);
+
+  /**
+   * @brief Approximation of PI from the sum of the first terms.
+   */
+  double (*value)(double sum);
+
+  /**
+   * @brief Bound on |PI - value(sum)| after `terms` terms.
+   */
+  double (*error_bound)(size_t terms, double sum);
+} pi_series;
+
+/**
+ * @struct pi_series_options
+ * @brief When to stop and how to sum.
+ */
+typedef struct
+{
+  int digits;           ///< Stop once the error bound is below 0.5e-digits.
+  size_t max_terms;     ///< Stop after this many terms (0 for no limit).
+  reduce_method method; ///< Summation inside each block.
+} pi_series_options;
+
+/**
+ * @struct pi_series_state
+ * @brief Progress of a run, reported after every block.
+ */
+typedef struct
+{
+  size_t terms;    ///< Terms summed so far.
+  double pi;       ///< Current approximation.
+  double bound;    ///< Error bound of the approximation.
+  double seconds;  ///< Time since the start of the run.
+  int converged;   ///< 1 once the bound reached the requested digits.
+} pi_series_state;
+
+/**
+ * @brief Called after every block; return non-zero to stop the run.
+ */
+typedef int (*pi_series_callback)(const pi_series_state *state, void *arg);
+
+/**
+ * @brief Sums a series block by block until it converges or reaches max_terms.
+ * @param series Series to sum.
+ * @param options Stop criterion and summation method.
+ * @param callback Called after every block, or NULL.
+ * @param arg Passed to callback.
+ * @return State after the last block.
+ */
+pi_series_state pi_series_run(const pi_series *series, const pi_series_options *options, pi_series_callback callback,
+                              void *arg);
+
+/**
+ * @brief Returns the series with the given name ("leibniz", "euler", "machin", "chudnovsky"), or NULL.
+ */
+const pi_series *pi_series_find(const char *name);
+
+/**
+ * @brief Number of leading decimal places on which two values agree (truncated, at most PI_SERIES_MAX_DIGITS).
+ *
+ * Compares floor(x * 10^d) numerically, without formatting strings.
+ */
+int pi_correct_decimal_places(double approx, double reference);
+
+#endif
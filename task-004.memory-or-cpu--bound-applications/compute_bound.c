@@ -1,36 +1,313 @@
+/**
+ * @file compute_bound.c
+ * @brief Compute-bound benchmark: a transcendental expression per element, summed over N elements.
+ *
+ * Each element i contributes
+ *
+ *   x = sin(i) log(i + 1) + cos(i) exp(fmod(i, 1000) / 1000)
+ *   (pow(|x|, 0.5) + sqrt(|x| + 1)) / (i + 1)
+ *
+ * The first version used exp(fmod(i, 1000)), which overflows for
+ * fmod(i, 1000) > 709, and pow of a negative x, so the result was inf or
+ * NaN; it also added to `result` from every thread without a reduction.
+ * The argument of exp is now scaled to [0, 1) and pow/sqrt take |x|, which
+ * keeps the same operations per element with a finite result.
+ *
+ * Two engines sum the same elements:
+ *
+ * - the scalar reference, one libm call per function and element;
+ * - the vector engine (compute_kernel.h), with the inlined polynomial
+ *   approximations of vecmath.h in a `#pragma omp simd` loop, at the
+ *   accuracy tier chosen with --ulp.
+ *
+ * Both split [1, N] into one contiguous range per thread and add the
+ * partial sums in thread order, so a given thread count always gives the
+ * same result. The program prints elements/s and GFLOP/s of each engine.
+ *
+ * With --sweep, the vector engine runs for every thread count of a list
+ * (sweep.h) and the times go to one CSV with speedup and efficiency.
+ */
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
-#include <omp.h>
-#include <math.h>
 
-#define N 1000000000  // 1 bilhão
+#include "compute_kernel.h"
+#include "sweep.h"
+
+#define N COMPUTE_N
+#define DEFAULT_ULP 4.0
+#define CHECK_SAMPLES 1000000 ///< Arguments per function in --check.
+
+/**
+ * @brief Sum of the elements [first, last].
+ */
+typedef double (*range_fn)(long first, long last);
+
+/**
+ * @struct engine
+ * @brief A way of computing the elements.
+ */
+typedef struct
+{
+  const char *name;  ///< Tier name, or "libm" for the reference.
+  double max_ulp;    ///< Error bound of the functions (0 for libm).
+  int flops;         ///< Floating-point operations per element (FMA = 2).
+  range_fn sum;      ///< Sums a range of elements.
+} engine;
+
+/**
+ * @struct ulp_report
+ * @brief Largest error of each function of a tier, in ULP.
+ */
+typedef struct
+{
+  double sin, cos, exp, log, pow;
+} ulp_report;
+
+/**
+ * @brief Reads the wall clock in seconds.
+ */
+double now_seconds(void)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+/* ----- Scalar reference ----- */
+
+/**
+ * @brief Element i with libm.
+ */
+double reference_element(double i)
+{
+  double x = sin(i) * log(i + 1.0) + cos(i) * exp(fmod(i, 1000.0) / 1000.0);
+  x = fabs(x);
+  return (pow(x, 0.5) + sqrt(x + 1.0)) / (i + 1.0);
+}
+
+double reference_sum(long first, long last)
+{
+  double sum = 0.0;
+  for (long i = first; i <= last; i++)
+    sum += reference_element((double)i);
+  return sum;
+}
+
+/* ----- Vector engine ----- */
+
+/**
+ * @brief Defines the accuracy check of a tier.
+ */
+#define DEFINE_TIER_CHECK(name, ulp, ST, CT, ET, LT)                                     \
+  ulp_report check_##name(void)                                                        \
+  {                                                                                    \
+    ulp_report report = {0, 0, 0, 0, 0};                                               \
+    srand(1);                                                                          \
+    for (int k = 0; k < CHECK_SAMPLES; k++)                                            \
+    {                                                                                  \
+      const double i = (double)(rand() % N + 1);                                       \
+      const double y = (k % 1000) / 1000.0;                                            \
+      const double z = 1e-3 + 40.0 * rand() / RAND_MAX;                                \
+      const vecmath_sincos_t sc = vecmath_sincos(i, ST, CT);                           \
+      report.sin = fmax(report.sin, ulp_error(sc.sin, sin(i)));                        \
+      report.cos = fmax(report.cos, ulp_error(sc.cos, cos(i)));                        \
+      report.exp = fmax(report.exp, ulp_error(vecmath_exp(y, ET), exp(y)));            \
+      report.log = fmax(report.log, ulp_error(vecmath_log(i, LT), log(i)));            \
+      report.pow = fmax(report.pow, ulp_error(vecmath_pow(z, 0.5, ET, LT), pow(z, 0.5))); \
+    }                                                                                  \
+    return report;                                                                     \
+  }
+
+/**
+ * @brief |value - reference| in units of the last place of reference.
+ */
+double ulp_error(double value, double reference)
+{
+  const double magnitude = fabs(reference);
+  return fabs(value - reference) / (nextafter(magnitude, INFINITY) - magnitude);
+}
+
+VECMATH_TIERS(COMPUTE_DEFINE_TIER)
+VECMATH_TIERS(DEFINE_TIER_CHECK)
+
+#define TIER_ENGINE(name, ulp, ST, CT, ET, LT) {#name, ulp, compute_tier_flops(ST, CT, ET, LT), compute_sum_##name},
+#define TIER_CHECK(name, ulp, ST, CT, ET, LT) check_##name,
+
+/* ----- Driver ----- */
+
+/**
+ * @brief Sums [1, n] with one contiguous range per thread, adding the partial sums in thread order.
+ * @return 0 on success, -1 if the partial sums could not be allocated.
+ */
+int run_engine(const engine *e, long n, int threads, double *result, double *seconds)
+{
+  double *partials = (double *)calloc((size_t)threads, sizeof(double));
+  if (!partials)
+    return -1;
+  int used = 1;
+  const double start = now_seconds();
+#pragma omp parallel num_threads(threads)
+  {
+    const int t = omp_get_thread_num();
+    const int total = omp_get_num_threads();
+    const long first = 1 + (long)((double)n * t / total);
+    const long last = (long)((double)n * (t + 1) / total);
+    partials[t] = first <= last ? e->sum(first, last) : 0.0;
+    if (t == 0)
+      used = total;
+  }
+  *seconds = now_seconds() - start;
+
+  *result = 0.0;
+  for (int t = 0; t < used; t++)
+    *result += partials[t];
+  free(partials);
+  return 0;
+}
+
+/**
+ * @brief Prints the throughput of one engine.
+ */
+void print_engine(const engine *e, long n, double seconds)
+{
+  if (e->max_ulp > 0.0)
+    printf("  vecmath %-5s (<= %g ULP): %10.3e elements/s, %7.2f GFLOP/s\n", e->name, e->max_ulp, n / seconds,
+           (double)n * e->flops / seconds / 1e9);
+  else
+    printf("  scalar libm reference    : %10.3e elements/s, %7.2f GFLOP/s (same operation count)\n", n / seconds,
+           (double)n * e->flops / seconds / 1e9);
+}
+
+/**
+ * @brief Prints the measured error of every tier against libm.
+ */
+void print_check(const engine *tiers, int count)
+{
+  ulp_report (*const checks[])(void) = {VECMATH_TIERS(TIER_CHECK)};
+  printf("Tier   | Bound (ULP) |     sin |     cos |     exp |     log | pow(x, 0.5)\n");
+  printf("-----------------------------------------------------------------------\n");
+  for (int t = 0; t < count; t++)
+  {
+    const ulp_report report = checks[t]();
+    printf("%-6s | %11g | %7.3g | %7.3g | %7.3g | %7.3g | %7.3g\n", tiers[t].name, tiers[t].max_ulp, report.sin,
+           report.cos, report.exp, report.log, report.pow);
+  }
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+void print_usage(const char *program)
+{
+  printf("Usage: %s [threads] [--n N] [--ulp U] [--no-reference] [--check]\n"
+         "       [--sweep LIST] [--affinity none|close|spread] [--csv PATH]\n",
+         program);
+}
 
-int main(int argc, char *argv[]) {
-    struct timeval start, end;
-    double elapsed_time;
-    int num_threads = 1;
+int main(int argc, char *argv[])
+{
+  const engine tiers[] = {VECMATH_TIERS(TIER_ENGINE)};
+  const int tier_count = (int)(sizeof(tiers) / sizeof(tiers[0]));
+  int num_threads = 1;
+  long n = N;
+  double max_ulp = DEFAULT_ULP;
+  int reference = 1, check = 0;
+  sweep threads_sweep = {.length = 0, .affinity = SWEEP_AFFINITY_NONE};
+  const char *csv = NULL;
 
-    if (argc > 1) {
-        num_threads = atoi(argv[1]);
+  for (int i = 1; i < argc; i++)
+  {
+    if (i == 1 && atoi(argv[i]) > 0)
+      num_threads = atoi(argv[i]);
+    else if (strcmp(argv[i], "--n") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+      n = atol(argv[++i]);
+    else if (strcmp(argv[i], "--ulp") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0.0)
+      max_ulp = atof(argv[++i]);
+    else if (strcmp(argv[i], "--no-reference") == 0)
+      reference = 0;
+    else if (strcmp(argv[i], "--check") == 0)
+      check = 1;
+    else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc && sweep_parse(&threads_sweep, argv[i + 1]) == 0)
+      i++;
+    else if (strcmp(argv[i], "--affinity") == 0 && i + 1 < argc &&
+             sweep_parse_affinity(&threads_sweep, argv[i + 1]) == 0)
+      i++;
+    else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+      csv = argv[++i];
+    else
+    {
+      print_usage(argv[0]);
+      return 1;
     }
+  }
+
+  if (check)
+  {
+    print_check(tiers, tier_count);
+    return 0;
+  }
 
-    double result = 0.0;
-    gettimeofday(&start, NULL);
-    #pragma omp parallel num_threads(num_threads)
+  // Tiers go from the most accurate to the fastest: take the fastest within the bound.
+  const engine *vector = NULL;
+  for (int t = 0; t < tier_count; t++)
+  {
+    if (tiers[t].max_ulp <= max_ulp)
+      vector = &tiers[t];
+  }
+  if (!vector)
+  {
+    printf("No tier is accurate to %g ULP (the most accurate is %g ULP)\n", max_ulp, tiers[0].max_ulp);
+    return 1;
+  }
+
+  if (threads_sweep.length > 0)
+  {
+    for (int k = 0; k < threads_sweep.length; k++)
     {
-        #pragma omp for
-        for (long i = 1; i <= N; i++) {
-            double x = sin(i) * log(i + 1) + cos(i) * exp(fmod(i, 1000));
-            x = pow(x, 0.5) + sqrt(x + 1.0);
-            result += x / (i + 1);
-        }
+      const int threads = threads_sweep.counts[k];
+      sweep_apply_affinity(&threads_sweep, threads);
+      double result;
+      if (run_engine(vector, n, threads, &result, &threads_sweep.seconds[k]) != 0)
+      {
+        printf("Memory allocation failed!\n");
+        return 1;
+      }
+      printf("Compute-bound with %d threads: %f seconds (result: %.15g)\n", threads, threads_sweep.seconds[k], result);
+      fflush(stdout);
     }
-    gettimeofday(&end, NULL);
+    return csv && sweep_write_csv(&threads_sweep, csv) != 0 ? 1 : 0;
+  }
 
-    elapsed_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
-    printf("Compute-bound with %d threads: %f seconds (result: %f)\n", num_threads, elapsed_time, result);
-    fflush(stdout);
+  sweep_apply_affinity(&threads_sweep, num_threads);
+  double result, seconds;
+  if (run_engine(vector, n, num_threads, &result, &seconds) != 0)
+  {
+    printf("Memory allocation failed!\n");
+    return 1;
+  }
+  printf("Compute-bound with %d threads: %f seconds (result: %.15g)\n", num_threads, seconds, result);
+  print_engine(vector, n, seconds);
 
-    return 0;
+  if (reference)
+  {
+    const engine libm = {"libm", 0.0, vector->flops, reference_sum};
+    double expected, reference_seconds;
+    if (run_engine(&libm, n, num_threads, &expected, &reference_seconds) != 0)
+    {
+      printf("Memory allocation failed!\n");
+      return 1;
+    }
+    print_engine(&libm, n, reference_seconds);
+    printf("  speedup over libm: %.2fx, relative difference: %.3e (result: %.15g)\n", reference_seconds / seconds,
+           fabs(result - expected) / fabs(expected), expected);
+  }
+  fflush(stdout);
+
+  return 0;
 }
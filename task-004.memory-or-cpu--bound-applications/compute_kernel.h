@@ -0,0 +1,80 @@
+/**
+ * @file compute_kernel.h
+ * @brief Vectorized element kernel of compute_bound.c, shared with the roofline tool.
+ *
+ * Element i is
+ *
+ *   x = sin(i) log(i + 1) + cos(i) exp(fmod(i, 1000) / 1000)
+ *   (pow(|x|, 0.5) + sqrt(|x| + 1)) / (i + 1)
+ *
+ * computed with vecmath.h. COMPUTE_DEFINE_TIER instantiates, for one
+ * accuracy tier of VECMATH_TIERS, the element function and
+ * compute_sum_<tier>(first, last), a `#pragma omp simd` sum of the
+ * elements [first, last]. Build with -fno-math-errno, or `sqrt` keeps the
+ * loop scalar.
+ */
+
+#ifndef COMPUTE_KERNEL_H
+#define COMPUTE_KERNEL_H
+
+#include <math.h>
+
+#include "vecmath.h"
+
+#define COMPUTE_N 1000000000 // 1 bilhão
+
+/**
+ * @brief Compiles a kernel for AVX-512, AVX2+FMA and baseline x86-64, selected at load time.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define COMPUTE_TARGET_CLONES __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define COMPUTE_TARGET_CLONES
+#endif
+
+/**
+ * @brief fmod(x, 1000) for a non-negative integer x below 2^52, exact and branch-free.
+ */
+VECMATH_INLINE double compute_wrap_1000(double x)
+{
+  const double q = (x * 0.001 + VECMATH_SHIFTER) - VECMATH_SHIFTER;
+  double r = x - 1000.0 * q;
+  r = r < 0.0 ? r + 1000.0 : r;
+  return r >= 1000.0 ? r - 1000.0 : r;
+}
+
+/**
+ * @brief Operations per element of a tier, counted in vecmath.h (FMA = 2).
+ */
+static inline int compute_tier_flops(int sin_terms, int cos_terms, int exp_terms, int log_terms)
+{
+  const int sincos = 12 + (2 * (sin_terms - 2) + 3) + (2 * (cos_terms - 3) + 8);
+  const int exp = 8 + 2 * (exp_terms - 1);
+  const int log = 11 + 2 * (log_terms - 1);
+  const int pow = 1 + exp + log;
+  return sincos + log + exp + pow + 15;
+}
+
+/**
+ * @brief Defines the element function and the range sum of a tier.
+ */
+#define COMPUTE_DEFINE_TIER(name, ulp, ST, CT, ET, LT)                                                  \
+  VECMATH_INLINE double compute_element_##name(double i)                                               \
+  {                                                                                                    \
+    const vecmath_sincos_t sc = vecmath_sincos(i, ST, CT);                                             \
+    double x = sc.sin * vecmath_log(i + 1.0, LT) + sc.cos * vecmath_exp(compute_wrap_1000(i) * 0.001, ET); \
+    x = fabs(x);                                                                                       \
+    return (vecmath_pow(x, 0.5, ET, LT) + sqrt(x + 1.0)) / (i + 1.0);                                  \
+  }                                                                                                    \
+                                                                                                       \
+  COMPUTE_TARGET_CLONES static double compute_sum_##name(long first, long last)                        \
+  {                                                                                                    \
+    double sum = 0.0;                                                                                  \
+    _Pragma("omp simd reduction(+ : sum)") for (long i = first; i <= last; i++)                        \
+    {                                                                                                  \
+      sum += compute_element_##name((double)i);                                                        \
+    }                                                                                                  \
+    return sum;                                                                                        \
+  }
+
+#endif
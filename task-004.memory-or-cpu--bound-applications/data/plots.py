@@ -66,3 +66,49 @@ plt.grid(True)
 plt.tight_layout()
 plt.savefig("./task-4.memory-or-cpu--bound-applications/data/performance_analysis.png", dpi=300)
 plt.show()
+
+# === ROOFLINE ===
+
+import os
+import numpy as np
+
+roofline_path = "./task-4.memory-or-cpu--bound-applications/data/roofline.csv"
+if os.path.exists(roofline_path):
+    rf = pd.read_csv(roofline_path)
+    peak = rf[rf["type"] == "peak"]["gflops"].iloc[0]
+    bandwidth = rf[rf["type"] == "bandwidth"]
+    kernels = rf[rf["type"] == "kernel"]
+
+    # Intensidades finitas dos kernels definem o eixo x; kernels sem tráfego (intensidade inf) ficam na borda direita
+    finite = kernels["intensity"].replace(np.inf, np.nan).dropna()
+    x_min = min(1e-3, finite.min() / 2) if len(finite) else 1e-3
+    x_max = 1e3
+    x = np.logspace(np.log10(x_min), np.log10(x_max), 200)
+
+    plt.figure(figsize=(10, 7))
+    plt.plot(x, np.full_like(x, peak), "k-", linewidth=2, label=f"Pico FMA ({peak:.1f} GFLOP/s)")
+
+    # Teto de banda de cada nível: melhor kernel STREAM do nível
+    for level in ["L1", "L2", "L3", "DRAM"]:
+        level_rows = bandwidth[bandwidth["level"] == level]
+        if level_rows.empty:
+            continue
+        gbs = level_rows["gbytes_per_s"].max()
+        plt.plot(x, np.minimum(peak, x * gbs), "--", label=f"{level} ({gbs:.1f} GB/s)")
+
+    for _, row in kernels.iterrows():
+        intensity = row["intensity"] if np.isfinite(row["intensity"]) else x_max
+        plt.scatter(intensity, row["gflops"], s=60, zorder=3)
+        plt.annotate(row["name"], (intensity, row["gflops"]), textcoords="offset points", xytext=(-10, 8),
+                     ha="right" if intensity == x_max else "left", fontsize=8)
+
+    plt.xscale("log")
+    plt.yscale("log")
+    plt.title("Roofline")
+    plt.xlabel("Intensidade aritmética (FLOP/byte)")
+    plt.ylabel("Desempenho (GFLOP/s)")
+    plt.legend(loc="lower right")
+    plt.grid(True, which="both", alpha=0.3)
+    plt.tight_layout()
+    plt.savefig("./task-4.memory-or-cpu--bound-applications/data/roofline.png", dpi=300)
+    plt.show()
@@ -0,0 +1,413 @@
+/**
+ * @file latency.c
+ * @brief Memory latency probe: ns per dependent load for working sets from L1 to DRAM.
+ *
+ * memory_bound.c and roofline.c measure throughput; this program measures
+ * latency. For each working-set size it links one node per cache line into
+ * a single random cycle (Sattolo's algorithm) and follows it: every load
+ * takes its address from the previous one, so neither out-of-order
+ * execution nor the hardware prefetchers can overlap them, and the time per
+ * load is the latency of the level that holds the working set (TLB misses
+ * included, which is what --hugepages changes).
+ *
+ * Options:
+ *
+ * - --hugepages: backs the buffer with 2 MB pages (MAP_HUGETLB, or
+ *   transparent huge pages if none are reserved); by default the buffer
+ *   uses 4 KB pages (MADV_NOHUGEPAGE), so both cases are explicit. The
+ *   table and the CSV report the backing each buffer actually got;
+ * - --cpu-node N / --mem-node M: pins the chasing thread to the CPUs of
+ *   node N and binds the buffer to node M (mbind), so local and remote
+ *   latency can be compared without libnuma;
+ * - --load T: loaded latency, T more threads stream over their own buffers
+ *   (on the memory node, if one is given) while the chase runs; the
+ *   background bandwidth they reach is reported with the latency.
+ */
+
+#define _GNU_SOURCE
+#include <omp.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define DEFAULT_OUTPUT "./task-4.memory-or-cpu--bound-applications/data/latency.csv"
+#define CACHE_LINE 64
+#define HUGE_PAGE (2UL << 20)
+#define MIN_KB 4                  ///< Smallest working set of the sweep.
+#define DEFAULT_MAX_MB 1024       ///< Largest working set of the sweep.
+#define LOADS (1L << 22)          ///< Timed loads per measurement.
+#define TRIALS 3                  ///< Measurements per size; the best one is kept.
+#define DEFAULT_LOAD_MB 256       ///< Buffer of each background thread.
+#define MPOL_BIND_MODE 2          ///< MPOL_BIND from <linux/mempolicy.h>.
+
+/**
+ * @struct node
+ * @brief One cache line of the cycle.
+ */
+typedef struct node
+{
+  struct node *next;
+  char pad[CACHE_LINE - sizeof(struct node *)];
+} node;
+
+/**
+ * @enum page_backing
+ * @brief Pages a buffer actually got (--hugepages falls back to THP without reserved pages).
+ */
+typedef enum
+{
+  PAGES_4K,      ///< 4 KB pages (MADV_NOHUGEPAGE).
+  PAGES_THP,     ///< Transparent huge pages requested with MADV_HUGEPAGE (the kernel may still use 4 KB).
+  PAGES_HUGETLB, ///< Reserved 2 MB pages (MAP_HUGETLB).
+} page_backing;
+
+static const char *const page_names[] = {"4k", "thp", "hugetlb"}; ///< Indexed by page_backing.
+
+/**
+ * @struct options
+ * @brief Command-line configuration.
+ */
+typedef struct
+{
+  size_t max_bytes;  ///< Largest working set.
+  int hugepages;     ///< 1 to request 2 MB pages.
+  int cpu_node;      ///< Node whose CPUs run the chase (-1: no pinning).
+  int mem_node;      ///< Node the buffers are bound to (-1: first touch).
+  int load_threads;  ///< Background bandwidth threads.
+  size_t load_bytes; ///< Buffer of each background thread.
+  const char *output;
+} options;
+
+static atomic_int stop_load; ///< Set when the chase is over.
+
+/**
+ * @brief splitmix64 step.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/* ----- Placement ----- */
+
+/**
+ * @brief Pins the calling thread to the CPUs of a NUMA node (read from sysfs).
+ * @return 0 on success, -1 if the node is unknown or has no usable CPU.
+ */
+int pin_to_node(int node_id)
+{
+  char path[128];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node_id);
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return -1;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  int first, last, count = 0;
+  char separator;
+  // cpulist is "a-b,c,d-e".
+  while (fscanf(file, "%d", &first) == 1)
+  {
+    last = first;
+    if (fscanf(file, "%c", &separator) == 1 && separator == '-')
+    {
+      if (fscanf(file, "%d", &last) != 1)
+        break;
+      if (fscanf(file, "%c", &separator) != 1)
+        separator = '\n';
+    }
+    for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++, count++)
+      CPU_SET(cpu, &set);
+    if (separator != ',')
+      break;
+  }
+  fclose(file);
+  return count > 0 && sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Maps a buffer with the requested page size and binds it to a node, before it is touched.
+ * @param pages Set to the backing the buffer actually got.
+ * @return The buffer, or NULL.
+ */
+void *map_buffer(size_t bytes, int hugepages, int mem_node, page_backing *pages)
+{
+  void *buffer = MAP_FAILED;
+  if (hugepages)
+  {
+    const size_t rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    buffer = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (buffer != MAP_FAILED)
+    {
+      bytes = rounded;
+      *pages = PAGES_HUGETLB;
+    }
+  }
+  if (buffer == MAP_FAILED)
+  {
+    buffer = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED)
+      return NULL;
+    // No reserved huge pages: fall back to transparent ones. Otherwise force 4 KB pages.
+    madvise(buffer, bytes, hugepages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+    *pages = hugepages ? PAGES_THP : PAGES_4K;
+  }
+  if (mem_node >= 0)
+  {
+    unsigned long mask[16] = {0};
+    mask[mem_node / (8 * sizeof(unsigned long))] |= 1UL << (mem_node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, buffer, bytes, MPOL_BIND_MODE, mask, 8 * sizeof(mask), 0) != 0)
+      perror("mbind");
+  }
+  return buffer;
+}
+
+void unmap_buffer(void *buffer, size_t bytes, page_backing pages)
+{
+  if (pages == PAGES_HUGETLB)
+    bytes = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+  munmap(buffer, bytes);
+}
+
+/* ----- Chase ----- */
+
+/**
+ * @brief Links the lines of a buffer into one random cycle (Sattolo's algorithm).
+ * @return 0 on success, -1 if the temporary permutation could not be allocated.
+ */
+int build_cycle(node *nodes, size_t count, uint64_t seed)
+{
+  size_t *perm = (size_t *)malloc(count * sizeof(size_t));
+  if (!perm)
+    return -1;
+  for (size_t i = 0; i < count; i++)
+    perm[i] = i;
+  // j < i (not <= i) makes the permutation a single cycle.
+  for (size_t i = count - 1; i > 0; i--)
+  {
+    const size_t j = (size_t)(((unsigned __int128)next_random(&seed) * i) >> 64);
+    const size_t tmp = perm[i];
+    perm[i] = perm[j];
+    perm[j] = tmp;
+  }
+  for (size_t i = 0; i < count; i++)
+    nodes[i].next = &nodes[perm[i]];
+  free(perm);
+  return 0;
+}
+
+/**
+ * @brief Follows the cycle for `loads` loads.
+ * @return The node reached, so the loads are not optimized away.
+ */
+__attribute__((noinline)) node *chase(node *p, long loads)
+{
+  for (long i = 0; i < loads; i += 16)
+  {
+#pragma GCC unroll 16
+    for (int k = 0; k < 16; k++)
+      p = p->next;
+  }
+  return p;
+}
+
+/**
+ * @brief Best ns per load over TRIALS measurements on a working set of `bytes`.
+ * @param pages Set to the backing the working set got.
+ * @return The latency, or a negative value if the buffer could not be built.
+ */
+double measure_latency(size_t bytes, const options *opt, page_backing *pages)
+{
+  const size_t count = bytes / sizeof(node);
+  node *nodes = (node *)map_buffer(count * sizeof(node), opt->hugepages, opt->mem_node, pages);
+  if (!nodes)
+    return -1.0;
+  if (build_cycle(nodes, count, 1) != 0)
+  {
+    unmap_buffer(nodes, count * sizeof(node), *pages);
+    return -1.0;
+  }
+
+  node *p = chase(nodes, (long)count < LOADS ? ((long)count + 15) / 16 * 16 : LOADS); // warm-up
+  double best = 1e30;
+  for (int trial = 0; trial < TRIALS; trial++)
+  {
+    const double start = omp_get_wtime();
+    p = chase(p, LOADS);
+    const double ns = (omp_get_wtime() - start) * 1e9 / LOADS;
+    if (ns < best)
+      best = ns;
+  }
+  if (!p)
+    printf("(unexpected end of the cycle)\n");
+  unmap_buffer(nodes, count * sizeof(node), *pages);
+  return best;
+}
+
+/* ----- Background load ----- */
+
+/**
+ * @brief Streams over a private buffer (one read and one write stream) until stop_load is set.
+ * @return Bytes moved.
+ */
+double background_load(const options *opt)
+{
+  const size_t half = opt->load_bytes / 2 / sizeof(double);
+  page_backing pages;
+  double *buffer = (double *)map_buffer(2 * half * sizeof(double), 0, opt->mem_node, &pages);
+  if (!buffer)
+    return 0.0;
+  double *src = buffer, *dst = buffer + half;
+  for (size_t i = 0; i < half; i++)
+  {
+    src[i] = 1.0;
+    dst[i] = 0.0;
+  }
+
+  double bytes = 0.0;
+  const size_t block = 1 << 16;
+  while (!atomic_load_explicit(&stop_load, memory_order_relaxed))
+  {
+    for (size_t first = 0; first < half && !atomic_load_explicit(&stop_load, memory_order_relaxed); first += block)
+    {
+      const size_t last = first + block < half ? first + block : half;
+#pragma omp simd
+      for (size_t i = first; i < last; i++)
+        dst[i] = 1.0001 * src[i] + 1.0;
+      bytes += 2.0 * (last - first) * sizeof(double);
+    }
+  }
+  unmap_buffer(buffer, 2 * half * sizeof(double), pages);
+  return bytes;
+}
+
+/* ----- Driver ----- */
+
+/**
+ * @brief Name of the level that holds a working set, from the cache sizes reported by sysconf.
+ */
+const char *level_of(size_t bytes)
+{
+  const long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE), l2 = sysconf(_SC_LEVEL2_CACHE_SIZE),
+             l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if (l1 > 0 && bytes <= (size_t)l1)
+    return "L1";
+  if (l2 > 0 && bytes <= (size_t)l2)
+    return "L2";
+  if (l3 > 0 && bytes <= (size_t)l3)
+    return "L3";
+  return "DRAM";
+}
+
+/**
+ * @brief Runs the sweep on the calling thread and writes the table and the CSV.
+ */
+int run_sweep(const options *opt, FILE *file)
+{
+  if (opt->cpu_node >= 0 && pin_to_node(opt->cpu_node) != 0)
+    printf("(could not pin to the CPUs of node %d)\n", opt->cpu_node);
+
+  printf("Working set | Level | Pages   | ns/load\n");
+  printf("---------------------------------------\n");
+  for (size_t bytes = (size_t)MIN_KB << 10; bytes <= opt->max_bytes; bytes *= 2)
+  {
+    page_backing pages;
+    const double ns = measure_latency(bytes, opt, &pages);
+    if (ns < 0.0)
+    {
+      printf("%8zu KB | allocation failed, stopping\n", bytes >> 10);
+      return -1;
+    }
+    printf("%8zu KB | %-5s | %-7s | %7.2f\n", bytes >> 10, level_of(bytes), page_names[pages], ns);
+    // The backing the buffer got, not the one requested: --hugepages may have fallen back to THP.
+    fprintf(file, "%zu,%s,%.4f,%s,%d,%d,%d\n", bytes, level_of(bytes), ns, page_names[pages], opt->cpu_node,
+            opt->mem_node, opt->load_threads);
+    fflush(stdout);
+  }
+  return 0;
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+void print_usage(const char *program)
+{
+  printf("Usage: %s [--max-mb MB] [--hugepages] [--cpu-node N] [--mem-node M] [--load T] [--load-mb MB]\n"
+         "       [--output PATH]\n",
+         program);
+}
+
+int main(int argc, char *argv[])
+{
+  options opt = {(size_t)DEFAULT_MAX_MB << 20, 0, -1, -1, 0, (size_t)DEFAULT_LOAD_MB << 20, DEFAULT_OUTPUT};
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--max-mb") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+      opt.max_bytes = (size_t)atol(argv[++i]) << 20;
+    else if (strcmp(argv[i], "--hugepages") == 0)
+      opt.hugepages = 1;
+    else if (strcmp(argv[i], "--cpu-node") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+      opt.cpu_node = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--mem-node") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0 &&
+             atoi(argv[i + 1]) < 1024)
+      opt.mem_node = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+      opt.load_threads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--load-mb") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+      opt.load_bytes = (size_t)atol(argv[++i]) << 20;
+    else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+      opt.output = argv[++i];
+    else
+    {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  FILE *file = fopen(opt.output, "w");
+  if (!file)
+  {
+    perror("Failed to open the latency CSV");
+    return 1;
+  }
+  fprintf(file, "working_set_bytes,level,ns_per_load,pages,cpu_node,mem_node,load_threads\n");
+  printf("Requested pages: %s, CPU node: %d, memory node: %d, background threads: %d\n\n",
+         opt.hugepages ? "2 MB" : "4 KB", opt.cpu_node, opt.mem_node, opt.load_threads);
+
+  // Thread 0 chases; the others generate bandwidth until it is done.
+  int status = 0;
+  double load_bytes = 0.0, start = omp_get_wtime(), seconds = 0.0;
+  atomic_store(&stop_load, 0);
+#pragma omp parallel num_threads(1 + opt.load_threads) reduction(+ : load_bytes)
+  {
+    if (omp_get_thread_num() == 0)
+    {
+      status = run_sweep(&opt, file);
+      seconds = omp_get_wtime() - start;
+      atomic_store(&stop_load, 1);
+    }
+    else
+    {
+      if (opt.cpu_node >= 0)
+        pin_to_node(opt.cpu_node);
+      load_bytes += background_load(&opt);
+    }
+  }
+  if (opt.load_threads > 0)
+    printf("\nBackground bandwidth: %.2f GB/s from %d threads\n", load_bytes / seconds / 1e9, opt.load_threads);
+
+  fclose(file);
+  printf("\nLatency data written to %s\n", opt.output);
+  return status == 0 ? 0 : 1;
+}
@@ -1,55 +1,450 @@
+/**
+ * @file memory_bound.c
+ * @brief Memory-bound benchmark: c[idx] = a[idx] + b[idx] over a configurable access pattern.
+ *
+ * The first version only ran a stride-16 loop over three 4 GB arrays and
+ * initialized them from one thread, so on a NUMA machine every page lived
+ * on the node of the master thread (and `c` was first touched inside the
+ * timed loop). The kernel is still one addition per visited slot, but how
+ * the slots are visited is a parameter:
+ *
+ * - sequential: every element, in order (stride 1);
+ * - strided: every `stride`-th element, in order (the original loop);
+ * - gather: the same slots as strided, in a random order read from an
+ *   index array (like the probe side of a hash join);
+ * - chase: the same slots, where the next slot is loaded from the current
+ *   one through a random cyclic permutation, so the loads are dependent and
+ *   each one pays the full latency; each thread walks its own part of the
+ *   cycle.
+ *
+ * Variants:
+ *
+ * - software prefetch of the slot `prefetch` iterations ahead (sequential,
+ *   strided, gather; the chase cannot know its next slot in advance);
+ * - non-temporal stores of c (`_mm_stream_pd` / `_mm_stream_si64`), which
+ *   skip the read-for-ownership of the destination line.
+ *
+ * The arrays are first-touched in parallel with the same static schedule
+ * as the kernel, so each thread's pages are on its own node (--serial-init
+ * restores the old behaviour for comparison). The program reports the
+ * useful bandwidth (24 bytes per slot: two loads and one store of a double)
+ * and the effective one, counting the whole cache lines moved, the
+ * read-for-ownership of c and the index or chain traffic.
+ *
+ * With --sweep the arrays are allocated and first-touched once, by the
+ * largest thread count of the list, and the kernel runs for every count
+ * (sweep.h); the times go to one CSV with speedup and efficiency.
+ */
+
+#define _GNU_SOURCE
+#include <omp.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
-#include <omp.h>
 
-#define SIZE 500000000  // 4 GB com double
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-int main(int argc, char *argv[]) {
-    struct timeval start, end;
-    double elapsed_time;
-    double *a, *b, *c;
-    int num_threads = 1;
+#include "sweep.h"
 
-    if (argc > 1) {
-        num_threads = atoi(argv[1]);
-    }
+#define SIZE 500000000 // 4 GB com double
+#define DEFAULT_STRIDE 16
+#define CACHE_LINE 64
+#define USEFUL_BYTES 24 ///< Two loads and one store of a double per slot.
 
-    a = (double *)malloc(SIZE * sizeof(double));
-    b = (double *)malloc(SIZE * sizeof(double));
-    c = (double *)malloc(SIZE * sizeof(double));
+/**
+ * @enum access_pattern
+ * @brief Order in which the slots are visited.
+ */
+typedef enum
+{
+  PATTERN_SEQUENTIAL,
+  PATTERN_STRIDED,
+  PATTERN_GATHER,
+  PATTERN_CHASE,
+  PATTERN_COUNT
+} access_pattern;
 
-    if (!a || !b || !c) {
-        printf("Memory allocation failed!\n");
-        return 1;
+static const char *pattern_names[PATTERN_COUNT] = {"sequential", "strided", "gather", "chase"};
+
+/**
+ * @struct workload
+ * @brief Arrays and parameters of one benchmark configuration.
+ */
+typedef struct
+{
+  access_pattern pattern;
+  size_t elements;   ///< Elements per array.
+  size_t stride;     ///< Distance between slots (1 for sequential).
+  size_t slots;      ///< Slots visited per pass: elements / stride.
+  long prefetch;     ///< Prefetch distance in iterations (0: off).
+  int nt;            ///< 1 for non-temporal stores of c.
+  uint64_t seed;     ///< Seed of the gather order and the chase cycle.
+  double *a, *b, *c;
+  size_t *order;     ///< gather and chase: the slots in random order.
+  size_t *next;      ///< chase: next[s] is the slot after s in the cycle.
+} workload;
+
+/**
+ * @brief Reads the wall clock in seconds.
+ */
+double now_seconds(void)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+/**
+ * @brief splitmix64 step.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief Stores one double in c, bypassing the caches if requested.
+ */
+static inline void store(double *p, double value, int nt)
+{
+#if defined(__SSE2__) && defined(__x86_64__)
+  if (nt)
+  {
+    _mm_stream_si64((long long *)p, _mm_cvtsi128_si64(_mm_castpd_si128(_mm_set_sd(value))));
+    return;
+  }
+#else
+  (void)nt;
+#endif
+  *p = value;
+}
+
+/**
+ * @brief Allocates the arrays and first-touches them with `threads` threads (or serially).
+ * @return 0 on success, -1 if an allocation failed.
+ */
+int workload_setup(workload *w, int threads, int serial_init)
+{
+  const size_t bytes = (w->elements * sizeof(double) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+  w->a = (double *)aligned_alloc(CACHE_LINE, bytes);
+  w->b = (double *)aligned_alloc(CACHE_LINE, bytes);
+  w->c = (double *)aligned_alloc(CACHE_LINE, bytes);
+  w->order = NULL;
+  w->next = NULL;
+  if (w->pattern == PATTERN_GATHER || w->pattern == PATTERN_CHASE)
+    w->order = (size_t *)malloc(w->slots * sizeof(size_t));
+  if (w->pattern == PATTERN_CHASE)
+    w->next = (size_t *)malloc(w->slots * sizeof(size_t));
+  if (!w->a || !w->b || !w->c || (w->pattern >= PATTERN_GATHER && !w->order) ||
+      (w->pattern == PATTERN_CHASE && !w->next))
+    return -1;
+
+  // Same static schedule over the elements as the kernel uses over the slots: a thread touches the pages it will use.
+  const size_t elements = w->elements;
+  double *a = w->a, *b = w->b, *c = w->c;
+#pragma omp parallel for schedule(static) num_threads(serial_init ? 1 : threads)
+  for (size_t i = 0; i < elements; i++)
+  {
+    a[i] = i * 1.0;
+    b[i] = i * 2.0;
+    c[i] = 0.0;
+  }
+
+  if (w->order)
+  {
+    size_t *order = w->order, *next = w->next;
+    const size_t slots = w->slots;
+#pragma omp parallel for schedule(static) num_threads(serial_init ? 1 : threads)
+    for (size_t s = 0; s < slots; s++)
+    {
+      order[s] = s;
+      if (next)
+        next[s] = s;
+    }
+    // Fisher-Yates shuffle; for the chase, the shuffled order is one cycle through every slot.
+    uint64_t state = w->seed;
+    for (size_t s = slots - 1; s > 0; s--)
+    {
+      const size_t j = (size_t)(((unsigned __int128)next_random(&state) * (s + 1)) >> 64);
+      const size_t tmp = order[s];
+      order[s] = order[j];
+      order[j] = tmp;
     }
+    if (next)
+    {
+      for (size_t s = 0; s < slots; s++)
+        next[order[s]] = order[s + 1 < slots ? s + 1 : 0];
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Frees the arrays of a workload.
+ */
+void workload_free(workload *w)
+{
+  free(w->a);
+  free(w->b);
+  free(w->c);
+  free(w->order);
+  free(w->next);
+}
+
+/**
+ * @brief Runs one pass of the kernel with `threads` threads.
+ * @return Seconds elapsed.
+ */
+double workload_run(const workload *w, int threads)
+{
+  double *restrict a = w->a, *restrict b = w->b, *restrict c = w->c;
+  const size_t *order = w->order, *next = w->next;
+  const size_t stride = w->stride, slots = w->slots;
+  const long prefetch = w->prefetch;
+  const int nt = w->nt;
+
+  const double start = now_seconds();
+#pragma omp parallel num_threads(threads)
+  {
+    switch (w->pattern)
+    {
+    case PATTERN_SEQUENTIAL:
+#if defined(__SSE2__)
+      if (nt)
+      {
+        // Pairs of doubles: the arrays are 64-byte aligned, so every pair is 16-byte aligned.
+#pragma omp for schedule(static)
+        for (size_t p = 0; p < slots / 2; p++)
+        {
+          if (prefetch)
+          {
+            __builtin_prefetch(&a[2 * (p + prefetch)]);
+            __builtin_prefetch(&b[2 * (p + prefetch)]);
+          }
+          _mm_stream_pd(&c[2 * p], _mm_add_pd(_mm_load_pd(&a[2 * p]), _mm_load_pd(&b[2 * p])));
+        }
+#pragma omp single
+        if (slots % 2)
+          c[slots - 1] = a[slots - 1] + b[slots - 1];
+        break;
+      }
+#endif
+#pragma omp for schedule(static)
+      for (size_t i = 0; i < slots; i++)
+      {
+        if (prefetch)
+        {
+          __builtin_prefetch(&a[i + prefetch]);
+          __builtin_prefetch(&b[i + prefetch]);
+          __builtin_prefetch(&c[i + prefetch], 1);
+        }
+        c[i] = a[i] + b[i];
+      }
+      break;
+
+    case PATTERN_STRIDED:
+#pragma omp for schedule(static)
+      for (size_t i = 0; i < slots; i++)
+      {
+        if (prefetch && i + prefetch < slots)
+        {
+          const size_t ahead = (i + prefetch) * stride;
+          __builtin_prefetch(&a[ahead]);
+          __builtin_prefetch(&b[ahead]);
+          if (!nt)
+            __builtin_prefetch(&c[ahead], 1);
+        }
+        const size_t idx = i * stride; // Pula posições => baixa localidade
+        store(&c[idx], a[idx] + b[idx], nt);
+      }
+      break;
+
+    case PATTERN_GATHER:
+#pragma omp for schedule(static)
+      for (size_t i = 0; i < slots; i++)
+      {
+        if (prefetch && i + prefetch < slots)
+        {
+          const size_t ahead = order[i + prefetch] * stride;
+          __builtin_prefetch(&a[ahead]);
+          __builtin_prefetch(&b[ahead]);
+          if (!nt)
+            __builtin_prefetch(&c[ahead], 1);
+        }
+        const size_t idx = order[i] * stride;
+        store(&c[idx], a[idx] + b[idx], nt);
+      }
+      break;
 
-    for (size_t i = 0; i < SIZE; i++) {
-        a[i] = i * 1.0;
-        b[i] = i * 2.0;
+    default:
+    {
+      // Thread t walks positions [t slots / T, (t + 1) slots / T) of the cycle: every slot once in total.
+      const size_t t = (size_t)omp_get_thread_num(), total = (size_t)omp_get_num_threads();
+      const size_t first = slots * t / total, last = slots * (t + 1) / total;
+      size_t slot = first < last ? order[first] : 0;
+      for (size_t step = first; step < last; step++)
+      {
+        const size_t idx = slot * stride;
+        store(&c[idx], a[idx] + b[idx], nt);
+        slot = next[slot];
+      }
+      break;
     }
-    
-    gettimeofday(&start, NULL);
-    int stride = 16;
-    size_t limit = SIZE / stride;
-    #pragma omp parallel num_threads(num_threads)
+    }
+#if defined(__SSE2__)
+    if (nt)
+      _mm_sfence();
+#endif
+  }
+  return now_seconds() - start;
+}
+
+/**
+ * @brief Bytes the memory system moves per slot: whole lines, the read-for-ownership of c and the index traffic.
+ */
+double effective_bytes_per_slot(const workload *w)
+{
+  // In order, consecutive slots share a line when the stride is under a line; in random order each slot costs a line.
+  const double span = (double)w->stride * sizeof(double);
+  const double per_array =
+      w->pattern <= PATTERN_STRIDED ? (span < CACHE_LINE ? span : CACHE_LINE) : CACHE_LINE;
+  double bytes = (w->nt ? 3.0 : 4.0) * per_array; // a, b, c written back (+ c read for ownership)
+  if (w->pattern == PATTERN_GATHER)
+    bytes += sizeof(size_t); // order[], read in sequence
+  else if (w->pattern == PATTERN_CHASE)
+    bytes += CACHE_LINE; // next[], read at random
+  return bytes;
+}
+
+/**
+ * @brief Prints the command-line options.
+ */
+void print_usage(const char *program)
+{
+  printf("Usage: %s [threads] [--pattern sequential|strided|gather|chase] [--stride S] [--size-mb MB]\n"
+         "       [--prefetch D] [--nt] [--serial-init] [--seed S]\n"
+         "       [--sweep LIST] [--affinity none|close|spread] [--csv PATH]\n",
+         program);
+}
+
+int main(int argc, char *argv[])
+{
+  workload w;
+  memset(&w, 0, sizeof(w));
+  w.pattern = PATTERN_STRIDED;
+  w.elements = SIZE;
+  w.stride = DEFAULT_STRIDE;
+  w.seed = 1;
+  int num_threads = 1, serial_init = 0;
+  sweep threads_sweep = {.length = 0, .affinity = SWEEP_AFFINITY_NONE};
+  const char *csv = NULL;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (i == 1 && atoi(argv[i]) > 0)
+      num_threads = atoi(argv[i]);
+    else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc)
     {
-      #pragma omp for
-      for (size_t i = 0; i < limit; i++)
+      int p = 0;
+      while (p < PATTERN_COUNT && strcmp(argv[i + 1], pattern_names[p]) != 0)
+        p++;
+      if (p == PATTERN_COUNT)
       {
-        size_t idx = i * stride; // Pula posições => baixa localidade
-        c[idx] = a[idx] + b[idx];
+        print_usage(argv[0]);
+        return 1;
       }
+      w.pattern = (access_pattern)p;
+      i++;
+    }
+    else if (strcmp(argv[i], "--stride") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+      w.stride = (size_t)atol(argv[++i]);
+    else if (strcmp(argv[i], "--size-mb") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+      w.elements = (size_t)atol(argv[++i]) * (1UL << 20) / (3 * sizeof(double));
+    else if (strcmp(argv[i], "--prefetch") == 0 && i + 1 < argc && atol(argv[i + 1]) >= 0)
+      w.prefetch = atol(argv[++i]);
+    else if (strcmp(argv[i], "--nt") == 0)
+      w.nt = 1;
+    else if (strcmp(argv[i], "--serial-init") == 0)
+      serial_init = 1;
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      w.seed = strtoull(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc && sweep_parse(&threads_sweep, argv[i + 1]) == 0)
+      i++;
+    else if (strcmp(argv[i], "--affinity") == 0 && i + 1 < argc &&
+             sweep_parse_affinity(&threads_sweep, argv[i + 1]) == 0)
+      i++;
+    else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+      csv = argv[++i];
+    else
+    {
+      print_usage(argv[0]);
+      return 1;
     }
-    gettimeofday(&end, NULL);
+  }
+
+  if (w.pattern == PATTERN_SEQUENTIAL)
+    w.stride = 1;
+  w.slots = w.elements / w.stride;
+  if (w.slots == 0)
+  {
+    printf("The stride is larger than the arrays\n");
+    return 1;
+  }
+  if (w.pattern == PATTERN_CHASE && w.prefetch)
+  {
+    printf("(prefetch ignored: the chase does not know its next slot)\n");
+    w.prefetch = 0;
+  }
+  // The sequential kernel reads ahead of the arrays when prefetching: keep the reads in bounds.
+  if (w.pattern == PATTERN_SEQUENTIAL && w.prefetch)
+    w.elements += 2 * (size_t)w.prefetch;
+
+  if (threads_sweep.length > 0)
+    num_threads = sweep_max_threads(&threads_sweep);
+  sweep_apply_affinity(&threads_sweep, num_threads);
+  if (workload_setup(&w, num_threads, serial_init) != 0)
+  {
+    printf("Memory allocation failed!\n");
+    workload_free(&w);
+    return 1;
+  }
+
+  if (threads_sweep.length > 0)
+  {
+    for (int k = 0; k < threads_sweep.length; k++)
+    {
+      const int threads = threads_sweep.counts[k];
+      sweep_apply_affinity(&threads_sweep, threads);
+      threads_sweep.seconds[k] = workload_run(&w, threads);
+      printf("Memory-bound with %d threads: %f seconds\n", threads, threads_sweep.seconds[k]);
+      fflush(stdout);
+    }
+    workload_free(&w);
+    return csv && sweep_write_csv(&threads_sweep, csv) != 0 ? 1 : 0;
+  }
+
+  const double elapsed_time = workload_run(&w, num_threads);
+  printf("Memory-bound with %d threads: %f seconds\n", num_threads, elapsed_time);
 
-    elapsed_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
-    printf("Memory-bound with %d threads: %f seconds\n", num_threads, elapsed_time);
-    fflush(stdout);
+  const double effective = effective_bytes_per_slot(&w);
+  printf("  pattern %s (stride %zu), %zu slots over 3 x %.1f MB, prefetch %ld, %s stores, %s init\n",
+         pattern_names[w.pattern], w.stride, w.slots, w.elements * sizeof(double) / 1048576.0, w.prefetch,
+         w.nt ? "non-temporal" : "regular", serial_init ? "serial" : "parallel");
+  printf("  useful bandwidth   : %8.2f GB/s (%d B/slot)\n", w.slots * (double)USEFUL_BYTES / elapsed_time / 1e9,
+         USEFUL_BYTES);
+  printf("  effective bandwidth: %8.2f GB/s (%.0f B/slot, %.0f%% useful)\n",
+         w.slots * effective / elapsed_time / 1e9, effective, 100.0 * USEFUL_BYTES / effective);
+  printf("  %.2f ns/slot\n", elapsed_time * 1e9 / w.slots);
+  fflush(stdout);
 
-    free(a);
-    free(b);
-    free(c);
+  workload_free(&w);
 
-    return 0;
+  return 0;
 }
@@ -0,0 +1,546 @@
+/**
+ * @file roofline.c
+ * @brief Roofline characterization: peak FLOP/s, bandwidth per memory level and the position of registered kernels.
+ *
+ * The roofline model bounds the performance of a kernel with arithmetic
+ * intensity I (FLOPs per byte moved) by min(peak FLOP/s, I x bandwidth).
+ * This program measures both roofs on the current machine:
+ *
+ * - peak FLOP/s: independent chains of vector FMAs (x = x a + b), enough
+ *   of them to cover the FMA latency on every port, compiled for
+ *   AVX-512, AVX2+FMA or SSE2 and chosen at run time;
+ * - bandwidth: STREAM copy, scale, add and triad on working sets sized
+ *   for L1, L2, L3 (half of each cache, from sysconf) and DRAM, with one
+ *   contiguous slice per thread initialized by that thread (first touch).
+ *   Bytes are counted as in STREAM (write-allocate traffic is not).
+ *
+ * Then each registered kernel (the kernel of compute_bound.c at every
+ * accuracy tier, the strided loop of memory_bound.c and the STREAM triad)
+ * is run and placed on the roofline: its intensity, the achieved GFLOP/s, the attainable GFLOP/s at
+ * DRAM bandwidth and whether it is memory- or compute-bound (left or right
+ * of the ridge point, peak / DRAM bandwidth). Everything is written to a
+ * CSV that data/plots.py draws as a roofline chart.
+ */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "compute_kernel.h"
+
+#define DEFAULT_OUTPUT "./task-4.memory-or-cpu--bound-applications/data/roofline.csv"
+#define FMA_CHAINS 12              ///< Independent FMA chains per vector width (latency 4 x 2 ports, with margin).
+#define FMA_ITERATIONS (1L << 24)  ///< FMA rounds per thread in one peak measurement.
+#define TRIALS 5                   ///< Measurements per point; the best one is kept (as in STREAM).
+#define BYTES_PER_TRIAL (1L << 30) ///< Bytes a bandwidth trial moves, at least.
+#define DEFAULT_DRAM_MB 1024       ///< DRAM working set when 4 x L3 is smaller.
+#define MEMORY_BOUND_STRIDE 16     ///< Stride of memory_bound.c.
+#define COMPUTE_ELEMENTS 50000000L ///< Elements of the compute_bound kernel per measurement.
+#define CACHE_LINE 64
+
+/**
+ * @brief The memory levels, with the fallback size used when sysconf does not know it.
+ */
+typedef struct
+{
+  const char *name;  ///< "L1", "L2", "L3" or "DRAM".
+  int sysconf_name;  ///< sysconf key of the cache size (-1 for DRAM).
+  size_t fallback;   ///< Size in bytes when sysconf returns 0.
+  int per_core;      ///< 1 if each thread has its own cache of this size.
+} memory_level;
+
+static const memory_level levels[] = {
+    {"L1", _SC_LEVEL1_DCACHE_SIZE, 32 << 10, 1},
+    {"L2", _SC_LEVEL2_CACHE_SIZE, 1 << 20, 1},
+    {"L3", _SC_LEVEL3_CACHE_SIZE, 32 << 20, 0},
+    {"DRAM", -1, 0, 0},
+};
+#define LEVEL_COUNT (int)(sizeof(levels) / sizeof(levels[0]))
+
+/**
+ * @enum stream_op
+ * @brief STREAM kernels.
+ */
+typedef enum
+{
+  STREAM_COPY,  ///< c = a
+  STREAM_SCALE, ///< b = s c
+  STREAM_ADD,   ///< c = a + b
+  STREAM_TRIAD, ///< a = b + s c
+  STREAM_COUNT
+} stream_op;
+
+static const char *stream_names[STREAM_COUNT] = {"copy", "scale", "add", "triad"};
+static const int stream_bytes[STREAM_COUNT] = {16, 16, 24, 24}; ///< Bytes per element.
+static const int stream_flops[STREAM_COUNT] = {0, 1, 1, 2};     ///< FLOPs per element.
+
+/**
+ * @struct arrays
+ * @brief STREAM arrays, one slice of `per_thread` elements per requested thread.
+ *
+ * The runtime may start fewer threads than requested (OMP_THREAD_LIMIT,
+ * OMP_DYNAMIC), so every parallel region deals the `threads` slices out
+ * over the team it actually got (SLICES): all the data is always
+ * initialized and processed, and the byte and FLOP totals stay exact.
+ */
+typedef struct
+{
+  double *a, *b, *c;
+  size_t per_thread;
+  int threads; ///< Slices (the requested thread count).
+} arrays;
+
+/**
+ * @brief Loops `s` over the slices of the calling thread: its number, then every team size after it.
+ */
+#define SLICES(s, x) for (int s = omp_get_thread_num(); s < (x)->threads; s += omp_get_num_threads())
+
+/* ----- Peak FLOP/s ----- */
+
+#define VECTOR(bytes) __attribute__((vector_size(bytes)))
+
+/**
+ * @brief Defines fma_<name>(iterations): FMA_CHAINS chains of `bytes`-wide vectors, for one instruction set.
+ *
+ * Returns the sum of the chains so the work is not optimized away.
+ */
+#define DEFINE_FMA_KERNEL(name, target, bytes)                                    \
+  target static double fma_##name(long iterations)                                \
+  {                                                                               \
+    typedef double vec VECTOR(bytes);                                             \
+    vec acc[FMA_CHAINS];                                                          \
+    const vec a = (vec){0} + 0.999999;                                            \
+    const vec b = (vec){0} + 1e-7;                                                \
+    for (int k = 0; k < FMA_CHAINS; k++)                                          \
+      acc[k] = (vec){0} + (double)k;                                              \
+    for (long it = 0; it < iterations; it++)                                      \
+    {                                                                             \
+      _Pragma("GCC unroll 16") for (int k = 0; k < FMA_CHAINS; k++)               \
+        acc[k] = acc[k] * a + b;                                                  \
+    }                                                                             \
+    double sum = 0.0;                                                             \
+    for (int k = 0; k < FMA_CHAINS; k++)                                          \
+      for (size_t lane = 0; lane < bytes / sizeof(double); lane++)                \
+        sum += acc[k][lane];                                                      \
+    return sum;                                                                   \
+  }
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+DEFINE_FMA_KERNEL(avx512, __attribute__((target("avx512f,fma"))), 64)
+DEFINE_FMA_KERNEL(avx2, __attribute__((target("avx2,fma"))), 32)
+#endif
+DEFINE_FMA_KERNEL(baseline, , 16)
+
+/**
+ * @brief Picks the widest FMA kernel the CPU supports.
+ * @param lanes Set to the doubles per vector.
+ * @param name Set to the instruction set name.
+ */
+double (*select_fma(int *lanes, const char **name))(long)
+{
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+  {
+    *lanes = 8;
+    *name = "AVX-512";
+    return fma_avx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+  {
+    *lanes = 4;
+    *name = "AVX2+FMA";
+    return fma_avx2;
+  }
+#endif
+  *lanes = 2;
+  *name = "baseline";
+  return fma_baseline;
+}
+
+/**
+ * @brief Measures the peak GFLOP/s of all threads running FMA chains.
+ */
+double measure_peak(int threads, const char **isa)
+{
+  int lanes;
+  double (*kernel)(long) = select_fma(&lanes, isa);
+  double best = 0.0, sink = 0.0;
+  for (int trial = 0; trial < TRIALS; trial++)
+  {
+    double seconds = 0.0;
+    int team = 0;
+#pragma omp parallel num_threads(threads) reduction(+ : sink)
+    {
+#pragma omp barrier
+      const double start = omp_get_wtime();
+      sink += kernel(FMA_ITERATIONS);
+#pragma omp barrier
+#pragma omp master
+      {
+        seconds = omp_get_wtime() - start;
+        // The runtime may give fewer threads than requested (OMP_THREAD_LIMIT, OMP_DYNAMIC).
+        team = omp_get_num_threads();
+      }
+    }
+    const double flops = 2.0 * lanes * FMA_CHAINS * (double)FMA_ITERATIONS * team;
+    if (flops / seconds / 1e9 > best)
+      best = flops / seconds / 1e9;
+  }
+  if (sink == 0.0)
+    printf("(unexpected FMA result)\n");
+  return best;
+}
+
+/* ----- Bandwidth ----- */
+
+COMPUTE_TARGET_CLONES __attribute__((noinline)) static void stream_pass(stream_op op, double *restrict a,
+                                                                          double *restrict b, double *restrict c,
+                                                                          size_t n)
+{
+  const double s = 3.0;
+  switch (op)
+  {
+  case STREAM_COPY:
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+      c[i] = a[i];
+    break;
+  case STREAM_SCALE:
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+      b[i] = s * c[i];
+    break;
+  case STREAM_ADD:
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+      c[i] = a[i] + b[i];
+    break;
+  default:
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+      a[i] = b[i] + s * c[i];
+    break;
+  }
+}
+
+/**
+ * @brief Allocates the arrays and initializes each slice from the thread that will use it.
+ * @return 0 on success, -1 if the allocation failed.
+ */
+int arrays_alloc(arrays *x, size_t per_thread, int threads)
+{
+  const size_t n = per_thread * threads;
+  x->per_thread = per_thread;
+  x->threads = threads;
+  x->a = (double *)aligned_alloc(CACHE_LINE, (n * sizeof(double) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+  x->b = (double *)aligned_alloc(CACHE_LINE, (n * sizeof(double) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+  x->c = (double *)aligned_alloc(CACHE_LINE, (n * sizeof(double) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+  if (!x->a || !x->b || !x->c)
+  {
+    free(x->a);
+    free(x->b);
+    free(x->c);
+    return -1;
+  }
+#pragma omp parallel num_threads(threads)
+  SLICES(slice, x)
+  {
+    const size_t first = (size_t)slice * per_thread;
+    for (size_t i = first; i < first + per_thread; i++)
+    {
+      x->a[i] = 1.0;
+      x->b[i] = 2.0;
+      x->c[i] = 0.0;
+    }
+  }
+  return 0;
+}
+
+void arrays_free(arrays *x)
+{
+  free(x->a);
+  free(x->b);
+  free(x->c);
+}
+
+/**
+ * @brief Best GB/s of a STREAM kernel over TRIALS, each made of enough passes to move BYTES_PER_TRIAL.
+ */
+double measure_stream(const arrays *x, stream_op op)
+{
+  const double bytes_per_pass = (double)stream_bytes[op] * x->per_thread * x->threads;
+  long passes = (long)(BYTES_PER_TRIAL / bytes_per_pass);
+  if (passes < 1)
+    passes = 1;
+
+  double best = 0.0;
+  for (int trial = 0; trial < TRIALS; trial++)
+  {
+    double seconds = 0.0;
+#pragma omp parallel num_threads(x->threads)
+    {
+      SLICES(slice, x)
+      {
+        const size_t first = (size_t)slice * x->per_thread;
+        stream_pass(op, x->a + first, x->b + first, x->c + first, x->per_thread); // warm-up
+      }
+#pragma omp barrier
+      const double start = omp_get_wtime();
+      for (long p = 0; p < passes; p++)
+      {
+        SLICES(slice, x)
+        {
+          const size_t first = (size_t)slice * x->per_thread;
+          stream_pass(op, x->a + first, x->b + first, x->c + first, x->per_thread);
+        }
+      }
+#pragma omp barrier
+#pragma omp master
+      seconds = omp_get_wtime() - start;
+    }
+    const double gbs = bytes_per_pass * passes / seconds / 1e9;
+    if (gbs > best)
+      best = gbs;
+  }
+  return best;
+}
+
+/**
+ * @brief Size in bytes of a cache level (sysconf, or the fallback).
+ */
+size_t level_size(const memory_level *level)
+{
+  const long size = level->sysconf_name >= 0 ? sysconf(level->sysconf_name) : 0;
+  return size > 0 ? (size_t)size : level->fallback;
+}
+
+/**
+ * @brief Elements per thread per array for a level: the three arrays fill half of the cache.
+ */
+size_t level_elements(const memory_level *level, int threads, size_t dram_bytes)
+{
+  size_t bytes;
+  if (level->sysconf_name < 0)
+    bytes = dram_bytes / threads;
+  else if (level->per_core)
+    bytes = level_size(level) / 2;
+  else
+    bytes = level_size(level) / 2 / threads;
+  const size_t elements = bytes / 3 / sizeof(double);
+  return elements > 64 ? elements : 64;
+}
+
+/* ----- Registered kernels ----- */
+
+VECMATH_TIERS(COMPUTE_DEFINE_TIER)
+
+/**
+ * @struct roofline_kernel
+ * @brief A kernel placed on the roofline.
+ */
+typedef struct
+{
+  const char *name;        ///< Name in the CSV.
+  double flops;            ///< FLOPs per element.
+  double bytes;            ///< Bytes moved per element (0: no memory traffic, infinite intensity).
+
+  /**
+   * @brief Runs the kernel once on the DRAM arrays.
+   * @return Elements processed.
+   */
+  double (*run)(const arrays *x);
+} roofline_kernel;
+
+/**
+ * @brief Defines run_compute_<tier>: compute_bound.c at one accuracy tier, per-thread contiguous ranges, no memory traffic.
+ */
+#define DEFINE_COMPUTE_RUN(name, ulp, ST, CT, ET, LT)                      \
+  double run_compute_##name(const arrays *x)                               \
+  {                                                                        \
+    double sink = 0.0;                                                     \
+    _Pragma("omp parallel num_threads(x->threads) reduction(+ : sink)")    \
+    {                                                                      \
+      const long t = omp_get_thread_num(), team = omp_get_num_threads();   \
+      const long first = 1 + COMPUTE_ELEMENTS * t / team;                  \
+      const long last = COMPUTE_ELEMENTS * (t + 1) / team;                 \
+      sink += compute_sum_##name(first, last);                             \
+    }                                                                      \
+    x->c[0] = sink;                                                        \
+    return (double)COMPUTE_ELEMENTS;                                       \
+  }
+
+VECMATH_TIERS(DEFINE_COMPUTE_RUN)
+
+#define COMPUTE_KERNEL(name, ulp, ST, CT, ET, LT) \
+  {"compute_bound_" #name, compute_tier_flops(ST, CT, ET, LT), 0.0, run_compute_##name},
+
+/**
+ * @brief memory_bound.c: c[i] = a[i] + b[i] every MEMORY_BOUND_STRIDE elements (one cache line per array and element).
+ */
+double run_memory_bound(const arrays *x)
+{
+  const size_t limit = x->per_thread / MEMORY_BOUND_STRIDE;
+#pragma omp parallel num_threads(x->threads)
+  SLICES(slice, x)
+  {
+    const size_t first = (size_t)slice * x->per_thread;
+    double *a = x->a + first, *b = x->b + first, *c = x->c + first;
+    for (size_t i = 0; i < limit; i++)
+    {
+      const size_t idx = i * MEMORY_BOUND_STRIDE;
+      c[idx] = a[idx] + b[idx];
+    }
+  }
+  return (double)limit * x->threads;
+}
+
+/**
+ * @brief STREAM triad over the DRAM arrays.
+ */
+double run_triad(const arrays *x)
+{
+#pragma omp parallel num_threads(x->threads)
+  SLICES(slice, x)
+  {
+    const size_t first = (size_t)slice * x->per_thread;
+    stream_pass(STREAM_TRIAD, x->a + first, x->b + first, x->c + first, x->per_thread);
+  }
+  return (double)x->per_thread * x->threads;
+}
+
+/**
+ * @brief Best achieved GFLOP/s of a kernel over TRIALS runs.
+ */
+double measure_kernel(const roofline_kernel *kernel, const arrays *x)
+{
+  double best = 0.0;
+  kernel->run(x); // warm-up
+  for (int trial = 0; trial < TRIALS; trial++)
+  {
+    const double start = omp_get_wtime();
+    const double elements = kernel->run(x);
+    const double gflops = elements * kernel->flops / (omp_get_wtime() - start) / 1e9;
+    if (gflops > best)
+      best = gflops;
+  }
+  return best;
+}
+
+/* ----- Driver ----- */
+
+/**
+ * @brief Prints the command-line options.
+ */
+void print_usage(const char *program)
+{
+  printf("Usage: %s [--threads T] [--dram-mb MB] [--output PATH]\n", program);
+}
+
+int main(int argc, char *argv[])
+{
+  int threads = omp_get_max_threads();
+  size_t dram_mb = 0;
+  const char *output = DEFAULT_OUTPUT;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+      threads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--dram-mb") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+      dram_mb = (size_t)atol(argv[++i]);
+    else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+      output = argv[++i];
+    else
+    {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // DRAM working set: 4 x L3 (so no level holds it), at least DEFAULT_DRAM_MB.
+  size_t dram_bytes = dram_mb * (1UL << 20);
+  if (dram_bytes == 0)
+  {
+    dram_bytes = 4 * level_size(&levels[2]);
+    if (dram_bytes < (size_t)DEFAULT_DRAM_MB << 20)
+      dram_bytes = (size_t)DEFAULT_DRAM_MB << 20;
+  }
+
+  FILE *file = fopen(output, "w");
+  if (!file)
+  {
+    perror("Failed to open the roofline CSV");
+    return 1;
+  }
+  fprintf(file, "type,name,level,working_set_bytes,gflops,gbytes_per_s,intensity\n");
+
+  const char *isa;
+  const double peak = measure_peak(threads, &isa);
+  printf("Threads: %d\n\nPeak (%s FMA): %.2f GFLOP/s\n\n", threads, isa, peak);
+  fprintf(file, "peak,fma_%s,,,%.4f,,\n", isa, peak);
+
+  printf("Level | Working set |    copy    scale      add    triad (GB/s)\n");
+  printf("------------------------------------------------------------------\n");
+  double dram_bandwidth = 0.0;
+  arrays dram = {NULL, NULL, NULL, 0, 0};
+  for (int l = 0; l < LEVEL_COUNT; l++)
+  {
+    arrays x;
+    const size_t per_thread = level_elements(&levels[l], threads, dram_bytes);
+    if (arrays_alloc(&x, per_thread, threads) != 0)
+    {
+      printf("%-5s | allocation of %zu MB failed, skipped\n", levels[l].name, 3 * per_thread * threads * 8 >> 20);
+      continue;
+    }
+    const size_t working_set = 3 * per_thread * threads * sizeof(double);
+    printf("%-5s | %8.2f MB |", levels[l].name, working_set / 1048576.0);
+    for (int op = 0; op < STREAM_COUNT; op++)
+    {
+      const double gbs = measure_stream(&x, (stream_op)op);
+      printf(" %8.2f", gbs);
+      fprintf(file, "bandwidth,%s,%s,%zu,%.4f,%.4f,%.6f\n", stream_names[op], levels[l].name, working_set,
+              gbs * stream_flops[op] / stream_bytes[op], gbs, (double)stream_flops[op] / stream_bytes[op]);
+      if (levels[l].sysconf_name < 0 && op == STREAM_TRIAD)
+        dram_bandwidth = gbs;
+    }
+    printf("\n");
+    if (levels[l].sysconf_name < 0)
+      dram = x;
+    else
+      arrays_free(&x);
+  }
+  if (!dram.a)
+  {
+    fclose(file);
+    return 1;
+  }
+
+  const double ridge = peak / dram_bandwidth;
+  printf("\nRidge point (peak / DRAM triad): %.3f FLOP/byte\n\n", ridge);
+
+  const roofline_kernel kernels[] = {
+      VECMATH_TIERS(COMPUTE_KERNEL)
+      {"memory_bound", 1.0, 3.0 * CACHE_LINE, run_memory_bound},
+      {"stream_triad", 2.0, 24.0, run_triad},
+  };
+  printf("Kernel             | FLOP/byte | Achieved GFLOP/s | Attainable GFLOP/s | Bound\n");
+  printf("--------------------------------------------------------------------------------\n");
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+  {
+    const roofline_kernel *kernel = &kernels[k];
+    const double intensity = kernel->bytes > 0.0 ? kernel->flops / kernel->bytes : INFINITY;
+    const double achieved = measure_kernel(kernel, &dram);
+    const double attainable = fmin(peak, intensity * dram_bandwidth);
+    printf("%-18s | %9.4f | %16.2f | %18.2f | %s (%.0f%% of the roof)\n", kernel->name, intensity, achieved,
+           attainable, intensity < ridge ? "memory" : "compute", 100.0 * achieved / attainable);
+    fprintf(file, "kernel,%s,DRAM,%zu,%.4f,%.4f,%.6f\n", kernel->name, 3 * dram.per_thread * threads * sizeof(double),
+            achieved, kernel->bytes > 0.0 ? achieved / intensity : 0.0, intensity);
+  }
+  arrays_free(&dram);
+  fclose(file);
+  printf("\nRoofline data written to %s\n", output);
+  return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file sweep.h
+ * @brief In-process thread-scaling sweep shared by compute_bound.c and memory_bound.c.
+ *
+ * A sweep runs the same kernel for every thread count of a list, without
+ * restarting the program, so the data is allocated and initialized once.
+ * Before each count the threads are pinned following an affinity policy
+ * (libgomp reads OMP_PROC_BIND only at startup, so the policy is applied
+ * with sched_setaffinity from inside a parallel region, and stays in
+ * effect because the runtime reuses its threads). The results go to one
+ * CSV with the speedup and the parallel efficiency relative to the first
+ * count of the list.
+ *
+ * Header-only, like compute_kernel.h, so every program still compiles
+ * from a single source file. Define _GNU_SOURCE before the first include
+ * (for cpu_set_t).
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <omp.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_MAX_COUNTS 256 ///< Longest thread list.
+
+/**
+ * @enum sweep_affinity
+ * @brief Placement of the threads on the CPUs the process may use.
+ */
+typedef enum
+{
+  SWEEP_AFFINITY_NONE,   ///< Threads float over all allowed CPUs.
+  SWEEP_AFFINITY_CLOSE,  ///< Thread t on the t-th allowed CPU (fills one core/socket first).
+  SWEEP_AFFINITY_SPREAD, ///< Threads spaced evenly over the allowed CPUs.
+  SWEEP_AFFINITY_COUNT
+} sweep_affinity;
+
+static const char *sweep_affinity_names[SWEEP_AFFINITY_COUNT] = {"none", "close", "spread"};
+
+/**
+ * @struct sweep
+ * @brief Thread list, policy and results of a sweep.
+ */
+typedef struct
+{
+  int counts[SWEEP_MAX_COUNTS];      ///< Thread counts, in run order.
+  double seconds[SWEEP_MAX_COUNTS];  ///< Time of each count.
+  int length;                        ///< Entries in counts.
+  sweep_affinity affinity;
+} sweep;
+
+/**
+ * @brief Parses a thread list such as "1-32", "1,2,4,8" or "1-8,16,32".
+ * @return 0 on success, -1 on a malformed or too long list.
+ */
+static inline int sweep_parse(sweep *s, const char *spec)
+{
+  s->length = 0;
+  while (*spec)
+  {
+    char *end;
+    const long first = strtol(spec, &end, 10);
+    long last = first;
+    if (end == spec || first <= 0)
+      return -1;
+    if (*end == '-')
+    {
+      spec = end + 1;
+      last = strtol(spec, &end, 10);
+      if (end == spec || last < first)
+        return -1;
+    }
+    for (long t = first; t <= last; t++)
+    {
+      if (s->length == SWEEP_MAX_COUNTS)
+        return -1;
+      s->counts[s->length++] = (int)t;
+    }
+    if (*end == ',')
+      end++;
+    else if (*end)
+      return -1;
+    spec = end;
+  }
+  return s->length > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Parses an affinity policy name.
+ * @return 0 on success, -1 if the name is unknown.
+ */
+static inline int sweep_parse_affinity(sweep *s, const char *name)
+{
+  for (int p = 0; p < SWEEP_AFFINITY_COUNT; p++)
+  {
+    if (strcmp(name, sweep_affinity_names[p]) == 0)
+    {
+      s->affinity = (sweep_affinity)p;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Largest thread count of the list.
+ */
+static inline int sweep_max_threads(const sweep *s)
+{
+  int max = 1;
+  for (int i = 0; i < s->length; i++)
+    max = s->counts[i] > max ? s->counts[i] : max;
+  return max;
+}
+
+/**
+ * @brief Pins the `threads` threads of the next parallel regions according to the policy.
+ */
+static inline void sweep_apply_affinity(const sweep *s, int threads)
+{
+  // The allowed CPUs are read once, before any thread is pinned.
+  static cpu_set_t allowed;
+  static int cpus[CPU_SETSIZE];
+  static int cpu_count = 0;
+  if (cpu_count == 0)
+  {
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+      if (CPU_ISSET(cpu, &allowed))
+        cpus[cpu_count++] = cpu;
+    }
+  }
+
+#pragma omp parallel num_threads(threads)
+  {
+    const int t = omp_get_thread_num();
+    cpu_set_t set;
+    if (s->affinity == SWEEP_AFFINITY_NONE || cpu_count == 0)
+      set = allowed;
+    else
+    {
+      const int index = s->affinity == SWEEP_AFFINITY_CLOSE ? t % cpu_count
+                                                             : (int)((long)t * cpu_count / threads) % cpu_count;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[index], &set);
+    }
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+}
+
+/**
+ * @brief Writes the sweep as CSV (threads, time, speedup and efficiency relative to the first count).
+ * @return 0 on success, -1 if the file could not be written.
+ */
+static inline int sweep_write_csv(const sweep *s, const char *path)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+  {
+    perror("Failed to open the sweep CSV");
+    return -1;
+  }
+  fprintf(file, "Threads,Time (s),Speedup,Efficiency\n");
+  for (int i = 0; i < s->length; i++)
+  {
+    const double speedup = s->seconds[0] / s->seconds[i];
+    fprintf(file, "%d,%f,%f,%f\n", s->counts[i], s->seconds[i], speedup, speedup * s->counts[0] / s->counts[i]);
+  }
+  return fclose(file) == 0 ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file vecmath.h
+ * @brief libm-free sin/cos, exp, log and pow that vectorize inside `#pragma omp simd` loops.
+ *
+ * Scalar libm calls cannot be vectorized (glibc only offers vector
+ * variants under -ffast-math), so a loop over transcendental functions runs
+ * one element at a time. These functions are branch-free C, written only
+ * with arithmetic, selects and bit casts, and are always inlined: inside a
+ * `#pragma omp simd` loop the compiler turns each of them into SIMD
+ * instructions on all lanes.
+ *
+ * Each function reduces its argument to a small interval and evaluates a
+ * polynomial there (Cody-Waite reduction, as in SLEEF):
+ *
+ * - sin/cos: x = q pi/2 + r, |r| <= pi/4, with pi/2 split in four parts so
+ *   that r stays exact for |x| up to 2^30; the quadrant selects sin(r) or
+ *   cos(r) and the sign.
+ * - exp: x = n ln 2 + r, |r| <= ln(2)/2, exp(x) = 2^n exp(r), with 2^n
+ *   built in the exponent bits.
+ * - log: x = 2^e m, m in [sqrt(2)/2, sqrt(2)), log(m) = 2 atanh(s) with
+ *   s = (m - 1)/(m + 1).
+ * - pow(x, y) = exp(y log(x)), for x > 0.
+ *
+ * The number of polynomial terms is a parameter: fewer terms are faster
+ * and less accurate. It must be a compile-time constant at the call site,
+ * so the Horner loops unroll completely. VECMATH_TIERS lists the term
+ * counts of each accuracy tier with the error bound, in ULP, measured
+ * against glibc (`compute_bound --check` repeats the measurement).
+ *
+ * Domain: finite x with |x| < 2^30 for sin/cos, x in [-708, 709] for exp
+ * (clamped), positive normal x for log and pow. Infinities, NaN and
+ * denormals are not handled.
+ */
+
+#ifndef VECMATH_H
+#define VECMATH_H
+
+#include <stdint.h>
+
+#define VECMATH_INLINE static inline __attribute__((always_inline))
+
+/**
+ * @brief Accuracy tiers: X(name, max_ulp, sin_terms, cos_terms, exp_terms, log_terms).
+ *
+ * max_ulp is the largest error measured over the kernel's range of
+ * arguments (sin/cos up to 10^9, exp on [0, 1), log up to 10^9).
+ */
+#define VECMATH_TIERS(X)         \
+  X(u2, 2.0, 10, 10, 15, 12)     \
+  X(u4, 4.0, 9, 9, 13, 10)       \
+  X(u1e8, 1e8, 6, 6, 8, 5)
+
+#define VECMATH_MAX_TERMS 16 ///< Longest coefficient table.
+
+#define VECMATH_SHIFTER 0x1.8p52 ///< Adding it rounds to an integer kept in the low mantissa bits.
+
+static const double vecmath_sin_coef[VECMATH_MAX_TERMS] = { ///< (-1)^k / (2k + 1)!
+    0x1.0000000000000p+0,  -0x1.5555555555555p-3, 0x1.1111111111111p-7,  -0x1.a01a01a01a01ap-13,
+    0x1.71de3a556c734p-19, -0x1.ae64567f544e4p-26, 0x1.6124613a86d09p-33, -0x1.ae7f3e733b81fp-41,
+    0x1.952c77030ad4ap-49, -0x1.2f49b46814157p-57, 0x1.71b8ef6dcf572p-66, -0x1.761b41316381ap-75};
+static const double vecmath_cos_coef[VECMATH_MAX_TERMS] = { ///< (-1)^k / (2k)!
+    0x1.0000000000000p+0,  -0x1.0000000000000p-1, 0x1.5555555555555p-5,  -0x1.6c16c16c16c17p-10,
+    0x1.a01a01a01a01ap-16, -0x1.27e4fb7789f5cp-22, 0x1.1eed8eff8d898p-29, -0x1.93974a8c07c9dp-37,
+    0x1.ae7f3e733b81fp-45, -0x1.6827863b97d97p-53, 0x1.e542ba4020225p-62, -0x1.0ce396db7f853p-70};
+static const double vecmath_exp_coef[VECMATH_MAX_TERMS] = { ///< 1 / k!
+    0x1.0000000000000p+0,  0x1.0000000000000p+0,  0x1.0000000000000p-1,  0x1.5555555555555p-3,
+    0x1.5555555555555p-5,  0x1.1111111111111p-7,  0x1.6c16c16c16c17p-10, 0x1.a01a01a01a01ap-13,
+    0x1.a01a01a01a01ap-16, 0x1.71de3a556c734p-19, 0x1.27e4fb7789f5cp-22, 0x1.ae64567f544e4p-26,
+    0x1.1eed8eff8d898p-29, 0x1.6124613a86d09p-33, 0x1.93974a8c07c9dp-37, 0x1.ae7f3e733b81fp-41};
+static const double vecmath_log_coef[VECMATH_MAX_TERMS] = { ///< 2 / (2k + 1)
+    0x1.0000000000000p+1,  0x1.5555555555555p-1,  0x1.999999999999ap-2,  0x1.2492492492492p-2,
+    0x1.c71c71c71c71cp-3,  0x1.745d1745d1746p-3,  0x1.3b13b13b13b14p-3,  0x1.1111111111111p-3,
+    0x1.e1e1e1e1e1e1ep-4,  0x1.af286bca1af28p-4,  0x1.8618618618618p-4,  0x1.642c8590b2164p-4,
+    0x1.47ae147ae147bp-4,  0x1.2f684bda12f68p-4};
+
+// pi/2 = PIO2_A + PIO2_B + PIO2_C + PIO2_D; A, B and C have 22 significant bits, so q * A is exact for q < 2^31.
+#define VECMATH_PIO2_A 0x1.921fb00000000p+0
+#define VECMATH_PIO2_B 0x1.5110b00000000p-22
+#define VECMATH_PIO2_C 0x1.1846980000000p-44
+#define VECMATH_PIO2_D 0x1.3198a2e037073p-69
+#define VECMATH_2_PI 0x1.45f306dc9c883p-1
+
+// ln 2 = LN2_HI + LN2_LO; LN2_HI has 32 significant bits, so e * LN2_HI is exact for |e| < 2^21.
+#define VECMATH_LN2_HI 0x1.62e42fee00000p-1
+#define VECMATH_LN2_LO 0x1.a39ef35793c76p-33
+#define VECMATH_LOG2_E 0x1.71547652b82fep+0
+
+/**
+ * @struct vecmath_sincos_t
+ * @brief sin(x) and cos(x) (returned by value: pointers to locals keep a simd loop from vectorizing).
+ */
+typedef struct
+{
+  double sin;
+  double cos;
+} vecmath_sincos_t;
+
+VECMATH_INLINE uint64_t vecmath_bits(double x)
+{
+  const union
+  {
+    double d;
+    uint64_t u;
+  } bits = {.d = x};
+  return bits.u;
+}
+
+VECMATH_INLINE double vecmath_from_bits(uint64_t u)
+{
+  const union
+  {
+    uint64_t u;
+    double d;
+  } bits = {.u = u};
+  return bits.d;
+}
+
+/**
+ * @brief c[0] + c[1] x + ... + c[terms - 1] x^(terms - 1), by Horner's rule.
+ */
+VECMATH_INLINE double vecmath_poly(double x, const double *c, int terms)
+{
+  double p = c[terms - 1];
+#pragma GCC unroll 16
+  for (int k = terms - 2; k >= 0; k--)
+    p = p * x + c[k];
+  return p;
+}
+
+/**
+ * @brief sin(x) and cos(x) with one shared range reduction.
+ */
+VECMATH_INLINE vecmath_sincos_t vecmath_sincos(double x, int sin_terms, int cos_terms)
+{
+  const double shifted = x * VECMATH_2_PI + VECMATH_SHIFTER;
+  const double q = shifted - VECMATH_SHIFTER;
+  const uint64_t quadrant = vecmath_bits(shifted);
+
+  double r = x - q * VECMATH_PIO2_A;
+  r = r - q * VECMATH_PIO2_B;
+  r = r - q * VECMATH_PIO2_C;
+  r = r - q * VECMATH_PIO2_D;
+
+  // The leading terms are added last, so the rounding errors of the tail stay below them.
+  const double r2 = r * r;
+  const double sin_r = r + (r * r2) * vecmath_poly(r2, vecmath_sin_coef + 1, sin_terms - 1);
+  const double half = 0.5 * r2;
+  const double one_minus_half = 1.0 - half;
+  const double cos_r = one_minus_half + (((1.0 - one_minus_half) - half) +
+                                         (r2 * r2) * vecmath_poly(r2, vecmath_cos_coef + 2, cos_terms - 2));
+
+  // Quadrant q: sin(x) = sin(r), cos(r), -sin(r), -cos(r); cos(x) = cos(r), -sin(r), -cos(r), sin(r).
+  const double sin_x = quadrant & 1 ? cos_r : sin_r;
+  const double cos_x = quadrant & 1 ? sin_r : cos_r;
+  const vecmath_sincos_t result = {quadrant & 2 ? -sin_x : sin_x, (quadrant + 1) & 2 ? -cos_x : cos_x};
+  return result;
+}
+
+/**
+ * @brief exp(x), x clamped to [-708, 709].
+ */
+VECMATH_INLINE double vecmath_exp(double x, int terms)
+{
+  x = x < -708.0 ? -708.0 : x > 709.0 ? 709.0 : x;
+  const double shifted = x * VECMATH_LOG2_E + VECMATH_SHIFTER;
+  const double n = shifted - VECMATH_SHIFTER;
+  const int64_t exponent = (int64_t)(vecmath_bits(shifted) - vecmath_bits(VECMATH_SHIFTER));
+
+  double r = x - n * VECMATH_LN2_HI;
+  r = r - n * VECMATH_LN2_LO;
+  const double scale = vecmath_from_bits((uint64_t)(exponent + 1023) << 52);
+  return vecmath_poly(r, vecmath_exp_coef, terms) * scale;
+}
+
+/**
+ * @brief log(x) for positive normal x.
+ */
+VECMATH_INLINE double vecmath_log(double x, int terms)
+{
+  const uint64_t bits = vecmath_bits(x);
+  int64_t e = (int64_t)(bits >> 52) - 1023;
+  double m = vecmath_from_bits((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+  const int high = m > 0x1.6a09e667f3bcdp+0; // sqrt(2)
+  m = high ? m * 0.5 : m;
+  e = high ? e + 1 : e;
+  // Exact int64 -> double through the shifter (vector conversions need AVX-512DQ).
+  const double ed = vecmath_from_bits(vecmath_bits(VECMATH_SHIFTER) + (uint64_t)e) - VECMATH_SHIFTER;
+
+  const double s = (m - 1.0) / (m + 1.0);
+  const double z = s * s;
+  const double log_m = s * vecmath_poly(z, vecmath_log_coef, terms);
+  return ed * VECMATH_LN2_HI + (log_m + ed * VECMATH_LN2_LO);
+}
+
+/**
+ * @brief pow(x, y) = exp(y log(x)) for positive normal x.
+ */
+VECMATH_INLINE double vecmath_pow(double x, double y, int exp_terms, int log_terms)
+{
+  return vecmath_exp(y * vecmath_log(x, log_terms), exp_terms);
+}
+
+#endif
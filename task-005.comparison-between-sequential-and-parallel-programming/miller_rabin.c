@@ -0,0 +1,257 @@
+/**
+ * @file miller_rabin.c
+ * @brief Deterministic Miller-Rabin for 64-bit integers with Montgomery multiplication.
+ */
+
+#include "miller_rabin.h"
+
+#include <omp.h>
+
+typedef unsigned __int128 u128;
+
+static const uint64_t small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+#define SMALL_PRIME_COUNT (sizeof(small_primes) / sizeof(small_primes[0]))
+#define FILTER_SETTLED_BELOW (59ULL * 59ULL) ///< Below this, no factor <= 53 means prime.
+
+static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+#define BASE_COUNT (sizeof(bases) / sizeof(bases[0]))
+#define BATCH_BLOCK 1024 ///< Candidates filtered and compacted together.
+
+/**
+ * @struct montgomery
+ * @brief Montgomery form modulo an odd n, with R = 2^64.
+ */
+typedef struct
+{
+  uint64_t n;
+  uint64_t n_inv;     ///< n^-1 mod 2^64.
+  uint64_t r2;        ///< R^2 mod n.
+  uint64_t one;       ///< R mod n (1 in Montgomery form).
+  uint64_t minus_one; ///< n - R mod n (-1 in Montgomery form).
+} montgomery;
+
+static inline montgomery montgomery_init(uint64_t n)
+{
+  montgomery m;
+  m.n = n;
+  // Newton's iteration doubles the correct low bits: 3 (n * n = 1 mod 8) -> 6 -> 12 -> 24 -> 48 -> 96.
+  uint64_t inv = n;
+  for (int i = 0; i < 5; i++)
+    inv *= 2 - n * inv;
+  m.n_inv = inv;
+  m.one = (0 - n) % n;
+  m.r2 = (uint64_t)((u128)m.one * m.one % n);
+  m.minus_one = n - m.one;
+  return m;
+}
+
+/**
+ * @brief a b R^-1 mod n, for a, b < n.
+ *
+ * REDC with a subtraction: q = lo(t) n^-1 makes q n agree with t in the low
+ * 64 bits, so (t - q n) / 2^64 = hi(t) - hi(q n), which lies in (-n, n).
+ */
+static inline uint64_t montgomery_mul(const montgomery *m, uint64_t a, uint64_t b)
+{
+  const u128 t = (u128)a * b;
+  const uint64_t q = (uint64_t)t * m->n_inv;
+  const uint64_t qn_hi = (uint64_t)(((u128)q * m->n) >> 64);
+  const uint64_t t_hi = (uint64_t)(t >> 64);
+  const uint64_t r = t_hi - qn_hi;
+  return t_hi < qn_hi ? r + m->n : r;
+}
+
+static inline uint64_t montgomery_to(const montgomery *m, uint64_t a)
+{
+  return montgomery_mul(m, a % m->n, m->r2);
+}
+
+/**
+ * @brief Settles n with the small primes.
+ * @return 1 prime, 0 composite, -1 undecided (n >= 59^2 with no factor <= 53).
+ */
+static inline int prefilter(uint64_t n)
+{
+  if (n < 2)
+    return 0;
+  for (size_t i = 0; i < SMALL_PRIME_COUNT; i++)
+  {
+    if (n == small_primes[i])
+      return 1;
+    if (n % small_primes[i] == 0)
+      return 0;
+  }
+  return n < FILTER_SETTLED_BELOW ? 1 : -1;
+}
+
+int mr_is_prime(uint64_t n)
+{
+  const int filtered = prefilter(n);
+  if (filtered >= 0)
+    return filtered;
+
+  // n - 1 = d 2^s with d odd.
+  const int s = __builtin_ctzll(n - 1);
+  const uint64_t d = (n - 1) >> s;
+  const montgomery m = montgomery_init(n);
+
+  for (size_t b = 0; b < BASE_COUNT; b++)
+  {
+    // x = base^d, left to right.
+    const uint64_t base = montgomery_to(&m, bases[b]);
+    uint64_t x = base;
+    for (int bit = 62 - __builtin_clzll(d); bit >= 0; bit--)
+    {
+      x = montgomery_mul(&m, x, x);
+      if ((d >> bit) & 1)
+        x = montgomery_mul(&m, x, base);
+    }
+    if (x == m.one || x == m.minus_one)
+      continue;
+    int witness = 1;
+    for (int r = 1; r < s && witness; r++)
+    {
+      x = montgomery_mul(&m, x, x);
+      witness = x != m.minus_one;
+    }
+    if (witness)
+      return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief Runs the Miller-Rabin rounds for bases [first_base, last_base) on MR_LANES odd candidates >= 59 in lockstep.
+ *
+ * @param n Candidates (pad a partial group with 59, which is prime).
+ * @param passed passed[l] = 1 if n[l] passed every round (probable prime), 0 if a base is a witness.
+ */
+static void lanes_rounds(const uint64_t *n, int *passed, size_t first_base, size_t last_base)
+{
+  montgomery m[MR_LANES];
+  uint64_t d[MR_LANES];
+  int s[MR_LANES];
+  int max_bits = 0, max_s = 0, pending = MR_LANES;
+
+  for (int l = 0; l < MR_LANES; l++)
+  {
+    m[l] = montgomery_init(n[l]);
+    s[l] = __builtin_ctzll(n[l] - 1);
+    d[l] = (n[l] - 1) >> s[l];
+    const int bits = 64 - __builtin_clzll(d[l]);
+    max_bits = bits > max_bits ? bits : max_bits;
+    max_s = s[l] > max_s ? s[l] : max_s;
+    passed[l] = 1;
+  }
+
+  for (size_t b = first_base; b < last_base && pending > 0; b++)
+  {
+    uint64_t x[MR_LANES], power[MR_LANES];
+    for (int l = 0; l < MR_LANES; l++)
+    {
+      x[l] = m[l].one;
+      power[l] = montgomery_to(&m[l], bases[b]);
+    }
+    // x = base^d, right to left: multiply by base^(2^bit) or by 1, so every lane does the same work.
+    for (int bit = 0; bit < max_bits; bit++)
+    {
+#pragma GCC unroll 8
+      for (int l = 0; l < MR_LANES; l++)
+      {
+        const uint64_t factor = (d[l] >> bit) & 1 ? power[l] : m[l].one;
+        x[l] = montgomery_mul(&m[l], x[l], factor);
+        power[l] = montgomery_mul(&m[l], power[l], power[l]);
+      }
+    }
+
+    int round[MR_LANES];
+    for (int l = 0; l < MR_LANES; l++)
+      round[l] = x[l] == m[l].one || x[l] == m[l].minus_one;
+    for (int r = 1; r < max_s; r++)
+    {
+#pragma GCC unroll 8
+      for (int l = 0; l < MR_LANES; l++)
+      {
+        const int step = r < s[l] && !round[l];
+        const uint64_t squared = montgomery_mul(&m[l], x[l], x[l]);
+        x[l] = step ? squared : x[l];
+        round[l] |= step && squared == m[l].minus_one;
+      }
+    }
+
+    for (int l = 0; l < MR_LANES; l++)
+    {
+      pending -= passed[l] && !round[l];
+      passed[l] &= round[l];
+    }
+  }
+}
+
+/**
+ * @brief Runs bases [first_base, last_base) on candidates[0, count) in groups of MR_LANES; keeps the survivors in place.
+ * @return Number of survivors, moved to the front of candidates (and of index).
+ */
+static size_t rounds_compact(uint64_t *candidates, size_t *index, size_t count, size_t first_base, size_t last_base)
+{
+  size_t kept = 0;
+  for (size_t g = 0; g < count; g += MR_LANES)
+  {
+    uint64_t lanes[MR_LANES];
+    int passed[MR_LANES];
+    for (int l = 0; l < MR_LANES; l++)
+      lanes[l] = g + l < count ? candidates[g + l] : 59;
+    lanes_rounds(lanes, passed, first_base, last_base);
+    for (int l = 0; l < MR_LANES && g + l < count; l++)
+    {
+      if (passed[l])
+      {
+        candidates[kept] = candidates[g + l];
+        index[kept++] = index[g + l];
+      }
+    }
+  }
+  return kept;
+}
+
+void mr_is_prime_batch(const uint64_t *n, uint8_t *result, size_t count)
+{
+  // Lanes only pay off if they all do useful work, so the batch is filtered in stages and compacted after each:
+  // the small primes settle most candidates, base 2 rejects almost every remaining composite, and only the
+  // survivors (nearly all primes) run the other eleven bases.
+  uint64_t candidates[BATCH_BLOCK];
+  size_t index[BATCH_BLOCK];
+  for (size_t first = 0; first < count; first += BATCH_BLOCK)
+  {
+    const size_t block = count - first < BATCH_BLOCK ? count - first : BATCH_BLOCK;
+    size_t pending = 0;
+    for (size_t i = first; i < first + block; i++)
+    {
+      const int filtered = prefilter(n[i]);
+      result[i] = (uint8_t)(filtered > 0);
+      if (filtered < 0)
+      {
+        candidates[pending] = n[i];
+        index[pending++] = i;
+      }
+    }
+    pending = rounds_compact(candidates, index, pending, 0, 1);
+    pending = rounds_compact(candidates, index, pending, 1, BASE_COUNT);
+    for (size_t k = 0; k < pending; k++)
+      result[index[k]] = 1;
+  }
+}
+
+void mr_is_prime_batch_parallel(const uint64_t *n, uint8_t *result, size_t count, int threads)
+{
+#pragma omp parallel num_threads(threads)
+  {
+    // Contiguous ranges, rounded to whole groups of lanes.
+    const size_t t = (size_t)omp_get_thread_num(), total = (size_t)omp_get_num_threads();
+    const size_t groups = (count + MR_LANES - 1) / MR_LANES;
+    const size_t first = groups * t / total * MR_LANES;
+    size_t last = groups * (t + 1) / total * MR_LANES;
+    last = last < count ? last : count;
+    if (first < last)
+      mr_is_prime_batch(n + first, result + first, last - first);
+  }
+}
@@ -0,0 +1,56 @@
+/**
+ * @file miller_rabin.h
+ * @brief Deterministic Miller-Rabin primality test for 64-bit integers, single and batched.
+ *
+ * is_prime(int) in prime.c only takes 32-bit ints and costs O(sqrt n)
+ * divisions, which is hopeless for isolated 64-bit queries. This test
+ * answers any uint64_t exactly:
+ *
+ * - a small-prime pre-filter divides by the primes up to 53, which settles
+ *   every n < 59^2 and rejects most composites before any exponentiation;
+ * - Miller-Rabin with the first twelve primes as bases (2, 3, ..., 37) is
+ *   deterministic for all n < 3.3 x 10^24, so for every 64-bit n;
+ * - the modular products use Montgomery multiplication (one 64 x 64 ->
+ *   128-bit product and one reduction, no division).
+ *
+ * The batch API runs MR_LANES candidates in lockstep: each lane is an
+ * independent chain of Montgomery products, so the core overlaps their
+ * multiplier latency (x86 has no SIMD 64 x 64 -> 128-bit multiply, so the
+ * parallelism comes from interleaving, not vector lanes). The exponent is
+ * scanned from its low bit with a branch-free multiply, so lanes with
+ * different exponents still do the same operations. So that every lane
+ * does useful work, a batch is filtered in stages and compacted after each
+ * one: pre-filter, base 2 (which rejects almost every composite left), then
+ * the other bases on the survivors. The OpenMP driver splits a batch into
+ * one contiguous range per thread.
+ */
+
+#ifndef MILLER_RABIN_H
+#define MILLER_RABIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MR_LANES 8 ///< Candidates interleaved by the batch kernel.
+
+/**
+ * @brief Tests one integer.
+ * @return 1 if n is prime, 0 otherwise.
+ */
+int mr_is_prime(uint64_t n);
+
+/**
+ * @brief Tests `count` integers, MR_LANES at a time, on the calling thread.
+ *
+ * @param n Candidates.
+ * @param result result[i] = 1 if n[i] is prime, 0 otherwise.
+ * @param count Number of candidates.
+ */
+void mr_is_prime_batch(const uint64_t *n, uint8_t *result, size_t count);
+
+/**
+ * @brief mr_is_prime_batch split over `threads` OpenMP threads.
+ */
+void mr_is_prime_batch_parallel(const uint64_t *n, uint8_t *result, size_t count, int threads);
+
+#endif
@@ -6,13 +6,43 @@
  * up to a given integer `n`: a sequential implementation, a parallel implementation without
  * race condition handling (incorrect), and a parallel implementation using OpenMP `reduction`
  * (correct). Results are written to a CSV file for further analysis.
+ *
+ * The correct parallel loop also runs under each policy of schedule.h
+ * (static, static-cyclic, dynamic, guided, cost-weighted), and every
+ * scheduled row records the busy time of each thread and the resulting
+ * load imbalance (`--chunk C` sets the dynamic/guided chunk).
+ *
+ * Another version counts with the segmented sieve of sieve.h, checked
+ * against the sequential count; `--sieve-benchmark [max_n]` measures the
+ * sieve alone for n = 10^6, 10^7, ... up to max_n (default 10^10).
+ *
+ * The "miller_rabin" version counts with the batched 64-bit test of
+ * miller_rabin.h; `--miller-rabin-benchmark [count]` measures queries/s of
+ * the scalar, batched and OpenMP batched tests on random 64-bit keys.
+ *
+ * The "prime_cache" version answers from the incremental cache of
+ * prime_cache.h, shared by the whole sweep: only a new largest n sieves
+ * (from the previous bound), and the bitmap is kept in out/prime_cache.bin
+ * so the next run starts warm (`--cold` deletes it first).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <omp.h>
 
+#include "../common/async_writer.h"
+#include "miller_rabin.h"
+#include "prime_cache.h"
+#include "schedule.h"
+#include "sieve.h"
+
+#define SIEVE_BENCHMARK_MAX 10000000000ULL ///< Default largest n of --sieve-benchmark.
+#define MR_BENCHMARK_COUNT 4000000         ///< Default keys of --miller-rabin-benchmark.
+#define MR_BLOCK (1 << 20)                 ///< Candidates per call of the batch driver in the "miller_rabin" version.
+#define PRIME_CACHE_PATH "./task-5.comparison-between-sequential-and-parallel-programming/out/prime_cache.bin"
+
 /**
  * @brief Checks if a number is prime.
  *
@@ -46,29 +76,106 @@ long execution_time_us(struct timeval start, struct timeval end)
 /**
  * @brief Logs and prints the result of a test run.
  *
- * @param file Output file pointer.
+ * The row is appended to an async_writer, so the next measurement starts
+ * without waiting for the disk.
+ *
+ * @param file Output CSV writer.
  * @param n The input size.
  * @param threads Number of threads used.
  * @param version Version name (e.g., "sequential", "parallel_reduction").
  * @param total Total number of primes found.
  * @param time_us Execution time in microseconds.
+ * @param scheduled Busy times of a scheduled run, or NULL (the last two columns stay empty).
  */
-void write_result(FILE *file, int n, int threads, const char *version, int total, long time_us)
+void write_result(async_writer *file, int n, int threads, const char *version, int total, long time_us,
+                  const schedule_result *scheduled)
 {
   double time_sec = time_us / 1e6;
-  printf("n: %d, threads: %d, version: %s, total_primes: %d, time_seconds: %.6f\n",
-         n, threads, version, total, time_sec);
-  fprintf(file, "%d,%d,%s,%d,%.6f\n", n, threads, version, total, time_sec);
+  printf("n: %d, threads: %d, version: %s, total_primes: %d, time_seconds: %.6f", n, threads, version, total,
+         time_sec);
+  async_writer_printf(file, "%d,%d,%s,%d,%.6f,", n, threads, version, total, time_sec);
+  if (scheduled)
+  {
+    // Busy times are one field, separated by ';'.
+    printf(", imbalance: %.3f\n", schedule_imbalance(scheduled));
+    async_writer_printf(file, "%.4f,", schedule_imbalance(scheduled));
+    for (int t = 0; t < scheduled->threads; t++)
+      async_writer_printf(file, t == 0 ? "%.6f" : ";%.6f", scheduled->busy_seconds[t]);
+  }
+  else
+  {
+    printf("\n");
+    async_writer_printf(file, ",");
+  }
+  async_writer_printf(file, "\n");
+}
+
+/**
+ * @brief Runs the counting loop under a scheduling policy and writes its row.
+ *
+ * The static policy keeps the name "parallel_reduction" (it is the plain
+ * `parallel for reduction` loop); the others are "parallel_<policy>".
+ */
+void run_scheduled(async_writer *file, int n, int threads, schedule_policy policy, int chunk)
+{
+  struct timeval start, end;
+  schedule_result scheduled;
+  char version[64];
+  if (policy == SCHEDULE_STATIC)
+    snprintf(version, sizeof(version), "parallel_reduction");
+  else
+    snprintf(version, sizeof(version), "parallel_%s", schedule_name(policy));
+
+  gettimeofday(&start, NULL);
+  if (schedule_count(n, threads, policy, chunk, is_prime, &scheduled) != 0)
+  {
+    perror("Failed to allocate the busy times");
+    return;
+  }
+  gettimeofday(&end, NULL);
+  write_result(file, n, threads, version, scheduled.total, execution_time_us(start, end), &scheduled);
+  schedule_result_free(&scheduled);
+}
+
+/**
+ * @brief Counts the primes in [2, n] with the OpenMP batch Miller-Rabin, MR_BLOCK candidates at a time.
+ * @return The count, or -1 if the buffers could not be allocated.
+ */
+int count_primes_miller_rabin(int n, int threads)
+{
+  uint64_t *candidates = (uint64_t *)malloc(MR_BLOCK * sizeof(uint64_t));
+  uint8_t *prime = (uint8_t *)malloc(MR_BLOCK);
+  if (!candidates || !prime)
+  {
+    free(candidates);
+    free(prime);
+    return -1;
+  }
+  int total = 0;
+  for (int first = 2; first <= n; first += MR_BLOCK)
+  {
+    const int count = n - first + 1 < MR_BLOCK ? n - first + 1 : MR_BLOCK;
+    for (int k = 0; k < count; k++)
+      candidates[k] = (uint64_t)(first + k);
+    mr_is_prime_batch_parallel(candidates, prime, (size_t)count, threads);
+    for (int k = 0; k < count; k++)
+      total += prime[k];
+  }
+  free(candidates);
+  free(prime);
+  return total;
 }
 
 /**
  * @brief Runs all test versions for a given input size and number of threads.
  *
- * @param file Output file pointer.
+ * @param file Output CSV writer.
  * @param n Upper limit to count primes.
  * @param threads Number of threads to use for parallel versions.
+ * @param chunk Chunk of the dynamic and guided schedules.
+ * @param cache Prime-count cache shared by the sweep.
  */
-void run_tests_for_n(FILE *file, int n, int threads)
+void run_tests_for_n(async_writer *file, int n, int threads, int chunk, prime_cache *cache)
 {
   struct timeval start, end;
   long time;
@@ -83,7 +190,7 @@ void run_tests_for_n(FILE *file, int n, int threads)
   }
   gettimeofday(&end, NULL);
   time = execution_time_us(start, end);
-  write_result(file, n, threads, "sequential", total_primes_seq, time);
+  write_result(file, n, threads, "sequential", total_primes_seq, time, NULL);
 
   // Parallel version without reduction (incorrect)
   int total_primes_wrong = 0;
@@ -96,39 +203,176 @@ void run_tests_for_n(FILE *file, int n, int threads)
   }
   gettimeofday(&end, NULL);
   time = execution_time_us(start, end);
-  write_result(file, n, threads, "parallel_no_reduction", total_primes_wrong, time);
+  write_result(file, n, threads, "parallel_no_reduction", total_primes_wrong, time, NULL);
 
-  // Parallel version with reduction (correct)
-  int total_primes_reduction = 0;
+  // Parallel version with reduction (correct), under every scheduling policy
+  for (int policy = 0; policy < SCHEDULE_COUNT; policy++)
+    run_scheduled(file, n, threads, (schedule_policy)policy, chunk);
+
+  // Segmented sieve
   gettimeofday(&start, NULL);
-#pragma omp parallel for reduction(+ : total_primes_reduction) num_threads(threads)
-  for (int i = 2; i <= n; i++)
+  const uint64_t total_primes_sieve = sieve_count_primes((uint64_t)n, threads, 0);
+  gettimeofday(&end, NULL);
+  time = execution_time_us(start, end);
+  write_result(file, n, threads, "segmented_sieve", (int)total_primes_sieve, time, NULL);
+  if (total_primes_sieve != (uint64_t)total_primes_seq)
+    printf("⚠️ segmented_sieve disagrees with sequential for n = %d\n", n);
+
+  // Batched Miller-Rabin
+  gettimeofday(&start, NULL);
+  const int total_primes_mr = count_primes_miller_rabin(n, threads);
+  gettimeofday(&end, NULL);
+  time = execution_time_us(start, end);
+  write_result(file, n, threads, "miller_rabin", total_primes_mr, time, NULL);
+  if (total_primes_mr != total_primes_seq)
+    printf("⚠️ miller_rabin disagrees with sequential for n = %d\n", n);
+
+  // Incremental cache (a hit unless n is the largest so far)
+  gettimeofday(&start, NULL);
+  const uint64_t total_primes_cache = prime_cache_count(cache, (uint64_t)n, threads);
+  gettimeofday(&end, NULL);
+  time = execution_time_us(start, end);
+  write_result(file, n, threads, "prime_cache", (int)total_primes_cache, time, NULL);
+  if (total_primes_cache != (uint64_t)total_primes_seq)
+    printf("⚠️ prime_cache disagrees with sequential for n = %d\n", n);
+}
+
+/**
+ * @brief Measures queries/s of the scalar, batched and OpenMP batched Miller-Rabin on random 64-bit keys.
+ *
+ * @param count Number of keys.
+ * @param threads Threads of the parallel driver.
+ */
+int run_miller_rabin_benchmark(size_t count, int threads)
+{
+  uint64_t *keys = (uint64_t *)malloc(count * sizeof(uint64_t));
+  uint8_t *batch = (uint8_t *)malloc(count), *parallel = (uint8_t *)malloc(count);
+  if (!keys || !batch || !parallel)
   {
-    if (is_prime(i))
-      total_primes_reduction++;
+    printf("Allocation failed for %zu keys\n", count);
+    free(keys);
+    free(batch);
+    free(parallel);
+    return 1;
+  }
+  uint64_t state = 1; // xorshift64
+  for (size_t i = 0; i < count; i++)
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    keys[i] = state;
   }
+
+  struct timeval start, end;
+  size_t primes = 0;
+  gettimeofday(&start, NULL);
+  for (size_t i = 0; i < count; i++)
+    primes += (size_t)mr_is_prime(keys[i]);
   gettimeofday(&end, NULL);
-  time = execution_time_us(start, end);
-  write_result(file, n, threads, "parallel_reduction", total_primes_reduction, time);
+  const double scalar_seconds = execution_time_us(start, end) / 1e6;
+
+  gettimeofday(&start, NULL);
+  mr_is_prime_batch(keys, batch, count);
+  gettimeofday(&end, NULL);
+  const double batch_seconds = execution_time_us(start, end) / 1e6;
+
+  gettimeofday(&start, NULL);
+  mr_is_prime_batch_parallel(keys, parallel, count, threads);
+  gettimeofday(&end, NULL);
+  const double parallel_seconds = execution_time_us(start, end) / 1e6;
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < count; i++)
+    mismatches += batch[i] != parallel[i] || batch[i] != (uint8_t)mr_is_prime(keys[i]);
+
+  printf("Miller-Rabin on %zu random 64-bit keys (%zu primes)\n", count, primes);
+  printf("scalar: %.3e queries/s\n", count / scalar_seconds);
+  printf("batch (%d lanes): %.3e queries/s\n", MR_LANES, count / batch_seconds);
+  printf("batch, %d threads: %.3e queries/s\n", threads, count / parallel_seconds);
+  if (mismatches)
+    printf("⚠️ %zu keys with different answers\n", mismatches);
+  free(keys);
+  free(batch);
+  free(parallel);
+  return mismatches ? 1 : 0;
+}
+
+/**
+ * @brief Measures the segmented sieve alone, for n = 10^6, 10^7, ... up to max_n.
+ *
+ * @param max_n Largest n.
+ * @param threads Number of threads.
+ */
+int run_sieve_benchmark(uint64_t max_n, int threads)
+{
+  const size_t segment_bytes = sieve_default_segment_bytes();
+  printf("Segmented sieve, %d threads, %zu KB segments\n", threads, segment_bytes >> 10);
+  for (uint64_t n = 1000000; n <= max_n; n *= 10)
+  {
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    const uint64_t total = sieve_count_primes(n, threads, segment_bytes);
+    gettimeofday(&end, NULL);
+    if (total == UINT64_MAX)
+    {
+      printf("Allocation failed for n = %llu\n", (unsigned long long)n);
+      return 1;
+    }
+    const double seconds = execution_time_us(start, end) / 1e6;
+    printf("n: %llu, total_primes: %llu, time_seconds: %.6f, numbers_per_second: %.3e\n", (unsigned long long)n,
+           (unsigned long long)total, seconds, n / seconds);
+  }
+  return 0;
 }
 
 /**
  * @brief Main function that controls execution of all test cases and outputs results.
  */
-int main()
+int main(int argc, char *argv[])
 {
   int max_threads = omp_get_max_threads();
+  int chunk = SCHEDULE_DEFAULT_CHUNK;
+  if (argc > 1 && strcmp(argv[1], "--sieve-benchmark") == 0)
+    return run_sieve_benchmark(argc > 2 ? strtoull(argv[2], NULL, 10) : SIEVE_BENCHMARK_MAX, max_threads);
+  if (argc > 1 && strcmp(argv[1], "--miller-rabin-benchmark") == 0)
+    return run_miller_rabin_benchmark(argc > 2 && atol(argv[2]) > 0 ? (size_t)atol(argv[2]) : MR_BENCHMARK_COUNT,
+                                      max_threads);
+  int cold = 0;
+  for (int a = 1; a < argc; a++)
+  {
+    if (strcmp(argv[a], "--chunk") == 0 && a + 1 < argc && atoi(argv[a + 1]) > 0)
+      chunk = atoi(argv[++a]);
+    else if (strcmp(argv[a], "--cold") == 0)
+      cold = 1;
+  }
+
+  if (cold)
+    remove(PRIME_CACHE_PATH);
+  prime_cache cache;
+  if (prime_cache_open(&cache, PRIME_CACHE_PATH) != 0)
+  {
+    perror("Failed to open prime_cache.bin, caching in memory");
+    if (prime_cache_open(&cache, NULL) != 0)
+    {
+      perror("Failed to map the prime cache");
+      return 1;
+    }
+  }
+  printf("Prime cache covers n <= %llu\n", (unsigned long long)prime_cache_bound(&cache));
+
   int thread_options[] = {1, 2, 3, 4, 5, 6, 7, 8};
   int n_values[] = {4, 1000, 10000, 100000, 500000, 1000000, 5000000, 9999999};
 
-  FILE *file = fopen("./task-5.comparison-between-sequential-and-parallel-programming/out/results.csv", "w");
-  if (!file)
+  async_writer file;
+  if (async_writer_open(&file, "./task-5.comparison-between-sequential-and-parallel-programming/out/results.csv") != 0)
   {
     perror("Failed to open results.csv");
+    prime_cache_close(&cache);
     return 1;
   }
 
-  fprintf(file, "n,threads,version,total_primes,time_seconds\n");
+  async_writer_printf(&file, "n,threads,version,total_primes,time_seconds,imbalance,thread_busy_seconds\n");
 
   for (int i = 0; i < sizeof(n_values) / sizeof(int); i++)
   {
@@ -136,12 +380,20 @@ int main()
     {
       if (thread_options[j] <= max_threads)
       {
-        run_tests_for_n(file, n_values[i], thread_options[j]);
+        run_tests_for_n(&file, n_values[i], thread_options[j], chunk, &cache);
       }
     }
   }
 
-  fclose(file);
+  printf("Prime cache: %llu hits, %llu extensions\n", (unsigned long long)cache.hits,
+         (unsigned long long)cache.extensions);
+  prime_cache_close(&cache);
+
+  if (async_writer_close(&file) != 0)
+  {
+    perror("Failed to write results.csv");
+    return 1;
+  }
   printf("✅ All results written to results.csv\n");
 
   return 0;
@@ -0,0 +1,204 @@
+/**
+ * @file prime_cache.c
+ * @brief Incremental prime-count cache over an mmap-ed odd-number bitmap.
+ */
+
+#define _GNU_SOURCE // mremap
+
+#include "prime_cache.h"
+
+#include "sieve.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BLOCK_WORDS (PRIME_CACHE_BLOCK_BITS / 64)
+
+_Static_assert(sizeof(prime_cache_header) == 64, "the bitmap must start on a cache line");
+
+static int header_valid(const prime_cache_header *header, size_t file_bytes)
+{
+  return memcmp(header->magic, PRIME_CACHE_MAGIC, sizeof(header->magic)) == 0 &&
+         header->version == PRIME_CACHE_VERSION && header->block_bits == PRIME_CACHE_BLOCK_BITS &&
+         header->covered_bits % PRIME_CACHE_BLOCK_BITS == 0 &&
+         header->covered_bits / 8 <= file_bytes - sizeof(prime_cache_header);
+}
+
+/**
+ * @brief Makes room for prefix entries [0, blocks].
+ */
+static int reserve_prefix(prime_cache *cache, size_t blocks)
+{
+  if (blocks + 1 <= cache->prefix_capacity)
+    return 0;
+  size_t capacity = cache->prefix_capacity ? cache->prefix_capacity : 64;
+  while (capacity < blocks + 1)
+    capacity *= 2;
+  uint64_t *prefix = (uint64_t *)realloc(cache->prefix, capacity * sizeof(uint64_t));
+  if (!prefix)
+    return -1;
+  cache->prefix = prefix;
+  cache->prefix_capacity = capacity;
+  return 0;
+}
+
+/**
+ * @brief Appends the prefix counts of blocks [first, last) of the bitmap.
+ */
+static void append_prefix(prime_cache *cache, uint64_t first, uint64_t last)
+{
+  for (uint64_t b = first; b < last; b++)
+  {
+    uint64_t count = 0;
+    const uint64_t *words = cache->bits + b * BLOCK_WORDS;
+    for (size_t w = 0; w < BLOCK_WORDS; w++)
+      count += (uint64_t)__builtin_popcountll(words[w]);
+    cache->prefix[b + 1] = cache->prefix[b] + count;
+  }
+}
+
+/**
+ * @brief Grows the mapping (and the file) to hold at least `bits` bits, doubling the capacity.
+ */
+static int reserve_bits(prime_cache *cache, uint64_t bits)
+{
+  if (bits <= cache->capacity_bits)
+    return 0;
+  uint64_t capacity = cache->capacity_bits * 2;
+  capacity = capacity > bits ? capacity : bits;
+  capacity = (capacity + PRIME_CACHE_BLOCK_BITS - 1) / PRIME_CACHE_BLOCK_BITS * PRIME_CACHE_BLOCK_BITS;
+  const size_t map_bytes = sizeof(prime_cache_header) + (size_t)(capacity / 8);
+
+  if (cache->fd >= 0 && ftruncate(cache->fd, (off_t)map_bytes) != 0)
+    return -1;
+  void *map = mremap(cache->header, cache->map_bytes, map_bytes, MREMAP_MAYMOVE);
+  if (map == MAP_FAILED)
+    return -1;
+  cache->header = (prime_cache_header *)map;
+  cache->bits = (uint64_t *)(cache->header + 1);
+  cache->map_bytes = map_bytes;
+  cache->capacity_bits = capacity;
+  return 0;
+}
+
+int prime_cache_open(prime_cache *cache, const char *path)
+{
+  memset(cache, 0, sizeof(*cache));
+  cache->fd = -1;
+
+  size_t file_bytes = 0;
+  if (path)
+  {
+    cache->fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (cache->fd < 0 || fstat(cache->fd, &st) != 0)
+      goto fail;
+    file_bytes = (size_t)st.st_size;
+    if (file_bytes < sizeof(prime_cache_header))
+    {
+      if (ftruncate(cache->fd, sizeof(prime_cache_header)) != 0)
+        goto fail;
+      file_bytes = sizeof(prime_cache_header);
+    }
+  }
+  else
+    file_bytes = sizeof(prime_cache_header);
+
+  void *map = cache->fd >= 0 ? mmap(NULL, file_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, cache->fd, 0)
+                             : mmap(NULL, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED)
+    goto fail;
+  cache->header = (prime_cache_header *)map;
+  cache->bits = (uint64_t *)(cache->header + 1);
+  cache->map_bytes = file_bytes;
+  cache->capacity_bits = (uint64_t)(file_bytes - sizeof(prime_cache_header)) * 8 / PRIME_CACHE_BLOCK_BITS *
+                         PRIME_CACHE_BLOCK_BITS;
+
+  if (!header_valid(cache->header, file_bytes))
+  {
+    memset(cache->header, 0, sizeof(prime_cache_header));
+    memcpy(cache->header->magic, PRIME_CACHE_MAGIC, sizeof(cache->header->magic));
+    cache->header->version = PRIME_CACHE_VERSION;
+    cache->header->block_bits = PRIME_CACHE_BLOCK_BITS;
+  }
+
+  // A warm file only needs its prefix counts back.
+  const uint64_t blocks = cache->header->covered_bits / PRIME_CACHE_BLOCK_BITS;
+  if (reserve_prefix(cache, (size_t)blocks) != 0)
+    goto fail;
+  cache->prefix[0] = 0;
+  append_prefix(cache, 0, blocks);
+  return 0;
+
+fail:;
+  const int saved = errno;
+  prime_cache_close(cache);
+  errno = saved;
+  return -1;
+}
+
+uint64_t prime_cache_bound(const prime_cache *cache)
+{
+  // Bit k is 2k + 1, so bits [0, c) cover the numbers up to 2c (2c itself is even).
+  return 2 * cache->header->covered_bits;
+}
+
+/**
+ * @brief Sieves bits [covered_bits, bits) rounded up to a block, and appends their prefixes.
+ */
+static int extend(prime_cache *cache, uint64_t bits, int threads)
+{
+  const uint64_t covered = cache->header->covered_bits;
+  const uint64_t target = (bits + PRIME_CACHE_BLOCK_BITS - 1) / PRIME_CACHE_BLOCK_BITS * PRIME_CACHE_BLOCK_BITS;
+  if (reserve_bits(cache, target) != 0 || reserve_prefix(cache, (size_t)(target / PRIME_CACHE_BLOCK_BITS)) != 0)
+    return -1;
+  if (sieve_fill(cache->bits + covered / 64, covered, target, threads, 0) == UINT64_MAX)
+    return -1;
+  append_prefix(cache, covered / PRIME_CACHE_BLOCK_BITS, target / PRIME_CACHE_BLOCK_BITS);
+  // Published last, so the file never claims bits that were not written.
+  cache->header->covered_bits = target;
+  return 0;
+}
+
+uint64_t prime_cache_count(prime_cache *cache, uint64_t n, int threads)
+{
+  if (n < 2)
+    return 0;
+  // The odd numbers <= n are bits [0, k); the prime 2 is added apart.
+  const uint64_t k = (n - 1) / 2 + 1;
+  if (k > cache->header->covered_bits)
+  {
+    if (extend(cache, k, threads) != 0)
+      return UINT64_MAX;
+    cache->extensions++;
+  }
+  else
+    cache->hits++;
+
+  const uint64_t block = k / PRIME_CACHE_BLOCK_BITS;
+  uint64_t count = 1 + cache->prefix[block];
+  const uint64_t last_word = k / 64;
+  for (uint64_t w = block * BLOCK_WORDS; w < last_word; w++)
+    count += (uint64_t)__builtin_popcountll(cache->bits[w]);
+  if (k & 63)
+    count += (uint64_t)__builtin_popcountll(cache->bits[last_word] & ((1ULL << (k & 63)) - 1));
+  return count;
+}
+
+void prime_cache_close(prime_cache *cache)
+{
+  if (cache->header)
+    munmap(cache->header, cache->map_bytes);
+  if (cache->fd >= 0)
+    close(cache->fd);
+  free(cache->prefix);
+  cache->header = NULL;
+  cache->bits = NULL;
+  cache->prefix = NULL;
+  cache->fd = -1;
+}
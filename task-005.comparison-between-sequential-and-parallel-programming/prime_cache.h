@@ -0,0 +1,94 @@
+/**
+ * @file prime_cache.h
+ * @brief Incremental prime-count cache: a sieved bitmap with prefix counts, backed by an mmap-ed file.
+ *
+ * The sweep in prime.c counts the primes up to every n of n_values, for
+ * every thread count and version, each time from 2: O(sum n) of sieving
+ * for answers that are prefixes of one another. The cache keeps the odd
+ * numbers it has already sieved as a bitmap (bit k is 2k + 1, the layout of
+ * sieve.h) plus the number of primes before every block of
+ * PRIME_CACHE_BLOCK_BITS bits:
+ *
+ * - a query for n below the covered bound is a hit: the block prefix plus
+ *   the popcount of at most one block of words;
+ * - a query above it sieves only from the covered bound up to n (with
+ *   sieve_fill, in place in the bitmap) and appends the new prefixes, so a
+ *   whole sweep costs one sieve of the largest n, O(max n).
+ *
+ * The bitmap lives in a file mapped with mmap (a 64-byte header, then the
+ * words), grown with ftruncate + mremap, so a later run that opens the same
+ * file starts warm; only the prefix table is rebuilt, with one popcount
+ * pass. Without a path the bitmap is an anonymous mapping.
+ */
+
+#ifndef PRIME_CACHE_H
+#define PRIME_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PRIME_CACHE_BLOCK_BITS 4096  ///< Odd numbers per prefix-count entry (64 words).
+#define PRIME_CACHE_MAGIC "PRMCACHE" ///< First 8 bytes of a cache file.
+#define PRIME_CACHE_VERSION 1        ///< Layout version of the cache file.
+
+/**
+ * @struct prime_cache_header
+ * @brief Start of the cache file; the bitmap words follow it.
+ */
+typedef struct
+{
+  char magic[8];         ///< PRIME_CACHE_MAGIC (no terminator).
+  uint32_t version;      ///< PRIME_CACHE_VERSION.
+  uint32_t block_bits;   ///< PRIME_CACHE_BLOCK_BITS of the writer.
+  uint64_t covered_bits; ///< Bits [0, covered_bits) are sieved; a multiple of block_bits.
+  uint64_t reserved[5];  ///< Pads the header to 64 bytes.
+} prime_cache_header;
+
+/**
+ * @struct prime_cache
+ * @brief An open cache: the mapping, its capacity and the prefix counts.
+ */
+typedef struct
+{
+  int fd;                     ///< Backing file, or -1 for an anonymous mapping.
+  prime_cache_header *header; ///< Start of the mapping.
+  uint64_t *bits;             ///< Bitmap, right after the header.
+  size_t map_bytes;           ///< Length of the mapping (header + capacity).
+  uint64_t capacity_bits;     ///< Bits the mapping can hold.
+  uint64_t *prefix;           ///< prefix[b] = primes among bits [0, b * PRIME_CACHE_BLOCK_BITS).
+  size_t prefix_capacity;     ///< Entries allocated in prefix.
+  uint64_t hits;              ///< Queries answered without sieving.
+  uint64_t extensions;        ///< Queries that extended the sieve.
+} prime_cache;
+
+/**
+ * @brief Opens (or creates) a cache.
+ *
+ * A file with a different magic, version or block size, or shorter than
+ * its header claims, is started over.
+ *
+ * @param path Backing file, or NULL for an in-memory cache.
+ * @return 0 on success, -1 on failure (errno is set).
+ */
+int prime_cache_open(prime_cache *cache, const char *path);
+
+/**
+ * @brief Counts the primes <= n, extending the sieve from the covered bound if needed.
+ *
+ * @param n Upper bound (inclusive).
+ * @param threads OpenMP threads of the extension.
+ * @return The number of primes <= n, or UINT64_MAX if the extension failed.
+ */
+uint64_t prime_cache_count(prime_cache *cache, uint64_t n, int threads);
+
+/**
+ * @brief Largest n that prime_cache_count answers without sieving.
+ */
+uint64_t prime_cache_bound(const prime_cache *cache);
+
+/**
+ * @brief Unmaps the bitmap (the file keeps it) and frees the prefix counts.
+ */
+void prime_cache_close(prime_cache *cache);
+
+#endif
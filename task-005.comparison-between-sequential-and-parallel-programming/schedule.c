@@ -0,0 +1,113 @@
+/**
+ * @file schedule.c
+ * @brief Scheduling policies for the parallel trial-division loop.
+ */
+
+#include "schedule.h"
+
+#include <math.h>
+#include <omp.h>
+#include <stdlib.h>
+
+#define SCHEDULE_NAME(id, name) name,
+
+static const char *schedule_names[SCHEDULE_COUNT] = {SCHEDULE_POLICIES(SCHEDULE_NAME)};
+
+const char *schedule_name(schedule_policy policy)
+{
+  return schedule_names[policy];
+}
+
+/**
+ * @brief First i of block t of `threads` under cost(i) = sqrt(i): integral of sqrt from 2 to it = t / threads of the total.
+ */
+static int cost_weighted_bound(int n, int t, int threads)
+{
+  if (t == 0)
+    return 2;
+  if (t == threads)
+    return n + 1;
+  // The integral of sqrt(x) is (2/3) x^(3/2); the constant factor cancels.
+  const double low = pow(2.0, 1.5), high = pow((double)n + 1.0, 1.5);
+  const int bound = (int)ceil(pow(low + (high - low) * t / threads, 2.0 / 3.0));
+  return bound < 2 ? 2 : bound > n + 1 ? n + 1 : bound;
+}
+
+int schedule_count(int n, int threads, schedule_policy policy, int chunk, int (*predicate)(int),
+                   schedule_result *result)
+{
+  result->total = 0;
+  result->threads = threads;
+  result->busy_seconds = (double *)calloc((size_t)threads, sizeof(double));
+  if (!result->busy_seconds)
+    return -1;
+  if (chunk < 1)
+    chunk = SCHEDULE_DEFAULT_CHUNK;
+
+  // The omp_for policies go through schedule(runtime).
+  switch (policy)
+  {
+  case SCHEDULE_STATIC_CYCLIC:
+    omp_set_schedule(omp_sched_static, 1);
+    break;
+  case SCHEDULE_DYNAMIC:
+    omp_set_schedule(omp_sched_dynamic, chunk);
+    break;
+  case SCHEDULE_GUIDED:
+    omp_set_schedule(omp_sched_guided, chunk);
+    break;
+  default:
+    omp_set_schedule(omp_sched_static, 0);
+    break;
+  }
+
+  int total = 0;
+  int used = threads;
+#pragma omp parallel num_threads(threads) reduction(+ : total)
+  {
+    const int t = omp_get_thread_num();
+    const double start = omp_get_wtime();
+    if (policy == SCHEDULE_COST_WEIGHTED)
+    {
+      const int team = omp_get_num_threads();
+      const int first = cost_weighted_bound(n, t, team), last = cost_weighted_bound(n, t + 1, team);
+      for (int i = first; i < last; i++)
+      {
+        if (predicate(i))
+          total++;
+      }
+    }
+    else
+    {
+#pragma omp for schedule(runtime) nowait
+      for (int i = 2; i <= n; i++)
+      {
+        if (predicate(i))
+          total++;
+      }
+    }
+    result->busy_seconds[t] = omp_get_wtime() - start;
+    if (t == 0)
+      used = omp_get_num_threads();
+  }
+  result->total = total;
+  result->threads = used;
+  return 0;
+}
+
+double schedule_imbalance(const schedule_result *result)
+{
+  double max = 0.0, sum = 0.0;
+  for (int t = 0; t < result->threads; t++)
+  {
+    sum += result->busy_seconds[t];
+    max = result->busy_seconds[t] > max ? result->busy_seconds[t] : max;
+  }
+  return sum > 0.0 ? max * result->threads / sum : 1.0;
+}
+
+void schedule_result_free(schedule_result *result)
+{
+  free(result->busy_seconds);
+  result->busy_seconds = NULL;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file schedule.h
+ * @brief Scheduling policies for the parallel trial-division loop, with per-thread busy time.
+ *
+ * The cost of is_prime(i) grows with sqrt(i) (for primes, which dominate
+ * the total), so `#pragma omp parallel for` with the default static block
+ * schedule gives the last thread the most expensive tail of [2, n]. This
+ * layer runs the same counting loop under several policies:
+ *
+ * - static: one contiguous block per thread (the default of `omp for`);
+ * - static_cyclic: `schedule(static, 1)`, i goes to thread i mod T;
+ * - dynamic / guided: `schedule(dynamic | guided, chunk)`;
+ * - cost_weighted: contiguous blocks of equal work under the model
+ *   cost(i) = sqrt(i), so block t ends where the integral of sqrt reaches
+ *   (t + 1) / T of the total.
+ *
+ * Each thread records the time it spent in the loop (its busy time); the
+ * ratio of the longest to the mean busy time is the load imbalance.
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#define SCHEDULE_DEFAULT_CHUNK 1024 ///< Chunk of the dynamic and guided policies.
+
+/**
+ * @brief Policies: X(enum suffix, name).
+ */
+#define SCHEDULE_POLICIES(X)          \
+  X(STATIC, "static")                 \
+  X(STATIC_CYCLIC, "static_cyclic")   \
+  X(DYNAMIC, "dynamic")               \
+  X(GUIDED, "guided")                 \
+  X(COST_WEIGHTED, "cost_weighted")
+
+#define SCHEDULE_ENUM(id, name) SCHEDULE_##id,
+
+/**
+ * @enum schedule_policy
+ * @brief How the iterations of [2, n] are distributed over the threads.
+ */
+typedef enum
+{
+  SCHEDULE_POLICIES(SCHEDULE_ENUM)
+  SCHEDULE_COUNT
+} schedule_policy;
+
+/**
+ * @brief Name of a policy ("static", "dynamic", ...).
+ */
+const char *schedule_name(schedule_policy policy);
+
+/**
+ * @struct schedule_result
+ * @brief Outcome of one scheduled run.
+ */
+typedef struct
+{
+  int total;             ///< Primes counted.
+  double *busy_seconds;  ///< Busy time of each thread (`threads` entries, owned by the result).
+  int threads;           ///< Threads that ran the loop.
+} schedule_result;
+
+/**
+ * @brief Counts i in [2, n] with predicate(i) != 0 under a policy.
+ *
+ * @param n Upper bound (inclusive).
+ * @param threads Number of threads.
+ * @param policy Scheduling policy.
+ * @param chunk Chunk size of dynamic and guided (ignored by the others).
+ * @param predicate Test applied to every i (is_prime).
+ * @param result Filled with the count and the busy times; release with schedule_result_free.
+ * @return 0 on success, -1 if the busy-time array could not be allocated.
+ */
+int schedule_count(int n, int threads, schedule_policy policy, int chunk, int (*predicate)(int),
+                   schedule_result *result);
+
+/**
+ * @brief Longest busy time over the mean (1 = perfect balance).
+ */
+double schedule_imbalance(const schedule_result *result);
+
+void schedule_result_free(schedule_result *result);
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * @file sieve.c
+ * @brief Parallel segmented Sieve of Eratosthenes over odd numbers.
+ */
+
+#include "sieve.h"
+
+#include <omp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+uint64_t sieve_isqrt(uint64_t n)
+{
+  uint64_t r = 0;
+  for (uint64_t bit = 1ULL << 31; bit > 0; bit >>= 1)
+  {
+    const uint64_t candidate = r | bit;
+    if (candidate * candidate <= n)
+      r = candidate;
+  }
+  return r;
+}
+
+int sieve_base_init(sieve_base *base, uint64_t limit)
+{
+  base->primes = NULL;
+  base->count = 0;
+  base->limit = limit;
+  if (limit < 3)
+    return 0;
+
+  // composite[k] for the odd number 2k + 1.
+  const size_t odd_count = (size_t)((limit - 1) / 2 + 1);
+  unsigned char *composite = (unsigned char *)calloc(odd_count, 1);
+  // pi(x) < 1.26 x / ln x; x / 2 is a simpler bound that holds for every x.
+  base->primes = (uint32_t *)malloc((odd_count + 1) * sizeof(uint32_t));
+  if (!composite || !base->primes)
+  {
+    free(composite);
+    free(base->primes);
+    base->primes = NULL;
+    return -1;
+  }
+  for (size_t k = 1; k < odd_count; k++)
+  {
+    if (composite[k])
+      continue;
+    const uint64_t p = 2 * k + 1;
+    base->primes[base->count++] = (uint32_t)p;
+    for (uint64_t j = (p * p - 1) / 2; j < odd_count; j += p)
+      composite[j] = 1;
+  }
+  free(composite);
+  return 0;
+}
+
+void sieve_base_free(sieve_base *base)
+{
+  free(base->primes);
+  base->primes = NULL;
+  base->count = 0;
+}
+
+size_t sieve_default_segment_bytes(void)
+{
+  const long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+  return l1 > 0 ? (size_t)l1 : SIEVE_FALLBACK_SEGMENT_BYTES;
+}
+
+/**
+ * @brief Sieves the odd-number bits [lo, hi) and counts the primes among them.
+ *
+ * @param bits Segment buffer, at least (hi - lo + 63) / 64 words.
+ * @param next Per base prime, the bit of its next odd multiple; advanced past hi.
+ */
+static uint64_t sieve_segment(uint64_t *bits, uint64_t lo, uint64_t hi, const sieve_base *base, uint64_t *next)
+{
+  const uint64_t length = hi - lo;
+  const size_t words = (size_t)((length + 63) / 64);
+  memset(bits, 0xff, words * sizeof(uint64_t));
+
+  for (size_t i = 0; i < base->count; i++)
+  {
+    const uint64_t p = base->primes[i];
+    uint64_t j = next[i];
+    for (; j < hi; j += p)
+    {
+      const uint64_t offset = j - lo;
+      bits[offset >> 6] &= ~(1ULL << (offset & 63));
+    }
+    next[i] = j;
+  }
+  if (lo == 0)
+    bits[0] &= ~1ULL; // bit 0 is the number 1
+
+  if (length & 63)
+    bits[words - 1] &= (1ULL << (length & 63)) - 1;
+  uint64_t count = 0;
+  for (size_t w = 0; w < words; w++)
+    count += (uint64_t)__builtin_popcountll(bits[w]);
+  return count;
+}
+
+/**
+ * @brief Sieves the odd-number bits [lo, hi) in segments split over the threads.
+ *
+ * @param dest Bitmap of the range (bit k at dest[(k - lo) / 64], lo a multiple of 64), sieved in place; NULL to
+ *             sieve in per-thread buffers and only count.
+ * @return Primes among the bits, or UINT64_MAX if an allocation failed.
+ */
+static uint64_t sieve_run(uint64_t lo, uint64_t hi, int threads, size_t segment_bytes, uint64_t *dest)
+{
+  if (segment_bytes == 0)
+    segment_bytes = sieve_default_segment_bytes();
+  segment_bytes = (segment_bytes + 7) / 8 * 8;
+
+  sieve_base base;
+  if (sieve_base_init(&base, sieve_isqrt(2 * hi - 1)) != 0)
+    return UINT64_MAX;
+
+  const uint64_t segment_bits = (uint64_t)segment_bytes * 8;
+  const uint64_t segments = (hi - lo + segment_bits - 1) / segment_bits;
+  uint64_t count = 0;
+  int failed = 0;
+
+#pragma omp parallel num_threads(threads) reduction(+ : count) reduction(| : failed)
+  {
+    const uint64_t t = (uint64_t)omp_get_thread_num(), total = (uint64_t)omp_get_num_threads();
+    const uint64_t first = segments * t / total, last = segments * (t + 1) / total;
+    uint64_t *buffer = dest ? NULL : (uint64_t *)malloc(segment_bytes);
+    uint64_t *next = (uint64_t *)malloc((base.count + 1) * sizeof(uint64_t));
+    if (first < last && ((!dest && !buffer) || !next))
+      failed = 1;
+    else if (first < last)
+    {
+      // First odd multiple of p at or after this thread's first bit, starting from p^2.
+      const uint64_t start = lo + first * segment_bits;
+      for (size_t i = 0; i < base.count; i++)
+      {
+        const uint64_t p = base.primes[i];
+        uint64_t j = (p * p - 1) / 2;
+        if (j < start)
+          j += (start - j + p - 1) / p * p;
+        next[i] = j;
+      }
+      for (uint64_t s = first; s < last; s++)
+      {
+        const uint64_t seg_lo = lo + s * segment_bits;
+        const uint64_t seg_hi = seg_lo + segment_bits < hi ? seg_lo + segment_bits : hi;
+        uint64_t *bits = dest ? dest + (seg_lo - lo) / 64 : buffer;
+        count += sieve_segment(bits, seg_lo, seg_hi, &base, next);
+      }
+    }
+    free(buffer);
+    free(next);
+  }
+
+  sieve_base_free(&base);
+  return failed ? UINT64_MAX : count;
+}
+
+uint64_t sieve_count_primes(uint64_t n, int threads, size_t segment_bytes)
+{
+  if (n < 2)
+    return 0;
+  // Bit k is the odd number 2k + 1; bits [0, (n - 1) / 2] cover the odd numbers <= n. The prime 2 is added apart.
+  const uint64_t count = sieve_run(0, (n - 1) / 2 + 1, threads, segment_bytes, NULL);
+  return count == UINT64_MAX ? count : count + 1;
+}
+
+uint64_t sieve_fill(uint64_t *bits, uint64_t lo, uint64_t hi, int threads, size_t segment_bytes)
+{
+  if (lo % 64 != 0 || hi <= lo)
+    return hi == lo ? 0 : UINT64_MAX;
+  return sieve_run(lo, hi, threads, segment_bytes, bits);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file sieve.h
+ * @brief Parallel segmented Sieve of Eratosthenes over odd numbers, for counting primes up to n.
+ *
+ * Trial division costs O(sqrt i) per number, O(n sqrt n) in total; the
+ * sieve costs O(n log log n). The odd numbers 1, 3, 5, ... are stored one
+ * bit each (bit k is 2k + 1), so a byte covers 16 numbers, and [0, n] is
+ * cut into segments of `segment_bytes` that stay in the L1 (or L2) cache
+ * while every base prime p <= sqrt(n) clears its odd multiples, starting at
+ * p^2. The segments are split into one contiguous range per OpenMP thread;
+ * each thread owns its segment buffer and the offset of the next multiple
+ * of every base prime, so moving to the next segment costs nothing but the
+ * clearing itself. The primes left in a segment are counted with popcount.
+ */
+
+#ifndef SIEVE_H
+#define SIEVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIEVE_FALLBACK_SEGMENT_BYTES (32 << 10) ///< Segment size when the L1 size is unknown.
+
+/**
+ * @struct sieve_base
+ * @brief The odd primes up to a limit (the sieving primes of numbers up to limit^2).
+ */
+typedef struct
+{
+  uint32_t *primes; ///< Odd primes in increasing order.
+  size_t count;     ///< Number of primes.
+  uint64_t limit;   ///< Every odd prime <= limit is listed.
+} sieve_base;
+
+/**
+ * @brief Lists the odd primes up to `limit` with a plain sieve.
+ * @return 0 on success, -1 if the allocation failed.
+ */
+int sieve_base_init(sieve_base *base, uint64_t limit);
+
+void sieve_base_free(sieve_base *base);
+
+/**
+ * @brief Integer square root: the largest r with r^2 <= n.
+ */
+uint64_t sieve_isqrt(uint64_t n);
+
+/**
+ * @brief Segment size for this machine: the L1 data cache (sysconf), or SIEVE_FALLBACK_SEGMENT_BYTES.
+ */
+size_t sieve_default_segment_bytes(void);
+
+/**
+ * @brief Counts the primes <= n.
+ *
+ * @param n Upper bound (inclusive).
+ * @param threads OpenMP threads.
+ * @param segment_bytes Segment size in bytes (rounded up to 8; 0 for sieve_default_segment_bytes()).
+ * @return The number of primes <= n, or UINT64_MAX if an allocation failed.
+ */
+uint64_t sieve_count_primes(uint64_t n, int threads, size_t segment_bytes);
+
+/**
+ * @brief Sieves the odd-number bits [lo, hi) into a caller's bitmap (bit k is the odd number 2k + 1).
+ *
+ * Bit k of the range goes to bits[(k - lo) / 64], bit (k - lo) % 64; it is
+ * set if 2k + 1 is prime. The segments are sieved in place, so the bitmap
+ * itself is the segment buffer.
+ *
+ * @param bits Destination, at least (hi - lo + 63) / 64 words.
+ * @param lo First bit, a multiple of 64.
+ * @param hi One past the last bit.
+ * @param threads OpenMP threads.
+ * @param segment_bytes Segment size in bytes (rounded up to 8; 0 for sieve_default_segment_bytes()).
+ * @return Primes in the range, or UINT64_MAX if lo is not aligned or an allocation failed.
+ */
+uint64_t sieve_fill(uint64_t *bits, uint64_t lo, uint64_t hi, int threads, size_t segment_bytes);
+
+#endif
@@ -5,6 +5,8 @@
 #include <time.h>
 #include <omp.h>
 
+#include "../common/rng.h"
+
 const int N = 9999999; /**< Number of Monte Carlo samples */
 
 /**
@@ -208,6 +210,21 @@ void test_with_pragma_omp_parallel_and_parallel_for__default_none()
     printf("✅ Case 7 - Default(none):   π ≈ %-15.15f | Time: %.3fs\n", pi, elapsed);
 }
 
+/**
+ * @brief Version using the counter-based Philox generator
+ * @details rng_philox_count_in_circle() draws point i from Philox block i of a fixed seed, so the threads share
+ *          no generator state and π is the same for any OMP_NUM_THREADS
+ */
+void test_with_philox_reproducible()
+{
+    clock_t start = clock();
+    uint64_t count = rng_philox_count_in_circle(RNG_DEFAULT_SEED, N);
+
+    double pi = 4.0 * count / N;
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("✅ Case 8 - Philox:          π ≈ %-15.15f | Time: %.3fs (reproducible)\n", pi, elapsed);
+}
+
 /**
  * @brief Main function
  * @details Runs all test cases and prints results
@@ -224,6 +241,7 @@ int main()
     test_with_pragma_omp_parallel_and_parallel_for__firstprivate();
     test_with_pragma_omp_parallel_and_parallel_for__lastprivate();
     test_with_pragma_omp_parallel_and_parallel_for__default_none();
+    test_with_philox_reproducible();
 
     printf("\n(Use OMP_NUM_THREADS to change thread count)\n");
     return 0;
@@ -4,6 +4,8 @@
 #include <time.h>
 #include <omp.h>
 
+#include "../common/rng.h"
+
 #define N 9999999
 
 /**
@@ -175,6 +177,45 @@ void version_array_rand_r()
   printf("🌕 Version 4 - array + rand_r():       π ≈ %-15.15f | Time: %.3fs\n", pi, elapsed);
 }
 
+/**
+ * @brief Version using xoshiro256** with one padded state per thread.
+ * 
+ * The generator states live in a shared array, like the counts of version 2, but each
+ * rng_thread_state fills a whole cache line: thread t draws from stream t of a fixed seed
+ * (the seed jumped 2^128 draws t times) and never writes to a line another thread reads.
+ * The result is the same on every run with the same number of threads.
+ */
+void version_padded_xoshiro()
+{
+  double start = get_time();
+  int count = 0;
+  rng_thread_state *states = rng_thread_states(RNG_DEFAULT_SEED, omp_get_max_threads());
+  if (!states)
+  {
+    perror("Failed to allocate the generator states");
+    return;
+  }
+
+  #pragma omp parallel reduction(+:count)
+  {
+    rng_xoshiro *rng = &states[omp_get_thread_num()].xoshiro;
+
+    #pragma omp for
+    for (int i = 0; i < N; i++)
+    {
+      double x = rng_uniform(rng_xoshiro_next(rng));
+      double y = rng_uniform(rng_xoshiro_next(rng));
+      if (x * x + y * y <= 1.0)
+        count++;
+    }
+  }
+  free(states);
+
+  double pi = 4.0 * count / N;
+  double elapsed = get_time() - start;
+  printf("🔵 Version 5 - padded xoshiro256**:    π ≈ %-15.15f | Time: %.3fs\n", pi, elapsed);
+}
+
 /**
  * @brief Main function that runs all the versions.
  * 
@@ -190,6 +231,7 @@ int main()
   version_array_rand();
   version_critical_rand_r();
   version_array_rand_r();
+  version_padded_xoshiro();
 
   return 0;
 }
\ No newline at end of file
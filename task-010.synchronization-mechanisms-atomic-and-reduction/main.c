@@ -4,6 +4,8 @@
 #include <time.h>
 #include <omp.h>
 
+#include "../common/rng.h"
+
 #define N 999999999
 
 /**
@@ -175,6 +177,21 @@ void worst_version_critical_rand_r()
   printf("🔻 [v5] worst: critical per hit + rand_r():       π ≈ %.15f | Time: %.3fs\n", pi, elapsed);
 }
 
+/**
+ * @brief Monte Carlo estimation of π using `reduction` and the counter-based Philox generator of common/rng.h.
+ *        rng_philox_count_in_circle() draws point i from Philox block i of a fixed seed, RNG_PHILOX_FILL points
+ *        per bulk fill, with `reduction(+:count)` over the threads, so π is the same for any number of threads.
+ */
+void version_reduction_philox()
+{
+  double start = get_time();
+  uint64_t count = rng_philox_count_in_circle(RNG_DEFAULT_SEED, N);
+
+  double pi = 4.0 * count / N;
+  double elapsed = get_time() - start;
+  printf("🟤 [v6] reduction(+:count) + Philox:              π ≈ %.15f | Time: %.3fs\n", pi, elapsed);
+}
+
 /**
  * @brief Main function that executes and compares different implementations
  *        of Monte Carlo estimation for π using various OpenMP synchronization mechanisms.
@@ -189,7 +206,8 @@ int main()
   version_reduction_rand_r();
   worst_version_atomic_rand_r();
   worst_version_critical_rand_r();
+  version_reduction_philox();
   return 0;
 }
 
-// gcc-14 -fopenmp ./task-10.synchronization-mechanisms-atomic-and-reduction/main.c -o ./task-10.synchronization-mechanisms-atomic-and-reduction/out/main.o && ./task-10.synchronization-mechanisms-atomic-and-reduction/out/main.o
\ No newline at end of file
+// gcc-14 -O2 -fopenmp ./task-10.synchronization-mechanisms-atomic-and-reduction/main.c ./common/rng.c -o ./task-10.synchronization-mechanisms-atomic-and-reduction/out/main.o && ./task-10.synchronization-mechanisms-atomic-and-reduction/out/main.o
\ No newline at end of file
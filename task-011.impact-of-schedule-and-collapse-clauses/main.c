@@ -9,6 +9,8 @@
  #include <math.h>
  #include <omp.h>
  
+ #include "../common/async_writer.h"
+ 
  #define N 32
  #define NSTEPS 10000
  #define DT 0.01f
@@ -20,9 +22,9 @@
  
  /**
   * @brief Saves CSV header for benchmark logging.
-  * @param f Output file pointer.
+  * @param f Output CSV writer.
   */
- void save_csv_header(FILE *f);
+ void save_csv_header(async_writer *f);
  
  /**
   * @brief Initializes the 3D field with a single central perturbation.
@@ -35,14 +37,18 @@
  
  /**
   * @brief Saves a snapshot of the field to a binary file.
-  * @param f Output binary file pointer.
+  *
+  * Called inside the timed loop: the field is copied into the writer's
+  * ring and written to disk by its background thread.
+  *
+  * @param f Output binary writer.
   */
- void save_snapshot(FILE *f) {
-     fwrite(u, sizeof(float), N * N * N, f);
+ void save_snapshot(async_writer *f) {
+     async_writer_write(f, u, sizeof(u));
  }
  
- void save_csv_header(FILE *f) {
-     fprintf(f, "schedule_type,chunk_size,collapse,time_seconds\n");
+ void save_csv_header(async_writer *f) {
+     async_writer_printf(f, "schedule_type,chunk_size,collapse,time_seconds\n");
  }
  
  /**
@@ -51,10 +57,10 @@
   * @param schedule_type "static", "dynamic", or "guided"
   * @param chunk_size Chunk size for the scheduler
   * @param collapse Whether to collapse nested loops (1 = yes, 0 = no)
-  * @param log_file Output CSV file for performance data
-  * @param bin_file Output binary file for snapshots
+  * @param log_file Output CSV writer for performance data
+  * @param bin_file Output binary writer for snapshots
   */
- void run_simulation(const char *schedule_type, int chunk_size, int collapse, FILE *log_file, FILE *bin_file) {
+ void run_simulation(const char *schedule_type, int chunk_size, int collapse, async_writer *log_file, async_writer *bin_file) {
      initialize();
      double start = omp_get_wtime();
  
@@ -130,26 +136,26 @@
      double elapsed = end - start;
  
      printf("Config: %s, chunk=%d, collapse=%d -> %.3f s\n", schedule_type, chunk_size, collapse, elapsed);
-     fprintf(log_file, "%s,%d,%d,%.6f\n", schedule_type, chunk_size, collapse, elapsed);
+     async_writer_printf(log_file, "%s,%d,%d,%.6f\n", schedule_type, chunk_size, collapse, elapsed);
  }
  
  /**
   * @brief Entry point: runs simulations with various OpenMP configurations.
   */
  int main() {
-     FILE *f = fopen("./task-011.impact-of-schedule-and-collapse-clauses/data/benchmarks.csv", "w");
-     if (!f) {
+     async_writer f, bin_file;
+     if (async_writer_open(&f, "./task-011.impact-of-schedule-and-collapse-clauses/data/benchmarks.csv") != 0) {
          perror("Failed to open benchmark CSV file.");
          return 1;
      }
  
-     FILE *bin_file = fopen("./task-011.impact-of-schedule-and-collapse-clauses/data/fluid_with_perturbation.bin", "wb");
-     if (!bin_file) {
+     if (async_writer_open(&bin_file, "./task-011.impact-of-schedule-and-collapse-clauses/data/fluid_with_perturbation.bin") != 0) {
          perror("Failed to open binary output file.");
+         async_writer_close(&f);
          return 1;
      }
  
-     save_csv_header(f);
+     save_csv_header(&f);
  
      const char *schedules[] = {"static", "dynamic", "guided"};
      int chunk_sizes[] = {1, 2, 4, 8, 16, 32, 64, 125, 128, 256, 512, 1024};
@@ -158,13 +164,18 @@
      for (int s = 0; s < 3; s++) {
          for (int c = 0; c < 12; c++) {
              for (int col = 0; col < 2; col++) {
-                 run_simulation(schedules[s], chunk_sizes[c], collapses[col], f, bin_file);
+                 run_simulation(schedules[s], chunk_sizes[c], collapses[col], &f, &bin_file);
              }
          }
      }
  
-     fclose(f);
-     fclose(bin_file);
+     // Both writers must be closed (and unregistered) even if the first close fails.
+     int failed = async_writer_close(&f) != 0;
+     failed |= async_writer_close(&bin_file) != 0;
+     if (failed) {
+         perror("Failed to write the output files.");
+         return 1;
+     }
  
      printf("All tests completed. Results saved to './task-011.impact-of-schedule-and-collapse-clauses/data/benchmarks.csv'.\n");
      return 0;